@@ -64,9 +64,13 @@ vs:
 	ADDON_INCLUDES += $(AZUREKINECT_SDK)\sdk\include
 	ADDON_INCLUDES += $(AZUREKINECT_BODY_SDK)\sdk\include
 	ADDON_LIBS += $(AZUREKINECT_SDK)\sdk\windows-desktop\amd64\release\lib\k4a.lib
+	ADDON_LIBS += $(AZUREKINECT_SDK)\sdk\windows-desktop\amd64\release\lib\k4arecord.lib
 	ADDON_LIBS += $(AZUREKINECT_BODY_SDK)\sdk\windows-desktop\amd64\release\lib\k4abt.lib
 	
 linux64: 
+	# Azure Kinect Sensor and Body Tracking SDK packages install to the system paths.
+	ADDON_LDFLAGS += -lk4a -lk4arecord -lk4abt -lturbojpeg
+	ADDON_LIBS_EXCLUDE += libs/turbojpeg
 	
 linux:
 
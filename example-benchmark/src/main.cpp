@@ -0,0 +1,11 @@
+#include "ofApp.h"
+
+#include "ofAppNoWindow.h"
+
+int main()
+{
+	// Benchmarks don't need a GL context, so they can run on headless boxes.
+	auto window = std::make_shared<ofAppNoWindow>();
+	ofRunApp(window, std::make_shared<ofApp>());
+	ofRunMainLoop();
+}
@@ -0,0 +1,670 @@
+#include "ofApp.h"
+
+namespace
+{
+	struct DepthModeInfo
+	{
+		std::string name;
+		ofxAzureKinect::DepthMode mode;
+		glm::ivec2 dims;
+	};
+
+	struct ColorResolutionInfo
+	{
+		std::string name;
+		ofxAzureKinect::ColorResolution resolution;
+		glm::ivec2 dims;
+	};
+
+	// Depth frame sizes for each depth mode.
+	const std::vector<DepthModeInfo> kDepthModes =
+	{
+		{ "NFOV_2X2BINNED", K4A_DEPTH_MODE_NFOV_2X2BINNED, glm::ivec2(320, 288) },
+		{ "NFOV_UNBINNED", K4A_DEPTH_MODE_NFOV_UNBINNED, glm::ivec2(640, 576) },
+		{ "WFOV_2X2BINNED", K4A_DEPTH_MODE_WFOV_2X2BINNED, glm::ivec2(512, 512) },
+		{ "WFOV_UNBINNED", K4A_DEPTH_MODE_WFOV_UNBINNED, glm::ivec2(1024, 1024) }
+	};
+
+	using Clock = std::chrono::steady_clock;
+
+	double elapsedNs(const Clock::time_point& start, size_t iterations)
+	{
+		return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations;
+	}
+
+	// Color frame sizes for each color resolution.
+	const std::vector<ColorResolutionInfo> kColorResolutions =
+	{
+		{ "720P", K4A_COLOR_RESOLUTION_720P, glm::ivec2(1280, 720) },
+		{ "1080P", K4A_COLOR_RESOLUTION_1080P, glm::ivec2(1920, 1080) },
+		{ "1440P", K4A_COLOR_RESOLUTION_1440P, glm::ivec2(2560, 1440) },
+		{ "1536P", K4A_COLOR_RESOLUTION_1536P, glm::ivec2(2048, 1536) },
+		{ "2160P", K4A_COLOR_RESOLUTION_2160P, glm::ivec2(3840, 2160) },
+		{ "3072P", K4A_COLOR_RESOLUTION_3072P, glm::ivec2(4096, 3072) }
+	};
+
+	template<typename Fn>
+	double timeNs(size_t iterations, Fn fn)
+	{
+		const auto start = Clock::now();
+		for (size_t i = 0; i < iterations; ++i)
+		{
+			fn();
+		}
+		return elapsedNs(start, iterations);
+	}
+
+	// A tilted floor with a few boxes in front of it, some dropouts and noise.
+	// The boxes move right with offset, to build sequences.
+	ofShortPixels makeDepthFrame(const glm::ivec2& dims, std::mt19937& rng, int offset = 0)
+	{
+		std::uniform_int_distribution<int> noise(-8, 8);
+		std::uniform_int_distribution<int> dropout(0, 99);
+
+		ofShortPixels pix;
+		pix.allocate(dims.x, dims.y, 1);
+		for (int y = 0; y < dims.y; ++y)
+		{
+			for (int x = 0; x < dims.x; ++x)
+			{
+				int depth = 4000 - 2000 * y / dims.y;
+				if (((x + offset) / 64 + y / 64) % 5 == 0)
+				{
+					depth -= 1200;
+				}
+				depth += noise(rng);
+				pix[y * dims.x + x] = (dropout(rng) < 3) ? 0 : static_cast<uint16_t>(depth);
+			}
+		}
+		return pix;
+	}
+
+	// Splits everything closer than maxDepth into two bodies, left and right of the center.
+	ofPixels makeBodyIndexFrame(const ofShortPixels& depthPix, uint16_t maxDepth)
+	{
+		const int width = static_cast<int>(depthPix.getWidth());
+		const int height = static_cast<int>(depthPix.getHeight());
+
+		ofPixels pix;
+		pix.allocate(width, height, 1);
+		for (int y = 0; y < height; ++y)
+		{
+			for (int x = 0; x < width; ++x)
+			{
+				const uint16_t depth = depthPix[y * width + x];
+				pix[y * width + x] = (depth != 0 && depth < maxDepth) ? (x < width / 2 ? 0 : 1) : K4ABT_BODY_INDEX_MAP_BACKGROUND;
+			}
+		}
+		return pix;
+	}
+
+	// Exposes the pipeline stages of a stream so they can be timed one by one,
+	// and keeps the last capture around to feed them.
+	template<typename StreamType>
+	class StageStream
+		: public StreamType
+	{
+	public:
+		using StreamType::setupImageToWorldTable;
+		using StreamType::updateWorldVbo;
+		using StreamType::decodeColorFrame;
+		using StreamType::updateDepthInColorFrame;
+		using StreamType::updateColorInDepthFrame;
+		using StreamType::transformation;
+
+		const k4a::capture& getLastCapture() const
+		{
+			return this->lastCapture;
+		}
+
+		// Time spent producing the last capture, the rest of update() is the pipeline.
+		double getCaptureNs() const
+		{
+			return this->captureNs;
+		}
+
+	protected:
+		bool updateCapture() override
+		{
+			const auto start = Clock::now();
+			const bool bCaptured = StreamType::updateCapture();
+			this->captureNs = elapsedNs(start, 1);
+			if (bCaptured)
+			{
+				this->lastCapture = this->capture;
+			}
+			return bCaptured;
+		}
+
+	private:
+		k4a::capture lastCapture;
+		double captureNs = 0.0;
+	};
+
+	template<typename StreamType>
+	void benchmarkStages(StageStream<StreamType>& stream, const ofJson& scene, ofJson& results)
+	{
+		const size_t kUpdateIterations = 10;
+		const size_t kTableIterations = 5;
+		const size_t kStageIterations = 20;
+		const uint16_t kBodyMaxDepth = 3000;
+
+		const auto addResult = [&](const std::string& stage, double nsPerCall)
+		{
+			ofJson result = scene;
+			result["stage"] = stage;
+			result["nsPerCall"] = nsPerCall;
+			results.push_back(result);
+
+			ofLogNotice("benchmarkPipeline") << scene["source"].get<std::string>() << " " << scene["depthMode"].get<std::string>()
+				<< " " << scene["colorResolution"].get<std::string>() << " " << stage << ": " << (nsPerCall / 1000000.0) << " ms";
+		};
+
+		// Warm up with one update, the first one allocates the frame buffers. The LUTs are built in startStreaming().
+		if (!stream.update())
+		{
+			ofLogError("benchmarkPipeline") << "Stream did not produce a capture!";
+			return;
+		}
+
+		double captureNs = 0.0;
+		const double updateNs = timeNs(kUpdateIterations, [&]
+		{
+			stream.update();
+			captureNs += stream.getCaptureNs();
+		});
+		captureNs /= kUpdateIterations;
+		addResult("Stream::update pipeline", updateNs - captureNs);
+		addResult("Stream::updateCapture", captureNs);
+
+		const auto& capture = stream.getLastCapture();
+		auto depthImg = capture.get_depth_image();
+		auto colorImg = capture.get_color_image();
+		ofVbo vbo;
+
+		if (depthImg)
+		{
+			k4a::image depthToWorldImg;
+			addResult("setupImageToWorldTable depth", timeNs(kTableIterations, [&]
+			{
+				stream.setupImageToWorldTable(K4A_CALIBRATION_TYPE_DEPTH, depthToWorldImg);
+			}));
+
+			addResult("updateWorldVbo depth", timeNs(kStageIterations, [&]
+			{
+				stream.updateWorldVbo(depthImg, depthToWorldImg, vbo);
+			}));
+
+			const auto bodyIndexPix = makeBodyIndexFrame(stream.getDepthPix(), kBodyMaxDepth);
+			const std::vector<uint32_t> bodyIDs = { 1, 2 };
+			addResult("updateWorldVbo bodyIndex", timeNs(kStageIterations, [&]
+			{
+				stream.updateWorldVbo(depthImg, depthToWorldImg, vbo, nullptr, &bodyIndexPix, bodyIDs.size());
+			}));
+
+			std::vector<ofxAzureKinect::BodyStats> bodyStats;
+			addResult("computeBodyStats", timeNs(kStageIterations, [&]
+			{
+				ofxAzureKinect::computeBodyStats(bodyIndexPix, stream.getDepthPix(), stream.getDepthToWorldPix(), bodyIDs, bodyStats);
+			}));
+		}
+
+		if (colorImg)
+		{
+			k4a::image colorToWorldImg;
+			addResult("setupImageToWorldTable color", timeNs(kTableIterations, [&]
+			{
+				stream.setupImageToWorldTable(K4A_CALIBRATION_TYPE_COLOR, colorToWorldImg);
+			}));
+
+			// Compress the frame like the sensor would, to time the decode on real image content.
+			const auto& colorPix = stream.getColorPix();
+			tjhandle compressor = tjInitCompress();
+			unsigned char* jpegData = nullptr;
+			unsigned long jpegSize = 0;
+			const int compressStatus = tjCompress2(compressor, colorPix.getData(),
+				static_cast<int>(colorPix.getWidth()), 0, static_cast<int>(colorPix.getHeight()),
+				TJPF_BGRA, &jpegData, &jpegSize, TJSAMP_422, 90, TJFLAG_FASTDCT);
+			if (compressStatus == 0)
+			{
+				auto jpegImg = k4a::image::create_from_buffer(K4A_IMAGE_FORMAT_COLOR_MJPG,
+					static_cast<int>(colorPix.getWidth()), static_cast<int>(colorPix.getHeight()), 0,
+					jpegData, jpegSize, nullptr, nullptr);
+				addResult("decodeColorFrame MJPG", timeNs(kStageIterations, [&]
+				{
+					stream.decodeColorFrame(jpegImg);
+				}));
+			}
+			else
+			{
+				ofLogError("benchmarkPipeline") << "Failed to encode JPEG: " << tjGetErrorStr2(compressor);
+			}
+			tjFree(jpegData);
+			tjDestroy(compressor);
+
+			addResult("decodeColorFrame BGRA", timeNs(kStageIterations, [&]
+			{
+				stream.decodeColorFrame(colorImg);
+			}));
+
+			if (depthImg)
+			{
+				addResult("updateDepthInColorFrame", timeNs(kStageIterations, [&]
+				{
+					stream.updateDepthInColorFrame(depthImg, colorImg);
+				}));
+				addResult("updateColorInDepthFrame", timeNs(kStageIterations, [&]
+				{
+					stream.updateColorInDepthFrame(depthImg, colorImg);
+				}));
+
+				// Color space point cloud, on the depth mapped into color.
+				auto depthInColorImg = k4a::image::create(K4A_IMAGE_FORMAT_DEPTH16,
+					colorImg.get_width_pixels(), colorImg.get_height_pixels(),
+					colorImg.get_width_pixels() * static_cast<int>(sizeof(uint16_t)));
+				stream.transformation.depth_image_to_color_camera(depthImg, &depthInColorImg);
+				addResult("updateWorldVbo color", timeNs(kStageIterations, [&]
+				{
+					stream.updateWorldVbo(depthInColorImg, colorToWorldImg, vbo);
+				}));
+			}
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void ofApp::setup()
+{
+	this->results["benchmarks"] = ofJson::array();
+
+	this->benchmarkDepthPyramid();
+	this->benchmarkDepthCodec();
+	this->benchmarkPipeline();
+
+	this->results["checks"] = ofJson::array();
+	this->checkPlaybackSeek();
+
+	ofSavePrettyJson("benchmark.json", this->results);
+	ofLogNotice(__FUNCTION__) << "Results saved to " << ofToDataPath("benchmark.json", true);
+}
+
+//--------------------------------------------------------------
+void ofApp::update()
+{
+	ofExit();
+}
+
+//--------------------------------------------------------------
+void ofApp::benchmarkDepthPyramid()
+{
+	const size_t kBuildIterations = 50;
+	const size_t kQueries = 2000;
+	const std::vector<int> kRegionSizes = { 4, 16, 64, 256, 1024 };
+
+	std::mt19937 rng(7);
+
+	for (const auto& mode : kDepthModes)
+	{
+		const auto& dims = mode.dims;
+		const auto depthPix = makeDepthFrame(dims, rng);
+
+		ofxAzureKinect::DepthPyramid pyramid;
+		pyramid.update(depthPix);
+
+		auto start = Clock::now();
+		for (size_t i = 0; i < kBuildIterations; ++i)
+		{
+			pyramid.update(depthPix);
+		}
+		const double buildNs = elapsedNs(start, kBuildIterations);
+
+		ofJson build;
+		build["stage"] = "DepthPyramid::update";
+		build["depthMode"] = mode.name;
+		build["nsPerCall"] = buildNs;
+		this->results["benchmarks"].push_back(build);
+
+		for (int size : kRegionSizes)
+		{
+			const int regionWidth = std::min(size, dims.x);
+			const int regionHeight = std::min(size, dims.y);
+			std::uniform_int_distribution<int> posX(0, dims.x - regionWidth);
+			std::uniform_int_distribution<int> posY(0, dims.y - regionHeight);
+
+			std::vector<ofRectangle> regions(kQueries);
+			for (auto& region : regions)
+			{
+				region.set(posX(rng), posY(rng), regionWidth, regionHeight);
+			}
+
+			// Reference per-pixel scan, also used to validate the pyramid.
+			std::vector<uint16_t> scanMins(kQueries);
+			start = Clock::now();
+			for (size_t q = 0; q < kQueries; ++q)
+			{
+				const auto& region = regions[q];
+				uint16_t minDepth = std::numeric_limits<uint16_t>::max();
+				for (int y = region.y; y < region.y + region.height; ++y)
+				{
+					const uint16_t* row = depthPix.getData() + y * dims.x;
+					for (int x = region.x; x < region.x + region.width; ++x)
+					{
+						minDepth = (row[x] != 0 && row[x] < minDepth) ? row[x] : minDepth;
+					}
+				}
+				scanMins[q] = minDepth;
+			}
+			const double scanNs = elapsedNs(start, kQueries);
+
+			std::vector<uint16_t> pyramidMins(kQueries);
+			start = Clock::now();
+			for (size_t q = 0; q < kQueries; ++q)
+			{
+				pyramidMins[q] = pyramid.getMinDepth(regions[q]);
+			}
+			const double statsNs = elapsedNs(start, kQueries);
+
+			size_t numCloser = 0;
+			start = Clock::now();
+			for (size_t q = 0; q < kQueries; ++q)
+			{
+				numCloser += pyramid.isAnyCloserThan(regions[q], 2000) ? 1 : 0;
+			}
+			const double closerNs = elapsedNs(start, kQueries);
+
+			size_t numMismatches = 0;
+			for (size_t q = 0; q < kQueries; ++q)
+			{
+				const uint16_t expected = (scanMins[q] == std::numeric_limits<uint16_t>::max()) ? 0 : scanMins[q];
+				numMismatches += (expected != pyramidMins[q]) ? 1 : 0;
+			}
+			if (numMismatches > 0)
+			{
+				ofLogError(__FUNCTION__) << numMismatches << " pyramid queries disagree with the scan!";
+			}
+
+			ofJson query;
+			query["stage"] = "DepthPyramid::query";
+			query["depthMode"] = mode.name;
+			query["regionSize"] = { regionWidth, regionHeight };
+			query["scanNsPerQuery"] = scanNs;
+			query["statsNsPerQuery"] = statsNs;
+			query["closerNsPerQuery"] = closerNs;
+			query["mismatches"] = numMismatches;
+			this->results["benchmarks"].push_back(query);
+
+			ofLogNotice(__FUNCTION__) << mode.name << " " << regionWidth << "x" << regionHeight
+				<< " scan: " << scanNs << " ns, pyramid: " << statsNs << " ns, closer: " << closerNs << " ns";
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void ofApp::benchmarkDepthCodec()
+{
+	const size_t kNumFrames = 30;
+
+	// Recorded scenes are used when a raw recording is dropped in the data folder.
+	const auto recordingPath = ofToDataPath("benchmark.raw");
+	ofxAzureKinect::RawReader reader;
+	if (ofFile::doesFileExist(recordingPath) && reader.open(recordingPath))
+	{
+		const auto& header = reader.getHeader();
+		std::vector<ofShortPixels> frames;
+		for (size_t i = 0; i < reader.getNumFrames() && frames.size() < kNumFrames; ++i)
+		{
+			ofxAzureKinect::RawFrame frame;
+			if (reader.getFrame(i, frame) && frame.depthData)
+			{
+				frames.emplace_back();
+				frames.back().setFromPixels(frame.depthData, header.depthWidth, header.depthHeight, 1);
+			}
+		}
+		reader.close();
+
+		if (!frames.empty())
+		{
+			this->benchmarkDepthCodec("recording", frames);
+		}
+	}
+
+	std::mt19937 rng(11);
+
+	for (const auto& mode : kDepthModes)
+	{
+		std::vector<ofShortPixels> frames;
+		for (size_t i = 0; i < kNumFrames; ++i)
+		{
+			frames.push_back(makeDepthFrame(mode.dims, rng, static_cast<int>(i) * 4));
+		}
+		this->benchmarkDepthCodec(mode.name, frames);
+	}
+
+	for (const auto& resolution : kColorResolutions)
+	{
+		// Larger sequences take too much memory to hold at once.
+		if (resolution.dims.y > 1080) continue;
+
+		std::vector<ofShortPixels> frames;
+		for (size_t i = 0; i < kNumFrames; ++i)
+		{
+			frames.push_back(makeDepthFrame(resolution.dims, rng, static_cast<int>(i) * 4));
+		}
+		this->benchmarkDepthCodec("DEPTH_IN_COLOR_" + resolution.name, frames);
+	}
+}
+
+//--------------------------------------------------------------
+void ofApp::benchmarkDepthCodec(const std::string& scene, const std::vector<ofShortPixels>& frames)
+{
+	const size_t kIterations = 3;
+	const std::vector<int> kTileCounts = { 1, 0 };
+
+	const double frameBytes = static_cast<double>(frames[0].getTotalBytes());
+
+	for (bool temporalDelta : { false, true })
+	{
+		for (int numTiles : kTileCounts)
+		{
+			ofxAzureKinect::DepthCodecSettings settings;
+			settings.numTiles = numTiles;
+			settings.temporalDelta = temporalDelta;
+
+			ofxAzureKinect::DepthCodec encoder;
+			ofxAzureKinect::DepthCodec decoder;
+			encoder.setup(settings);
+			decoder.setup(settings);
+
+			std::vector<std::vector<uint8_t>> encoded(frames.size());
+			double encodeNs = 0;
+			double decodeNs = 0;
+			size_t encodedBytes = 0;
+			size_t numMismatches = 0;
+			ofShortPixels decoded;
+			for (size_t i = 0; i < kIterations; ++i)
+			{
+				// Start every pass on a keyframe, like a new connection would.
+				encoder.reset();
+				decoder.reset();
+
+				auto start = Clock::now();
+				for (size_t f = 0; f < frames.size(); ++f)
+				{
+					encoder.encode(frames[f], encoded[f]);
+				}
+				encodeNs += elapsedNs(start, frames.size());
+
+				start = Clock::now();
+				for (size_t f = 0; f < frames.size(); ++f)
+				{
+					decoder.decode(encoded[f], decoded);
+					if (i == 0)
+					{
+						numMismatches += std::equal(decoded.getData(), decoded.getData() + decoded.size(), frames[f].getData()) ? 0 : 1;
+					}
+				}
+				decodeNs += elapsedNs(start, frames.size());
+			}
+			encodeNs /= kIterations;
+			decodeNs /= kIterations;
+			for (const auto& frame : encoded)
+			{
+				encodedBytes += frame.size();
+			}
+
+			if (numMismatches > 0)
+			{
+				ofLogError(__FUNCTION__) << numMismatches << " frames did not survive the round trip!";
+			}
+
+			const double ratio = frameBytes * frames.size() / encodedBytes;
+			const double encodeMBps = frameBytes / encodeNs * 1000.0;
+			const double decodeMBps = frameBytes / decodeNs * 1000.0;
+
+			ofJson result;
+			result["stage"] = "DepthCodec";
+			result["scene"] = scene;
+			result["dims"] = { frames[0].getWidth(), frames[0].getHeight() };
+			result["numTiles"] = numTiles;
+			result["temporalDelta"] = temporalDelta;
+			result["compressionRatio"] = ratio;
+			result["encodeMBps"] = encodeMBps;
+			result["decodeMBps"] = decodeMBps;
+			result["mismatches"] = numMismatches;
+			this->results["benchmarks"].push_back(result);
+
+			ofLogNotice(__FUNCTION__) << scene << (temporalDelta ? " delta" : "") << " tiles: " << (numTiles > 0 ? ofToString(numTiles) : "auto")
+				<< " ratio: " << ratio << ", encode: " << encodeMBps << " MB/s, decode: " << decodeMBps << " MB/s";
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void ofApp::benchmarkPipeline()
+{
+	// Recorded frames are used when a raw recording is dropped in the data folder.
+	const auto recordingPath = ofToDataPath("benchmark.raw");
+	if (ofFile::doesFileExist(recordingPath))
+	{
+		ofxAzureKinect::RawPlaybackSettings settings;
+		settings.realtime = false;
+		settings.updateGpu = false;
+
+		StageStream<ofxAzureKinect::RawPlayback> playback;
+		if (playback.open(recordingPath, settings) && playback.startPlayback())
+		{
+			const auto& header = playback.getReader().getHeader();
+			ofJson scene;
+			scene["source"] = "recording";
+			scene["depthMode"] = ofToString(header.depthMode);
+			scene["colorResolution"] = ofToString(header.colorResolution);
+			for (const auto& mode : kDepthModes)
+			{
+				if (mode.mode == static_cast<ofxAzureKinect::DepthMode>(header.depthMode)) scene["depthMode"] = mode.name;
+			}
+			for (const auto& resolution : kColorResolutions)
+			{
+				if (resolution.resolution == static_cast<ofxAzureKinect::ColorResolution>(header.colorResolution)) scene["colorResolution"] = resolution.name;
+			}
+
+			benchmarkStages(playback, scene, this->results["benchmarks"]);
+		}
+		playback.close();
+	}
+
+	for (const auto& mode : kDepthModes)
+	{
+		for (const auto& resolution : kColorResolutions)
+		{
+			ofxAzureKinect::SyntheticStreamSettings settings;
+			settings.depthMode = mode.mode;
+			settings.colorResolution = resolution.resolution;
+			settings.cameraFps = K4A_FRAMES_PER_SECOND_15; // Supported by every mode.
+			settings.realtime = false;
+			settings.updateGpu = false;
+
+			StageStream<ofxAzureKinect::SyntheticStream> stream;
+			if (!stream.open(settings) || !stream.startCameras())
+			{
+				ofLogError(__FUNCTION__) << "Could not start synthetic stream " << mode.name << " " << resolution.name << "!";
+				continue;
+			}
+
+			ofJson scene;
+			scene["source"] = "synthetic";
+			scene["depthMode"] = mode.name;
+			scene["colorResolution"] = resolution.name;
+			benchmarkStages(stream, scene, this->results["benchmarks"]);
+
+			stream.close();
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void ofApp::checkPlaybackSeek()
+{
+	const size_t kNumFrames = 90;
+	const size_t kSeekFrame = 60;
+
+	// Record a short synthetic sequence to play back.
+	const auto recordingPath = ofToDataPath("seek-check.raw", true);
+	{
+		ofxAzureKinect::SyntheticStreamSettings settings;
+		settings.depthMode = K4A_DEPTH_MODE_NFOV_2X2BINNED;
+		settings.colorResolution = K4A_COLOR_RESOLUTION_OFF;
+		settings.cameraFps = K4A_FRAMES_PER_SECOND_30;
+		settings.realtime = false;
+		settings.updateGpu = false;
+
+		ofxAzureKinect::SyntheticStream stream;
+		if (!stream.open(settings) || !stream.startCameras() || !stream.startRawRecording(recordingPath))
+		{
+			ofLogError(__FUNCTION__) << "Could not record synthetic stream!";
+			return;
+		}
+		for (size_t i = 0; i < kNumFrames; ++i)
+		{
+			stream.update();
+		}
+		stream.stopRawRecording();
+		stream.close();
+	}
+
+	ofxAzureKinect::RawPlaybackSettings settings;
+	settings.realtime = false;
+	settings.loop = false;
+	settings.updateGpu = false;
+
+	ofxAzureKinect::RawPlayback playback;
+	if (!playback.open(recordingPath, settings) || !playback.startPlayback() || playback.getNumFrames() <= kSeekFrame)
+	{
+		ofLogError(__FUNCTION__) << "Could not play back " << recordingPath << "!";
+		playback.close();
+		return;
+	}
+
+	playback.update();
+	playback.update();
+
+	// Skipping ahead must not count the frames in between as dropped.
+	const uint64_t numDroppedBefore = playback.getFrameTiming().getStats().numDropped[ofxAzureKinect::FRAME_STREAM_DEPTH];
+	playback.seekFrame(kSeekFrame);
+	playback.update();
+	const uint64_t numDroppedAfter = playback.getFrameTiming().getStats().numDropped[ofxAzureKinect::FRAME_STREAM_DEPTH];
+
+	playback.close();
+	ofFile::removeFile(recordingPath);
+
+	const bool bPassed = (numDroppedAfter == numDroppedBefore);
+	if (!bPassed)
+	{
+		ofLogError(__FUNCTION__) << "Seeking counted " << (numDroppedAfter - numDroppedBefore) << " dropped frames!";
+	}
+
+	ofJson result;
+	result["check"] = "PlaybackSeek";
+	result["droppedFrames"] = numDroppedAfter - numDroppedBefore;
+	result["passed"] = bPassed;
+	this->results["checks"].push_back(result);
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "ofMain.h"
+
+#include "ofxAzureKinect.h"
+
+class ofApp 
+	: public ofBaseApp 
+{
+public:
+	void setup();
+	void update();
+
+private:
+	void benchmarkDepthPyramid();
+	void benchmarkDepthCodec();
+	void benchmarkDepthCodec(const std::string& scene, const std::vector<ofShortPixels>& frames);
+	void benchmarkPipeline();
+
+	void checkPlaybackSeek();
+
+	ofJson results;
+};
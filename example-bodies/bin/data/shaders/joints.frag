@@ -0,0 +1,12 @@
+#version 150
+
+// Custom attributes.
+
+in vec4 vColor;
+
+out vec4 fragColor;
+
+void main()
+{
+    fragColor = vColor;
+}
@@ -0,0 +1,29 @@
+#version 150
+
+// OF built-in attributes.
+
+uniform mat4 modelViewProjectionMatrix;
+
+in vec4 position;
+in vec4 color;
+
+// Custom attributes.
+
+uniform samplerBuffer uTransformTex; // Joint transforms, 4 texels (matrix columns) per joint
+
+out vec4 vColor;
+
+void main()
+{
+    int offset = gl_InstanceID * 4;
+    mat4 transform = mat4(
+        texelFetch(uTransformTex, offset + 0),
+        texelFetch(uTransformTex, offset + 1),
+        texelFetch(uTransformTex, offset + 2),
+        texelFetch(uTransformTex, offset + 3)
+    );
+
+    vColor = color;
+
+    gl_Position = modelViewProjectionMatrix * transform * position;
+}
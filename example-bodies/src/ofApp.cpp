@@ -32,6 +32,18 @@ void ofApp::setup()
 		ofLogNotice(__FUNCTION__) << "Success loading shader!";
 	}
 
+	auto jointShaderSettings = ofShaderSettings();
+	jointShaderSettings.shaderFiles[GL_VERTEX_SHADER] = "shaders/joints.vert";
+	jointShaderSettings.shaderFiles[GL_FRAGMENT_SHADER] = "shaders/joints.frag";
+	jointShaderSettings.bindDefaults = true;
+	if (this->jointShader.setup(jointShaderSettings))
+	{
+		ofLogNotice(__FUNCTION__) << "Success loading joint shader!";
+	}
+
+	// Setup joint mesh, drawn once per joint.
+	this->jointMesh = ofMesh::axis(50.0f);
+
 	// Setup vbo.
 	std::vector<glm::vec3> verts(1);
 	this->pointsVbo.setVertexData(verts.data(), verts.size(), GL_STATIC_DRAW);
@@ -96,112 +108,22 @@ void ofApp::draw()
 
 			ofDisableDepthTest();
 
-			auto& bodySkeletons = this->kinectDevice.getBodySkeletons();
-			for (auto& skeleton : bodySkeletons)
+			const auto& skeletonBuffers = this->kinectDevice.getSkeletonBuffers();
+
+			// Draw joints for all bodies in one instanced call.
+			if (skeletonBuffers.getTransformTex().isAllocated())
 			{
-				// Draw joints.
-				for (int i = 0; i < K4ABT_JOINT_COUNT; ++i)
+				this->jointShader.begin();
 				{
-					auto joint = skeleton.joints[i];
-					ofPushMatrix();
-					{
-						glm::mat4 transform = glm::translate(toGlm(joint.position)) * glm::toMat4(toGlm(joint.orientation));
-						ofMultMatrix(transform);
-
-						ofDrawAxis(50.0f);
-					}
-					ofPopMatrix();
-				}
-
-				// Draw connections.
-				this->skeletonMesh.setMode(OF_PRIMITIVE_LINES);
-				auto& vertices = this->skeletonMesh.getVertices();
-				vertices.resize(50);
-				int vdx = 0;
-
-				// Spine.
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_PELVIS].position);
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_SPINE_NAVAL].position);
-
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_SPINE_NAVAL].position);
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_SPINE_CHEST].position);
-
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_SPINE_CHEST].position);
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_NECK].position);
-
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_NECK].position);
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_HEAD].position);
-
-				// Head.
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_HEAD].position);
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_NOSE].position);
-
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_NOSE].position);
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_EYE_LEFT].position);
-
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_EYE_LEFT].position);
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_EAR_LEFT].position);
-
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_NOSE].position);
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_EYE_RIGHT].position);
-
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_EYE_RIGHT].position);
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_EAR_RIGHT].position);
-
-				// Left Leg.
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_PELVIS].position);
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_HIP_LEFT].position);
+					this->jointShader.setUniformTexture("uTransformTex", skeletonBuffers.getTransformTex(), 1);
 
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_HIP_LEFT].position);
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_KNEE_LEFT].position);
-
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_KNEE_LEFT].position);
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_ANKLE_LEFT].position);
-
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_ANKLE_LEFT].position);
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_FOOT_LEFT].position);
-
-				// Right leg.
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_PELVIS].position);
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_HIP_RIGHT].position);
-
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_HIP_RIGHT].position);
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_KNEE_RIGHT].position);
-
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_KNEE_RIGHT].position);
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_ANKLE_RIGHT].position);
-
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_ANKLE_RIGHT].position);
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_FOOT_RIGHT].position);
-
-				// Left arm.
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_NECK].position);
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_CLAVICLE_LEFT].position);
-
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_CLAVICLE_LEFT].position);
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_SHOULDER_LEFT].position);
-
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_SHOULDER_LEFT].position);
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_ELBOW_LEFT].position);
-
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_ELBOW_LEFT].position);
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_WRIST_LEFT].position);
-
-				// Right arm.
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_NECK].position);
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_CLAVICLE_RIGHT].position);
-
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_CLAVICLE_RIGHT].position);
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_SHOULDER_RIGHT].position);
-
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_SHOULDER_RIGHT].position);
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_ELBOW_RIGHT].position);
-
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_ELBOW_RIGHT].position);
-				vertices[vdx++] = toGlm(skeleton.joints[K4ABT_JOINT_WRIST_RIGHT].position);
-
-				this->skeletonMesh.draw();
+					skeletonBuffers.drawJointsInstanced(this->jointMesh);
+				}
+				this->jointShader.end();
 			}
+
+			// Draw connections for all bodies in one call.
+			skeletonBuffers.drawBones();
 		}
 		ofPopMatrix();
 	}
@@ -34,5 +34,6 @@ private:
 	ofVbo pointsVbo;
 	ofShader shader;
 
-	ofVboMesh skeletonMesh;
+	ofVboMesh jointMesh;
+	ofShader jointShader;
 };
@@ -1,5 +1,28 @@
 #pragma once
 
+#include "ofxAzureKinect/BackgroundModel.h"
+#include "ofxAzureKinect/BlobFinder.h"
+#include "ofxAzureKinect/BodyStats.h"
+#include "ofxAzureKinect/DepthCodec.h"
+#include "ofxAzureKinect/DepthPyramid.h"
 #include "ofxAzureKinect/Device.h"
+#include "ofxAzureKinect/FloorEstimator.h"
+#include "ofxAzureKinect/FrameTiming.h"
+#include "ofxAzureKinect/HeightMap.h"
+#include "ofxAzureKinect/ImageConversion.h"
+#include "ofxAzureKinect/JointProjector.h"
+#include "ofxAzureKinect/PipelineStats.h"
+#include "ofxAzureKinect/Playback.h"
+#include "ofxAzureKinect/PoseMatcher.h"
+#include "ofxAzureKinect/RawPlayback.h"
+#include "ofxAzureKinect/RawReader.h"
+#include "ofxAzureKinect/RawRecorder.h"
+#include "ofxAzureKinect/Recorder.h"
+#include "ofxAzureKinect/SkeletonBuffers.h"
+#include "ofxAzureKinect/SkeletonFilter.h"
+#include "ofxAzureKinect/SkeletonHistory.h"
+#include "ofxAzureKinect/Stream.h"
+#include "ofxAzureKinect/SyntheticStream.h"
 #include "ofxAzureKinect/Types.h"
+#include "ofxAzureKinect/ZoneCounter.h"
 
@@ -0,0 +1,204 @@
+#include "BackgroundModel.h"
+
+#include "ofLog.h"
+
+#include "Parallel.h"
+
+namespace ofxAzureKinect
+{
+	BackgroundSettings::BackgroundSettings()
+		: learningRate(0.05f)
+		, thresholdSigma(3.0f)
+		, minThreshold(30)
+		, foregroundOverEmpty(true)
+		, updateTexture(true)
+	{}
+
+	BackgroundModel::BackgroundModel()
+		: bLearning(true)
+		, numFrames(0)
+		, numForeground(0)
+	{}
+
+	BackgroundModel::~BackgroundModel()
+	{}
+
+	void BackgroundModel::setup(const BackgroundSettings& settings)
+	{
+		this->settings = settings;
+	}
+
+	void BackgroundModel::reset()
+	{
+		this->meanPix.clear();
+		this->variancePix.clear();
+		this->minPix.clear();
+		this->numFrames = 0;
+		this->numForeground = 0;
+	}
+
+	void BackgroundModel::setLearning(bool learning)
+	{
+		this->bLearning = learning;
+	}
+
+	bool BackgroundModel::isLearning() const
+	{
+		return this->bLearning;
+	}
+
+	bool BackgroundModel::allocate(int width, int height)
+	{
+		if (this->meanPix.isAllocated() &&
+			static_cast<int>(this->meanPix.getWidth()) == width &&
+			static_cast<int>(this->meanPix.getHeight()) == height)
+		{
+			return false;
+		}
+
+		this->meanPix.allocate(width, height, 1);
+		this->meanPix.set(0);
+		this->variancePix.allocate(width, height, 1);
+		this->variancePix.set(0);
+		this->minPix.allocate(width, height, 1);
+		this->minPix.set(0);
+
+		this->foregroundPix.allocate(width, height, 1);
+		this->foregroundPix.set(0);
+		if (this->settings.updateTexture)
+		{
+			this->foregroundTex.allocate(width, height, GL_R8);
+			this->foregroundTex.setTextureMinMagFilter(GL_NEAREST, GL_NEAREST);
+			this->foregroundTex.setRGToRGBASwizzles(true);
+		}
+
+		this->numFrames = 0;
+
+		return true;
+	}
+
+	bool BackgroundModel::update(const ofShortPixels& depthPix)
+	{
+		if (!depthPix.isAllocated())
+		{
+			ofLogWarning(__FUNCTION__) << "Depth pixels not allocated!";
+			return false;
+		}
+
+		const int width = static_cast<int>(depthPix.getWidth());
+		const int height = static_cast<int>(depthPix.getHeight());
+		if (this->allocate(width, height))
+		{
+			ofLogVerbose(__FUNCTION__) << "Allocated background model " << width << "x" << height << ".";
+		}
+
+		const uint16_t* depthData = depthPix.getData();
+		float* meanData = this->meanPix.getData();
+		float* varianceData = this->variancePix.getData();
+		uint16_t* minData = this->minPix.getData();
+		uint8_t* foregroundData = this->foregroundPix.getData();
+
+		const bool learning = this->bLearning;
+		// Average the first frames cumulatively so the model settles quickly after a reset.
+		const float rate = std::max(this->settings.learningRate, 1.0f / static_cast<float>(this->numFrames + 1));
+		const float minThresholdSq = static_cast<float>(this->settings.minThreshold) * static_cast<float>(this->settings.minThreshold);
+		const float sigmaSq = this->settings.thresholdSigma * this->settings.thresholdSigma;
+		const uint8_t overEmpty = this->settings.foregroundOverEmpty ? 255 : 0;
+
+		const int numChunks = getNumParallelChunks(height, 16, width);
+		std::vector<size_t> chunkCounts(numChunks, 0);
+
+		parallelForChunks(0, height, numChunks, [&](int chunk, int rowBegin, int rowEnd)
+		{
+			const int begin = rowBegin * width;
+			const int end = rowEnd * width;
+
+			// Classify against the current model. Written as selects so the loop vectorizes.
+			size_t count = 0;
+			for (int i = begin; i < end; ++i)
+			{
+				const float d = static_cast<float>(depthData[i]);
+				const float m = meanData[i];
+				const float diff = m - d;
+				const float threshold = std::max(minThresholdSq, sigmaSq * varianceData[i]);
+				const uint8_t closer = (diff > 0.0f && diff * diff > threshold) ? 255 : 0;
+				const uint8_t fg = (d > 0.0f) ? ((m > 0.0f) ? closer : overEmpty) : 0;
+				foregroundData[i] = fg;
+				count += fg & 1;
+			}
+			chunkCounts[chunk] = count;
+
+			if (!learning) return;
+
+			for (int i = begin; i < end; ++i)
+			{
+				const uint16_t raw = depthData[i];
+				const float d = static_cast<float>(raw);
+				const float m = meanData[i];
+				const float v = varianceData[i];
+				const float delta = d - m;
+				const float mUpdated = (m > 0.0f) ? m + rate * delta : d;
+				const float vUpdated = (m > 0.0f) ? (1.0f - rate) * (v + rate * delta * delta) : 0.0f;
+				meanData[i] = (raw != 0) ? mUpdated : m;
+				varianceData[i] = (raw != 0) ? vUpdated : v;
+
+				const uint16_t prevMin = minData[i];
+				const uint16_t newMin = (prevMin == 0 || raw < prevMin) ? raw : prevMin;
+				minData[i] = (raw != 0) ? newMin : prevMin;
+			}
+		});
+
+		this->numForeground = 0;
+		for (auto count : chunkCounts)
+		{
+			this->numForeground += count;
+		}
+
+		if (learning)
+		{
+			++this->numFrames;
+		}
+
+		if (this->settings.updateTexture)
+		{
+			this->foregroundTex.loadData(this->foregroundPix);
+		}
+
+		return true;
+	}
+
+	const ofPixels& BackgroundModel::getForegroundPix() const
+	{
+		return this->foregroundPix;
+	}
+
+	const ofTexture& BackgroundModel::getForegroundTex() const
+	{
+		return this->foregroundTex;
+	}
+
+	const ofFloatPixels& BackgroundModel::getMeanPix() const
+	{
+		return this->meanPix;
+	}
+
+	const ofFloatPixels& BackgroundModel::getVariancePix() const
+	{
+		return this->variancePix;
+	}
+
+	const ofShortPixels& BackgroundModel::getMinPix() const
+	{
+		return this->minPix;
+	}
+
+	size_t BackgroundModel::getNumFrames() const
+	{
+		return this->numFrames;
+	}
+
+	size_t BackgroundModel::getNumForeground() const
+	{
+		return this->numForeground;
+	}
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "ofPixels.h"
+#include "ofTexture.h"
+
+namespace ofxAzureKinect
+{
+	struct BackgroundSettings
+	{
+		// Weight of each new frame in the running mean and variance.
+		float learningRate;
+
+		// Foreground must be this many standard deviations closer than the background.
+		float thresholdSigma;
+
+		// Lower bound of the threshold in mm, so low noise pixels don't flicker.
+		uint16_t minThreshold;
+
+		// Valid depth over pixels without any background data counts as foreground.
+		bool foregroundOverEmpty;
+
+		// Upload the foreground mask to a texture every update.
+		bool updateTexture;
+
+		BackgroundSettings();
+	};
+
+	class BackgroundModel
+	{
+	public:
+		BackgroundModel();
+		~BackgroundModel();
+
+		void setup(const BackgroundSettings& settings);
+		void reset();
+
+		void setLearning(bool learning);
+		bool isLearning() const;
+
+		bool update(const ofShortPixels& depthPix);
+
+		const ofPixels& getForegroundPix() const;
+		const ofTexture& getForegroundTex() const;
+
+		const ofFloatPixels& getMeanPix() const;
+		const ofFloatPixels& getVariancePix() const;
+		const ofShortPixels& getMinPix() const;
+
+		size_t getNumFrames() const;
+		size_t getNumForeground() const;
+
+	private:
+		bool allocate(int width, int height);
+
+	private:
+		BackgroundSettings settings;
+		bool bLearning;
+		size_t numFrames;
+		size_t numForeground;
+
+		ofFloatPixels meanPix;
+		ofFloatPixels variancePix;
+		ofShortPixels minPix;
+
+		ofPixels foregroundPix;
+		ofTexture foregroundTex;
+	};
+}
@@ -0,0 +1,394 @@
+#include "BlobFinder.h"
+
+#include <algorithm>
+
+#include "ofLog.h"
+
+#include "Parallel.h"
+
+namespace
+{
+	// Union-find over pixel indices. Roots always link to the smaller index, so the
+	// root of a component is its first pixel in raster order.
+	inline int32_t findRoot(int32_t* parents, int32_t i)
+	{
+		while (parents[i] != i)
+		{
+			parents[i] = parents[parents[i]];
+			i = parents[i];
+		}
+		return i;
+	}
+
+	// Read-only variant, safe to call from several threads once all unions are done.
+	inline int32_t findRootConst(const int32_t* parents, int32_t i)
+	{
+		while (parents[i] != i)
+		{
+			i = parents[i];
+		}
+		return i;
+	}
+
+	inline void unite(int32_t* parents, int32_t a, int32_t b)
+	{
+		a = findRoot(parents, a);
+		b = findRoot(parents, b);
+		if (a < b)
+		{
+			parents[b] = a;
+		}
+		else if (b < a)
+		{
+			parents[a] = b;
+		}
+	}
+
+	struct BlobAccumulator
+	{
+		size_t area;
+		size_t numDepth;
+		size_t numWorld;
+		double sumX;
+		double sumY;
+		double sumDepth;
+		glm::dvec3 sumWorld;
+		glm::ivec2 minPos;
+		glm::ivec2 maxPos;
+	};
+}
+
+namespace ofxAzureKinect
+{
+	BlobSettings::BlobSettings()
+		: minArea(200)
+		, maxBlobs(0)
+		, connectivity8(true)
+		, maxTrackingDistance(300.0f)
+	{}
+
+	BlobFinder::BlobFinder()
+		: nextId(0)
+	{}
+
+	BlobFinder::~BlobFinder()
+	{}
+
+	void BlobFinder::setup(const BlobSettings& settings)
+	{
+		this->settings = settings;
+	}
+
+	bool BlobFinder::update(const ofPixels& maskPix, const ofShortPixels& depthPix, const ofFloatPixels& depthToWorldPix)
+	{
+		if (!maskPix.isAllocated())
+		{
+			ofLogWarning(__FUNCTION__) << "Mask pixels not allocated!";
+			return false;
+		}
+
+		const int width = static_cast<int>(maskPix.getWidth());
+		const int height = static_cast<int>(maskPix.getHeight());
+		const int numPixels = width * height;
+
+		const bool hasDepth = depthPix.isAllocated() &&
+			static_cast<int>(depthPix.getWidth()) == width && static_cast<int>(depthPix.getHeight()) == height;
+		const bool hasWorld = hasDepth && depthToWorldPix.isAllocated() &&
+			static_cast<int>(depthToWorldPix.getWidth()) == width && static_cast<int>(depthToWorldPix.getHeight()) == height;
+
+		const uint8_t* maskData = maskPix.getData();
+		const uint16_t* depthData = hasDepth ? depthPix.getData() : nullptr;
+		const glm::vec2* worldData = hasWorld ? reinterpret_cast<const glm::vec2*>(depthToWorldPix.getData()) : nullptr;
+
+		this->parents.resize(numPixels);
+		this->labels.resize(numPixels);
+		int32_t* parentData = this->parents.data();
+		int32_t* labelData = this->labels.data();
+
+		const bool conn8 = this->settings.connectivity8;
+
+		// Label each strip of rows independently. Unions only touch pixels inside the strip.
+		const int numChunks = getNumParallelChunks(height, 16, width);
+		const int chunkRows = (height + numChunks - 1) / numChunks;
+		parallelForChunks(0, height, numChunks, [&](int, int rowBegin, int rowEnd)
+		{
+			for (int y = rowBegin; y < rowEnd; ++y)
+			{
+				const int row = y * width;
+				for (int x = 0; x < width; ++x)
+				{
+					const int idx = row + x;
+					parentData[idx] = idx;
+					if (!maskData[idx]) continue;
+
+					if (x > 0 && maskData[idx - 1])
+					{
+						unite(parentData, idx, idx - 1);
+					}
+					if (y > rowBegin)
+					{
+						const int up = idx - width;
+						if (maskData[up])
+						{
+							unite(parentData, idx, up);
+						}
+						if (conn8)
+						{
+							if (x > 0 && maskData[up - 1])
+							{
+								unite(parentData, idx, up - 1);
+							}
+							if (x < width - 1 && maskData[up + 1])
+							{
+								unite(parentData, idx, up + 1);
+							}
+						}
+					}
+				}
+			}
+		});
+
+		// Stitch strips together along their top rows.
+		for (int y = chunkRows; y < height; y += chunkRows)
+		{
+			const int row = y * width;
+			for (int x = 0; x < width; ++x)
+			{
+				const int idx = row + x;
+				if (!maskData[idx]) continue;
+
+				const int up = idx - width;
+				if (maskData[up])
+				{
+					unite(parentData, idx, up);
+				}
+				if (conn8)
+				{
+					if (x > 0 && maskData[up - 1])
+					{
+						unite(parentData, idx, up - 1);
+					}
+					if (x < width - 1 && maskData[up + 1])
+					{
+						unite(parentData, idx, up + 1);
+					}
+				}
+			}
+		}
+
+		// Resolve roots and count them per strip.
+		std::vector<int32_t> chunkRoots(numChunks, 0);
+		parallelForChunks(0, height, numChunks, [&](int chunk, int rowBegin, int rowEnd)
+		{
+			int32_t count = 0;
+			for (int idx = rowBegin * width; idx < rowEnd * width; ++idx)
+			{
+				if (!maskData[idx]) continue;
+
+				const int32_t root = findRootConst(parentData, idx);
+				labelData[idx] = root;
+				count += (root == idx);
+			}
+			chunkRoots[chunk] = count;
+		});
+
+		// Give roots compact IDs. The first pixel of each component is its root, so
+		// roots are numbered in raster order and no other strip reads them yet.
+		std::vector<int32_t> chunkOffsets(numChunks, 0);
+		int32_t numComponents = 0;
+		for (int i = 0; i < numChunks; ++i)
+		{
+			chunkOffsets[i] = numComponents;
+			numComponents += chunkRoots[i];
+		}
+
+		parallelForChunks(0, height, numChunks, [&](int chunk, int rowBegin, int rowEnd)
+		{
+			int32_t next = chunkOffsets[chunk];
+			for (int idx = rowBegin * width; idx < rowEnd * width; ++idx)
+			{
+				if (maskData[idx] && labelData[idx] == idx)
+				{
+					parentData[idx] = next++;
+				}
+			}
+		});
+
+		// Accumulate component stats per strip. A strip's own roots have a contiguous ID range,
+		// so it writes those straight into the shared array. Components rooted in earlier strips
+		// can only reach a strip through its first row, those few get private accumulators
+		// that are merged afterwards.
+		BlobAccumulator emptyAccum;
+		emptyAccum.area = 0;
+		emptyAccum.numDepth = 0;
+		emptyAccum.numWorld = 0;
+		emptyAccum.sumX = emptyAccum.sumY = emptyAccum.sumDepth = 0.0;
+		emptyAccum.sumWorld = glm::dvec3(0.0);
+		emptyAccum.minPos = glm::ivec2(width, height);
+		emptyAccum.maxPos = glm::ivec2(-1, -1);
+
+		std::vector<BlobAccumulator> accums(numComponents);
+		std::vector<std::vector<int32_t>> chunkForeignIds(numChunks);
+		std::vector<std::vector<BlobAccumulator>> chunkForeignAccums(numChunks);
+		parallelForChunks(0, height, numChunks, [&](int chunk, int rowBegin, int rowEnd)
+		{
+			const int32_t ownBegin = chunkOffsets[chunk];
+			std::fill(accums.begin() + ownBegin, accums.begin() + ownBegin + chunkRoots[chunk], emptyAccum);
+
+			auto& foreignIds = chunkForeignIds[chunk];
+			auto& foreignAccums = chunkForeignAccums[chunk];
+			for (int idx = rowBegin * width; idx < std::min(rowBegin + 1, rowEnd) * width; ++idx)
+			{
+				if (maskData[idx] && parentData[labelData[idx]] < ownBegin)
+				{
+					foreignIds.push_back(parentData[labelData[idx]]);
+				}
+			}
+			std::sort(foreignIds.begin(), foreignIds.end());
+			foreignIds.erase(std::unique(foreignIds.begin(), foreignIds.end()), foreignIds.end());
+			foreignAccums.assign(foreignIds.size(), emptyAccum);
+
+			// Foreign pixels come in runs of the same component, remember the last one.
+			int32_t lastForeignId = -1;
+			BlobAccumulator* lastForeignAccum = nullptr;
+			for (int y = rowBegin; y < rowEnd; ++y)
+			{
+				for (int x = 0; x < width; ++x)
+				{
+					const int idx = y * width + x;
+					if (!maskData[idx]) continue;
+
+					const int32_t id = parentData[labelData[idx]];
+					BlobAccumulator* accumPtr;
+					if (id >= ownBegin)
+					{
+						accumPtr = &accums[id];
+					}
+					else if (id == lastForeignId)
+					{
+						accumPtr = lastForeignAccum;
+					}
+					else
+					{
+						const auto it = std::lower_bound(foreignIds.begin(), foreignIds.end(), id);
+						accumPtr = &foreignAccums[it - foreignIds.begin()];
+						lastForeignId = id;
+						lastForeignAccum = accumPtr;
+					}
+
+					auto& accum = *accumPtr;
+					++accum.area;
+					accum.sumX += x;
+					accum.sumY += y;
+					accum.minPos = glm::min(accum.minPos, glm::ivec2(x, y));
+					accum.maxPos = glm::max(accum.maxPos, glm::ivec2(x, y));
+
+					if (depthData && depthData[idx] != 0)
+					{
+						const double depthVal = depthData[idx];
+						accum.sumDepth += depthVal;
+						++accum.numDepth;
+						if (worldData && worldData[idx].x != 0 && worldData[idx].y != 0)
+						{
+							accum.sumWorld += glm::dvec3(worldData[idx].x * depthVal, worldData[idx].y * depthVal, depthVal);
+							++accum.numWorld;
+						}
+					}
+				}
+			}
+		});
+
+		// Merge the components that span strips, at most a row's worth per strip.
+		for (int chunk = 0; chunk < numChunks; ++chunk)
+		{
+			const auto& foreignIds = chunkForeignIds[chunk];
+			const auto& foreignAccums = chunkForeignAccums[chunk];
+			for (size_t i = 0; i < foreignIds.size(); ++i)
+			{
+				auto& total = accums[foreignIds[i]];
+				const auto& accum = foreignAccums[i];
+				total.area += accum.area;
+				total.numDepth += accum.numDepth;
+				total.numWorld += accum.numWorld;
+				total.sumX += accum.sumX;
+				total.sumY += accum.sumY;
+				total.sumDepth += accum.sumDepth;
+				total.sumWorld += accum.sumWorld;
+				total.minPos = glm::min(total.minPos, accum.minPos);
+				total.maxPos = glm::max(total.maxPos, accum.maxPos);
+			}
+		}
+
+		std::vector<Blob> frameBlobs;
+		frameBlobs.reserve(numComponents);
+		for (int32_t c = 0; c < numComponents; ++c)
+		{
+			const auto& total = accums[c];
+			if (total.area < this->settings.minArea) continue;
+
+			Blob blob;
+			blob.id = 0;
+			blob.area = total.area;
+			blob.centroid = glm::vec2(total.sumX / total.area, total.sumY / total.area);
+			blob.bounds = ofRectangle(total.minPos.x, total.minPos.y,
+				total.maxPos.x - total.minPos.x + 1, total.maxPos.y - total.minPos.y + 1);
+			blob.worldCentroid = (total.numWorld > 0) ? glm::vec3(total.sumWorld / static_cast<double>(total.numWorld)) : glm::vec3(0.0f);
+			blob.meanDepth = (total.numDepth > 0) ? static_cast<float>(total.sumDepth / total.numDepth) : 0.0f;
+			frameBlobs.push_back(blob);
+		}
+
+		std::sort(frameBlobs.begin(), frameBlobs.end(), [](const Blob& a, const Blob& b)
+		{
+			return a.area > b.area;
+		});
+		if (this->settings.maxBlobs > 0 && frameBlobs.size() > this->settings.maxBlobs)
+		{
+			frameBlobs.resize(this->settings.maxBlobs);
+		}
+
+		this->trackBlobs(frameBlobs);
+		this->blobs.swap(frameBlobs);
+
+		ofLogVerbose(__FUNCTION__) << this->blobs.size() << " blobs found from " << numComponents << " components.";
+
+		return true;
+	}
+
+	void BlobFinder::trackBlobs(std::vector<Blob>& frameBlobs)
+	{
+		// Greedy nearest neighbour matching, largest blobs pick first.
+		const float maxDistSq = this->settings.maxTrackingDistance * this->settings.maxTrackingDistance;
+		std::vector<bool> claimed(this->blobs.size(), false);
+		for (auto& blob : frameBlobs)
+		{
+			int bestIdx = -1;
+			float bestDistSq = maxDistSq;
+			for (size_t i = 0; i < this->blobs.size(); ++i)
+			{
+				if (claimed[i]) continue;
+
+				const float distSq = glm::distance2(blob.worldCentroid, this->blobs[i].worldCentroid);
+				if (distSq < bestDistSq)
+				{
+					bestDistSq = distSq;
+					bestIdx = static_cast<int>(i);
+				}
+			}
+
+			if (bestIdx >= 0)
+			{
+				claimed[bestIdx] = true;
+				blob.id = this->blobs[bestIdx].id;
+			}
+			else
+			{
+				blob.id = this->nextId++;
+			}
+		}
+	}
+
+	const std::vector<Blob>& BlobFinder::getBlobs() const
+	{
+		return this->blobs;
+	}
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "ofPixels.h"
+#include "ofRectangle.h"
+#include "ofVectorMath.h"
+
+namespace ofxAzureKinect
+{
+	struct Blob
+	{
+		// Persistent ID, matched frame to frame by nearest 3D centroid.
+		uint32_t id;
+
+		size_t area;
+		glm::vec2 centroid;
+		glm::vec3 worldCentroid;
+		ofRectangle bounds;
+		float meanDepth;
+	};
+
+	struct BlobSettings
+	{
+		// Components smaller than this many pixels are dropped.
+		size_t minArea;
+
+		// Maximum number of blobs kept, largest first. 0 keeps all.
+		size_t maxBlobs;
+
+		// Use 8-connectivity, 4-connectivity otherwise.
+		bool connectivity8;
+
+		// Maximum centroid distance in mm for a blob to keep its ID from the last frame.
+		float maxTrackingDistance;
+
+		BlobSettings();
+	};
+
+	class BlobFinder
+	{
+	public:
+		BlobFinder();
+		~BlobFinder();
+
+		void setup(const BlobSettings& settings);
+
+		bool update(const ofPixels& maskPix, const ofShortPixels& depthPix, const ofFloatPixels& depthToWorldPix);
+
+		const std::vector<Blob>& getBlobs() const;
+
+	private:
+		void trackBlobs(std::vector<Blob>& blobs);
+
+	private:
+		BlobSettings settings;
+
+		std::vector<int32_t> parents;
+		std::vector<int32_t> labels;
+
+		std::vector<Blob> blobs;
+		uint32_t nextId;
+	};
+}
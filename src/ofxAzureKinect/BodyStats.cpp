@@ -0,0 +1,148 @@
+#include "BodyStats.h"
+
+#include <limits>
+
+#include <k4abttypes.h>
+
+#include "ofLog.h"
+
+#include "Parallel.h"
+
+namespace
+{
+	struct BodyAccumulator
+	{
+		size_t area;
+		size_t numDepth;
+		size_t numWorld;
+		double sumDepth;
+		glm::dvec3 sumWorld;
+		glm::ivec2 minPos;
+		glm::ivec2 maxPos;
+		glm::vec3 minWorld;
+		glm::vec3 maxWorld;
+	};
+}
+
+namespace ofxAzureKinect
+{
+	bool computeBodyStats(const ofPixels& bodyIndexPix, const ofShortPixels& depthPix, const ofFloatPixels& depthToWorldPix,
+		const std::vector<uint32_t>& bodyIDs, std::vector<BodyStats>& stats)
+	{
+		stats.clear();
+		if (!bodyIndexPix.isAllocated()) return false;
+
+		const int width = static_cast<int>(bodyIndexPix.getWidth());
+		const int height = static_cast<int>(bodyIndexPix.getHeight());
+		const int numBodies = static_cast<int>(std::min<size_t>(bodyIDs.size(), K4ABT_BODY_INDEX_MAP_BACKGROUND));
+		if (numBodies == 0) return true;
+
+		const uint16_t* depthData = nullptr;
+		if (depthPix.isAllocated())
+		{
+			if (depthPix.getWidth() != bodyIndexPix.getWidth() || depthPix.getHeight() != bodyIndexPix.getHeight())
+			{
+				ofLogError(__FUNCTION__) << "Depth dims mismatch!";
+				return false;
+			}
+			depthData = depthPix.getData();
+		}
+
+		const glm::vec2* worldData = nullptr;
+		if (depthData && depthToWorldPix.isAllocated())
+		{
+			if (depthToWorldPix.getWidth() != bodyIndexPix.getWidth() || depthToWorldPix.getHeight() != bodyIndexPix.getHeight())
+			{
+				ofLogError(__FUNCTION__) << "Depth to world dims mismatch!";
+				return false;
+			}
+			worldData = reinterpret_cast<const glm::vec2*>(depthToWorldPix.getData());
+		}
+
+		const uint8_t* indexData = bodyIndexPix.getData();
+
+		BodyAccumulator emptyAccum;
+		emptyAccum.area = emptyAccum.numDepth = emptyAccum.numWorld = 0;
+		emptyAccum.sumDepth = 0.0;
+		emptyAccum.sumWorld = glm::dvec3(0.0);
+		emptyAccum.minPos = glm::ivec2(width, height);
+		emptyAccum.maxPos = glm::ivec2(-1, -1);
+		emptyAccum.minWorld = glm::vec3(std::numeric_limits<float>::max());
+		emptyAccum.maxWorld = glm::vec3(std::numeric_limits<float>::lowest());
+
+		const int numChunks = getNumParallelChunks(height, 16, width);
+		std::vector<std::vector<BodyAccumulator>> chunkAccums(numChunks);
+		parallelForChunks(0, height, numChunks, [&](int chunk, int rowBegin, int rowEnd)
+		{
+			auto& accums = chunkAccums[chunk];
+			accums.assign(numBodies, emptyAccum);
+			for (int y = rowBegin; y < rowEnd; ++y)
+			{
+				for (int x = 0; x < width; ++x)
+				{
+					const int idx = y * width + x;
+					const int bodyIdx = indexData[idx];
+					if (bodyIdx >= numBodies) continue;
+
+					auto& accum = accums[bodyIdx];
+					++accum.area;
+					accum.minPos = glm::min(accum.minPos, glm::ivec2(x, y));
+					accum.maxPos = glm::max(accum.maxPos, glm::ivec2(x, y));
+
+					if (depthData && depthData[idx] != 0)
+					{
+						const float depthVal = depthData[idx];
+						accum.sumDepth += depthVal;
+						++accum.numDepth;
+						if (worldData && worldData[idx].x != 0 && worldData[idx].y != 0)
+						{
+							const glm::vec3 pos(worldData[idx].x * depthVal, worldData[idx].y * depthVal, depthVal);
+							accum.sumWorld += glm::dvec3(pos);
+							accum.minWorld = glm::min(accum.minWorld, pos);
+							accum.maxWorld = glm::max(accum.maxWorld, pos);
+							++accum.numWorld;
+						}
+					}
+				}
+			}
+		});
+
+		stats.resize(numBodies);
+		for (int b = 0; b < numBodies; ++b)
+		{
+			BodyAccumulator total = emptyAccum;
+			for (const auto& accums : chunkAccums)
+			{
+				const auto& accum = accums[b];
+				total.area += accum.area;
+				total.numDepth += accum.numDepth;
+				total.numWorld += accum.numWorld;
+				total.sumDepth += accum.sumDepth;
+				total.sumWorld += accum.sumWorld;
+				total.minPos = glm::min(total.minPos, accum.minPos);
+				total.maxPos = glm::max(total.maxPos, accum.maxPos);
+				total.minWorld = glm::min(total.minWorld, accum.minWorld);
+				total.maxWorld = glm::max(total.maxWorld, accum.maxWorld);
+			}
+
+			auto& bodyStats = stats[b];
+			bodyStats.id = bodyIDs[b];
+			bodyStats.area = total.area;
+			bodyStats.bounds = (total.area > 0) ? ofRectangle(total.minPos.x, total.minPos.y,
+				total.maxPos.x - total.minPos.x + 1, total.maxPos.y - total.minPos.y + 1) : ofRectangle();
+			bodyStats.meanDepth = (total.numDepth > 0) ? static_cast<float>(total.sumDepth / total.numDepth) : 0.0f;
+			if (total.numWorld > 0)
+			{
+				bodyStats.centroid = glm::vec3(total.sumWorld / static_cast<double>(total.numWorld));
+				bodyStats.minBounds = total.minWorld;
+				bodyStats.maxBounds = total.maxWorld;
+			}
+			else
+			{
+				bodyStats.centroid = bodyStats.minBounds = bodyStats.maxBounds = glm::vec3(0.0f);
+			}
+		}
+
+		return true;
+	}
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "ofPixels.h"
+#include "ofRectangle.h"
+#include "ofVectorMath.h"
+
+namespace ofxAzureKinect
+{
+	struct BodyStats
+	{
+		// Tracker body ID, matches getBodyIDs().
+		uint32_t id;
+
+		// Pixel count and 2D bounding box in the body index map.
+		size_t area;
+		ofRectangle bounds;
+
+		// Over pixels with valid depth, in mm.
+		float meanDepth;
+
+		// Over pixels with valid depth and a valid LUT entry, in depth camera space, in mm.
+		glm::vec3 centroid;
+		glm::vec3 minBounds;
+		glm::vec3 maxBounds;
+	};
+
+	// Computes the stats of all bodies in one pass over the body index map, depth and depth to world LUT.
+	// Depth and LUT may be unallocated, in which case only the 2D stats are filled in.
+	// Stats are written in the same order as bodyIDs, which matches the indices in the body index map.
+	bool computeBodyStats(const ofPixels& bodyIndexPix, const ofShortPixels& depthPix, const ofFloatPixels& depthToWorldPix,
+		const std::vector<uint32_t>& bodyIDs, std::vector<BodyStats>& stats);
+}
@@ -0,0 +1,422 @@
+#include "DepthCodec.h"
+
+#include <cstring>
+
+#include "ofLog.h"
+
+#include "Parallel.h"
+
+namespace
+{
+	// Packs variable length values into 32-bit words, most significant nibble first.
+	// Each nibble holds 3 bits of the value and a continuation bit.
+	class NibbleWriter
+	{
+	public:
+		NibbleWriter(uint8_t* output)
+			: output(output)
+			, start(output)
+			, word(0)
+			, numNibbles(0)
+		{}
+
+		inline void writeVle(uint32_t value)
+		{
+			do
+			{
+				uint32_t nibble = value & 0x7;
+				value >>= 3;
+				if (value) nibble |= 0x8;
+
+				this->word = (this->word << 4) | nibble;
+				if (++this->numNibbles == 8)
+				{
+					std::memcpy(this->output, &this->word, sizeof(uint32_t));
+					this->output += sizeof(uint32_t);
+					this->word = 0;
+					this->numNibbles = 0;
+				}
+			} while (value);
+		}
+
+		size_t finish()
+		{
+			if (this->numNibbles > 0)
+			{
+				this->word <<= 4 * (8 - this->numNibbles);
+				std::memcpy(this->output, &this->word, sizeof(uint32_t));
+				this->output += sizeof(uint32_t);
+				this->word = 0;
+				this->numNibbles = 0;
+			}
+			return static_cast<size_t>(this->output - this->start);
+		}
+
+	private:
+		uint8_t* output;
+		uint8_t* start;
+		uint32_t word;
+		int numNibbles;
+	};
+
+	class NibbleReader
+	{
+	public:
+		NibbleReader(const uint8_t* input, size_t size)
+			: input(input)
+			, end(input + size)
+			, word(0)
+			, numNibbles(0)
+		{}
+
+		inline bool readVle(uint32_t& value)
+		{
+			value = 0;
+			int shift = 0;
+			uint32_t nibble;
+			do
+			{
+				if (this->numNibbles == 0)
+				{
+					if (this->end - this->input < static_cast<ptrdiff_t>(sizeof(uint32_t))) return false;
+
+					std::memcpy(&this->word, this->input, sizeof(uint32_t));
+					this->input += sizeof(uint32_t);
+					this->numNibbles = 8;
+				}
+
+				nibble = this->word >> 28;
+				this->word <<= 4;
+				--this->numNibbles;
+
+				value |= (nibble & 0x7) << shift;
+				shift += 3;
+			} while ((nibble & 0x8) && shift < 32);
+
+			// A value that doesn't end within 32 bits is corrupt.
+			return (nibble & 0x8) == 0;
+		}
+
+	private:
+		const uint8_t* input;
+		const uint8_t* end;
+		uint32_t word;
+		int numNibbles;
+	};
+
+	inline uint16_t zigzagResidual(uint16_t value, uint16_t reference)
+	{
+		const int16_t delta = static_cast<int16_t>(value - reference);
+		return static_cast<uint16_t>((static_cast<uint16_t>(delta) << 1) ^ static_cast<uint16_t>(delta >> 15));
+	}
+
+	inline uint16_t unzigzagResidual(uint16_t residual, uint16_t reference)
+	{
+		const uint16_t delta = static_cast<uint16_t>((residual >> 1) ^ (0 - (residual & 1)));
+		return static_cast<uint16_t>(reference + delta);
+	}
+}
+
+namespace ofxAzureKinect
+{
+	const char DepthCodec::MAGIC[4] = { 'R', 'V', 'L', 'D' };
+
+	DepthCodecSettings::DepthCodecSettings()
+		: numTiles(0)
+		, temporalDelta(false)
+		, keyframeInterval(30)
+	{}
+
+	size_t DepthCodec::getMaxRvlSize(size_t numPixels)
+	{
+		// Worst case is alternating zero and non-zero pixels with large jumps: two run length nibbles
+		// and six value nibbles per non-zero pixel. Plus the final run lengths and word padding.
+		return (numPixels * 4 + 16 + 3) & ~size_t(3);
+	}
+
+	size_t DepthCodec::compressRvl(const uint16_t* input, size_t numPixels, uint8_t* output)
+	{
+		NibbleWriter writer(output);
+
+		const uint16_t* end = input + numPixels;
+		int previous = 0;
+		while (input != end)
+		{
+			const uint16_t* runStart = input;
+			while (input != end && *input == 0) ++input;
+			writer.writeVle(static_cast<uint32_t>(input - runStart));
+
+			runStart = input;
+			while (input != end && *input != 0) ++input;
+			writer.writeVle(static_cast<uint32_t>(input - runStart));
+
+			for (const uint16_t* p = runStart; p != input; ++p)
+			{
+				const int current = *p;
+				const int delta = current - previous;
+				writer.writeVle((static_cast<uint32_t>(delta) << 1) ^ static_cast<uint32_t>(delta >> 31));
+				previous = current;
+			}
+		}
+
+		return writer.finish();
+	}
+
+	bool DepthCodec::decompressRvl(const uint8_t* input, size_t inputSize, uint16_t* output, size_t numPixels)
+	{
+		NibbleReader reader(input, inputSize);
+
+		uint16_t* end = output + numPixels;
+		uint32_t previous = 0;
+		while (output != end)
+		{
+			uint32_t numZeros, numNonZeros;
+			if (!reader.readVle(numZeros) || numZeros > static_cast<size_t>(end - output)) return false;
+
+			std::fill(output, output + numZeros, 0);
+			output += numZeros;
+
+			if (!reader.readVle(numNonZeros) || numNonZeros > static_cast<size_t>(end - output)) return false;
+
+			for (uint32_t i = 0; i < numNonZeros; ++i)
+			{
+				uint32_t positive;
+				if (!reader.readVle(positive)) return false;
+
+				// Unsigned so corrupt input wraps instead of overflowing.
+				previous += (positive >> 1) ^ (0u - (positive & 1));
+				*output++ = static_cast<uint16_t>(previous);
+			}
+		}
+
+		return true;
+	}
+
+	DepthCodec::DepthCodec()
+		: numFramesSinceKeyframe(0)
+	{}
+
+	DepthCodec::~DepthCodec()
+	{}
+
+	void DepthCodec::setup(const DepthCodecSettings& settings)
+	{
+		this->settings = settings;
+		this->reset();
+	}
+
+	void DepthCodec::reset()
+	{
+		this->encoderReference.clear();
+		this->decoderReference.clear();
+		this->numFramesSinceKeyframe = 0;
+	}
+
+	bool DepthCodec::encode(const ofShortPixels& depthPix, std::vector<uint8_t>& output)
+	{
+		if (!depthPix.isAllocated() || depthPix.getNumChannels() != 1)
+		{
+			ofLogError(__FUNCTION__) << "Expected single channel depth pixels!";
+			return false;
+		}
+
+		const int width = static_cast<int>(depthPix.getWidth());
+		const int height = static_cast<int>(depthPix.getHeight());
+		if (width > 0xFFFF || height > 0xFFFF)
+		{
+			ofLogError(__FUNCTION__) << "Frame " << width << "x" << height << " is too large!";
+			return false;
+		}
+
+		// Round the tile count so every tile has the same number of rows except the last.
+		const int requestedTiles = (this->settings.numTiles > 0) ? this->settings.numTiles : getNumParallelChunks(height, 32);
+		const int clampedTiles = std::max(1, std::min(requestedTiles, height));
+		const int rowsPerTile = (height + clampedTiles - 1) / clampedTiles;
+		const int numTiles = (height + rowsPerTile - 1) / rowsPerTile;
+
+		const bool bDelta = this->settings.temporalDelta &&
+			this->encoderReference.getWidth() == depthPix.getWidth() &&
+			this->encoderReference.getHeight() == depthPix.getHeight() &&
+			this->numFramesSinceKeyframe < this->settings.keyframeInterval;
+		if (bDelta)
+		{
+			this->residuals.resize(static_cast<size_t>(width) * height);
+		}
+
+		this->tileBuffers.resize(numTiles);
+		this->tileSizes.resize(numTiles);
+		const uint16_t* depthData = depthPix.getData();
+		const uint16_t* referenceData = this->encoderReference.getData();
+		parallelFor(0, numTiles, [&](int tileBegin, int tileEnd)
+		{
+			for (int t = tileBegin; t < tileEnd; ++t)
+			{
+				const size_t pixelBegin = static_cast<size_t>(t) * rowsPerTile * width;
+				const size_t pixelEnd = static_cast<size_t>(std::min(height, (t + 1) * rowsPerTile)) * width;
+
+				const uint16_t* tileData = depthData + pixelBegin;
+				if (bDelta)
+				{
+					uint16_t* residualData = this->residuals.data();
+					for (size_t i = pixelBegin; i < pixelEnd; ++i)
+					{
+						residualData[i] = zigzagResidual(depthData[i], referenceData[i]);
+					}
+					tileData = residualData + pixelBegin;
+				}
+
+				auto& buffer = this->tileBuffers[t];
+				buffer.resize(getMaxRvlSize(pixelEnd - pixelBegin));
+				this->tileSizes[t] = static_cast<uint32_t>(compressRvl(tileData, pixelEnd - pixelBegin, buffer.data()));
+			}
+		}, 1);
+
+		Header header;
+		std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+		header.width = static_cast<uint16_t>(width);
+		header.height = static_cast<uint16_t>(height);
+		header.rowsPerTile = static_cast<uint16_t>(rowsPerTile);
+		header.numTiles = static_cast<uint16_t>(numTiles);
+		header.flags = (bDelta ? FLAG_DELTA : 0) | (this->settings.temporalDelta ? FLAG_TEMPORAL : 0);
+
+		size_t totalSize = sizeof(Header) + numTiles * sizeof(uint32_t);
+		for (const auto tileSize : this->tileSizes)
+		{
+			totalSize += tileSize;
+		}
+
+		output.resize(totalSize);
+		uint8_t* dst = output.data();
+		std::memcpy(dst, &header, sizeof(Header));
+		dst += sizeof(Header);
+		std::memcpy(dst, this->tileSizes.data(), numTiles * sizeof(uint32_t));
+		dst += numTiles * sizeof(uint32_t);
+		for (int t = 0; t < numTiles; ++t)
+		{
+			std::memcpy(dst, this->tileBuffers[t].data(), this->tileSizes[t]);
+			dst += this->tileSizes[t];
+		}
+
+		if (this->settings.temporalDelta)
+		{
+			this->encoderReference = depthPix;
+			this->numFramesSinceKeyframe = bDelta ? this->numFramesSinceKeyframe + 1 : 1;
+		}
+
+		return true;
+	}
+
+	bool DepthCodec::decode(const uint8_t* data, size_t size, ofShortPixels& depthPix)
+	{
+		Header header;
+		if (size < sizeof(Header))
+		{
+			ofLogError(__FUNCTION__) << "Frame is truncated!";
+			return false;
+		}
+		std::memcpy(&header, data, sizeof(Header));
+
+		if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.width == 0 || header.height == 0 ||
+			header.rowsPerTile == 0 || header.numTiles == 0 || static_cast<size_t>(header.numTiles) * header.rowsPerTile < header.height ||
+			size < sizeof(Header) + header.numTiles * sizeof(uint32_t))
+		{
+			ofLogError(__FUNCTION__) << "Not a valid depth frame!";
+			return false;
+		}
+
+		// Sizes are kept in size_t, products of the 16 bit header fields overflow an int.
+		const size_t width = header.width;
+		const size_t height = header.height;
+		const size_t rowsPerTile = header.rowsPerTile;
+		const int numTiles = header.numTiles;
+		const bool bDelta = (header.flags & FLAG_DELTA) != 0;
+		const bool bTemporal = (header.flags & FLAG_TEMPORAL) != 0;
+
+		if (bDelta && (this->decoderReference.getWidth() != width || this->decoderReference.getHeight() != height))
+		{
+			ofLogError(__FUNCTION__) << "Delta frame without a keyframe, waiting for the next one!";
+			return false;
+		}
+
+		// Tile offsets, checked against the frame size before any decoding.
+		std::vector<size_t> tileOffsets(numTiles + 1);
+		const uint8_t* tileSizeData = data + sizeof(Header);
+		tileOffsets[0] = sizeof(Header) + numTiles * sizeof(uint32_t);
+		for (int t = 0; t < numTiles; ++t)
+		{
+			uint32_t tileSize;
+			std::memcpy(&tileSize, tileSizeData + t * sizeof(uint32_t), sizeof(uint32_t));
+			tileOffsets[t + 1] = tileOffsets[t] + tileSize;
+		}
+		if (tileOffsets[numTiles] > size)
+		{
+			ofLogError(__FUNCTION__) << "Frame is truncated!";
+			return false;
+		}
+
+		if (depthPix.getWidth() != width || depthPix.getHeight() != height || depthPix.getNumChannels() != 1)
+		{
+			depthPix.allocate(width, height, 1);
+		}
+		if (bTemporal && (this->decoderReference.getWidth() != width || this->decoderReference.getHeight() != height))
+		{
+			this->decoderReference.allocate(width, height, 1);
+		}
+
+		this->tileResults.assign(numTiles, 0);
+		uint16_t* depthData = depthPix.getData();
+		uint16_t* referenceData = this->decoderReference.getData();
+		parallelFor(0, numTiles, [&](int tileBegin, int tileEnd)
+		{
+			for (int t = tileBegin; t < tileEnd; ++t)
+			{
+				const size_t pixelBegin = std::min(static_cast<size_t>(t) * rowsPerTile, height) * width;
+				const size_t pixelEnd = std::min(static_cast<size_t>(t + 1) * rowsPerTile, height) * width;
+
+				if (!decompressRvl(data + tileOffsets[t], tileOffsets[t + 1] - tileOffsets[t], depthData + pixelBegin, pixelEnd - pixelBegin))
+				{
+					continue;
+				}
+
+				if (bDelta)
+				{
+					for (size_t i = pixelBegin; i < pixelEnd; ++i)
+					{
+						depthData[i] = unzigzagResidual(depthData[i], referenceData[i]);
+						referenceData[i] = depthData[i];
+					}
+				}
+				else if (bTemporal)
+				{
+					std::copy(depthData + pixelBegin, depthData + pixelEnd, referenceData + pixelBegin);
+				}
+
+				this->tileResults[t] = 1;
+			}
+		}, 1);
+
+		for (const auto result : this->tileResults)
+		{
+			if (!result)
+			{
+				// The reference is out of sync now, drop it until the next keyframe.
+				this->decoderReference.clear();
+
+				ofLogError(__FUNCTION__) << "Corrupt tile in depth frame!";
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool DepthCodec::decode(const std::vector<uint8_t>& data, ofShortPixels& depthPix)
+	{
+		return this->decode(data.data(), data.size(), depthPix);
+	}
+
+	const DepthCodecSettings& DepthCodec::getSettings() const
+	{
+		return this->settings;
+	}
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <vector>
+
+#include "ofPixels.h"
+
+namespace ofxAzureKinect
+{
+	struct DepthCodecSettings
+	{
+		// Horizontal bands of rows encoded and decoded independently on separate threads, 0 picks one per core.
+		int numTiles;
+
+		// Encode the change from the previous frame instead of the frame itself,
+		// with a full keyframe every keyframeInterval frames. Pays off for static cameras and scenes.
+		bool temporalDelta;
+		int keyframeInterval;
+
+		DepthCodecSettings();
+	};
+
+	// Lossless codec for 16-bit depth frames, like getDepthPix() and getDepthInColorPix().
+	//
+	// Rows are split into tiles, each compressed with RVL: runs of zero and non-zero pixels,
+	// non-zero pixels as zigzagged deltas from the previous one, all written as variable length
+	// 3-bit nibbles (Wilson, "Fast Lossless Depth Image Compression", 2017).
+	// An encoded frame is a DepthCodecHeader, numTiles uint32_t tile sizes and the tile payloads,
+	// stored in host byte order.
+	//
+	// Use separate instances to encode and decode, each keeps the reference frame for its side.
+	class DepthCodec
+	{
+	public:
+		enum Flags
+		{
+			// The frame holds zigzagged differences from the previous frame.
+			FLAG_DELTA = 1 << 0,
+
+			// The stream may contain delta frames, so the decoder keeps a reference.
+			FLAG_TEMPORAL = 1 << 1
+		};
+
+		struct Header
+		{
+			char magic[4];
+			uint16_t width;
+			uint16_t height;
+			uint16_t rowsPerTile;
+			uint16_t numTiles;
+			uint32_t flags;
+		};
+
+		static const char MAGIC[4];
+
+		// Upper bound for compressRvl() output.
+		static size_t getMaxRvlSize(size_t numPixels);
+
+		// Single-threaded RVL on a run of pixels. Output must hold getMaxRvlSize() bytes, returns the bytes written.
+		static size_t compressRvl(const uint16_t* input, size_t numPixels, uint8_t* output);
+
+		// Returns false if the input is truncated or doesn't decode to exactly numPixels pixels.
+		static bool decompressRvl(const uint8_t* input, size_t inputSize, uint16_t* output, size_t numPixels);
+
+	public:
+		DepthCodec();
+		~DepthCodec();
+
+		void setup(const DepthCodecSettings& settings);
+
+		// Forgets the reference frames, the next encoded frame is a keyframe.
+		void reset();
+
+		// Output is resized to the encoded size, reuse it between frames to avoid allocations.
+		bool encode(const ofShortPixels& depthPix, std::vector<uint8_t>& output);
+
+		// Pixels are reallocated if the frame size changes.
+		bool decode(const uint8_t* data, size_t size, ofShortPixels& depthPix);
+		bool decode(const std::vector<uint8_t>& data, ofShortPixels& depthPix);
+
+		const DepthCodecSettings& getSettings() const;
+
+	private:
+		DepthCodecSettings settings;
+
+		ofShortPixels encoderReference;
+		int numFramesSinceKeyframe;
+		std::vector<uint16_t> residuals;
+		std::vector<std::vector<uint8_t>> tileBuffers;
+		std::vector<uint32_t> tileSizes;
+
+		ofShortPixels decoderReference;
+		std::vector<char> tileResults;
+	};
+}
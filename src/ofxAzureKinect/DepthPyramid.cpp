@@ -0,0 +1,254 @@
+#include "DepthPyramid.h"
+
+#include "ofLog.h"
+
+#include "Parallel.h"
+
+namespace
+{
+	const uint16_t INVALID_MIN = 0xFFFF;
+	const uint16_t INVALID_MAX = 0;
+}
+
+namespace ofxAzureKinect
+{
+	DepthPyramid::DepthPyramid()
+	{}
+
+	DepthPyramid::~DepthPyramid()
+	{}
+
+	bool DepthPyramid::update(const ofShortPixels& depthPix)
+	{
+		if (!depthPix.isAllocated())
+		{
+			ofLogWarning(__FUNCTION__) << "Depth pixels not allocated!";
+			return false;
+		}
+
+		const auto frameDims = glm::ivec2(depthPix.getWidth(), depthPix.getHeight());
+		if (this->levels.empty() || this->levels[0].dims != frameDims)
+		{
+			// Allocate all levels, padded to even dims so reductions never need bounds checks.
+			// Padding stays invalid forever.
+			this->levels.clear();
+			auto dims = frameDims;
+			while (true)
+			{
+				Level level;
+				level.dims = dims;
+				level.stride = dims.x + (dims.x & 1);
+				const size_t numCells = level.stride * (dims.y + (dims.y & 1));
+				level.minData.assign(numCells, INVALID_MIN);
+				level.maxData.assign(numCells, INVALID_MAX);
+				level.countData.assign(numCells, 0);
+				this->levels.push_back(std::move(level));
+
+				if (dims.x == 1 && dims.y == 1) break;
+				dims = glm::ivec2((dims.x + 1) / 2, (dims.y + 1) / 2);
+			}
+
+			ofLogVerbose(__FUNCTION__) << "Allocated " << this->levels.size() << " levels for " << frameDims << ".";
+		}
+
+		// Level 0 is the frame itself, with invalid pixels remapped so min() skips them.
+		{
+			auto& base = this->levels[0];
+			const uint16_t* depthData = depthPix.getData();
+			parallelFor(0, frameDims.y, [&](int rowBegin, int rowEnd)
+			{
+				for (int y = rowBegin; y < rowEnd; ++y)
+				{
+					const uint16_t* src = depthData + y * frameDims.x;
+					uint16_t* minRow = base.minData.data() + y * base.stride;
+					uint16_t* maxRow = base.maxData.data() + y * base.stride;
+					uint32_t* countRow = base.countData.data() + y * base.stride;
+					for (int x = 0; x < frameDims.x; ++x)
+					{
+						const uint16_t d = src[x];
+						minRow[x] = d ? d : INVALID_MIN;
+						maxRow[x] = d;
+						countRow[x] = d ? 1 : 0;
+					}
+				}
+			}, 32, frameDims.x);
+		}
+
+		for (size_t l = 1; l < this->levels.size(); ++l)
+		{
+			const auto& src = this->levels[l - 1];
+			auto& dst = this->levels[l];
+			parallelFor(0, dst.dims.y, [&](int rowBegin, int rowEnd)
+			{
+				for (int y = rowBegin; y < rowEnd; ++y)
+				{
+					const int row0 = (2 * y) * src.stride;
+					const int row1 = row0 + src.stride;
+					uint16_t* minRow = dst.minData.data() + y * dst.stride;
+					uint16_t* maxRow = dst.maxData.data() + y * dst.stride;
+					uint32_t* countRow = dst.countData.data() + y * dst.stride;
+					for (int x = 0; x < dst.dims.x; ++x)
+					{
+						const int i0 = row0 + 2 * x;
+						const int i1 = row1 + 2 * x;
+						minRow[x] = std::min(std::min(src.minData[i0], src.minData[i0 + 1]), std::min(src.minData[i1], src.minData[i1 + 1]));
+						maxRow[x] = std::max(std::max(src.maxData[i0], src.maxData[i0 + 1]), std::max(src.maxData[i1], src.maxData[i1 + 1]));
+						countRow[x] = src.countData[i0] + src.countData[i0 + 1] + src.countData[i1] + src.countData[i1 + 1];
+					}
+				}
+			}, 32, dst.dims.x);
+		}
+
+		return true;
+	}
+
+	void DepthPyramid::clear()
+	{
+		this->levels.clear();
+	}
+
+	bool DepthPyramid::isAllocated() const
+	{
+		return !this->levels.empty();
+	}
+
+	size_t DepthPyramid::getNumLevels() const
+	{
+		return this->levels.size();
+	}
+
+	glm::ivec2 DepthPyramid::getLevelDims(size_t level) const
+	{
+		if (level >= this->levels.size()) return glm::ivec2(0);
+		return this->levels[level].dims;
+	}
+
+	bool DepthPyramid::clampRegion(const ofRectangle& region, glm::ivec2& regionMin, glm::ivec2& regionMax) const
+	{
+		if (this->levels.empty()) return false;
+
+		const auto& frameDims = this->levels[0].dims;
+		regionMin = glm::ivec2(
+			std::max(0, static_cast<int>(std::floor(region.getMinX()))),
+			std::max(0, static_cast<int>(std::floor(region.getMinY()))));
+		regionMax = glm::ivec2(
+			std::min(frameDims.x, static_cast<int>(std::ceil(region.getMaxX()))),
+			std::min(frameDims.y, static_cast<int>(std::ceil(region.getMaxY()))));
+
+		return regionMin.x < regionMax.x && regionMin.y < regionMax.y;
+	}
+
+	DepthRegionStats DepthPyramid::getRegionStats(const ofRectangle& region) const
+	{
+		DepthRegionStats stats;
+		stats.minDepth = INVALID_MIN;
+		stats.maxDepth = INVALID_MAX;
+		stats.numValid = 0;
+
+		glm::ivec2 regionMin, regionMax;
+		if (this->clampRegion(region, regionMin, regionMax))
+		{
+			this->accumulate(this->levels.size() - 1, 0, 0, regionMin, regionMax, stats);
+		}
+
+		if (stats.numValid == 0)
+		{
+			stats.minDepth = 0;
+		}
+
+		return stats;
+	}
+
+	uint16_t DepthPyramid::getMinDepth(const ofRectangle& region) const
+	{
+		return this->getRegionStats(region).minDepth;
+	}
+
+	uint16_t DepthPyramid::getMaxDepth(const ofRectangle& region) const
+	{
+		return this->getRegionStats(region).maxDepth;
+	}
+
+	size_t DepthPyramid::getNumValid(const ofRectangle& region) const
+	{
+		return this->getRegionStats(region).numValid;
+	}
+
+	bool DepthPyramid::isAnyCloserThan(const ofRectangle& region, uint16_t depth) const
+	{
+		glm::ivec2 regionMin, regionMax;
+		if (!this->clampRegion(region, regionMin, regionMax)) return false;
+
+		return this->findCloser(this->levels.size() - 1, 0, 0, regionMin, regionMax, depth);
+	}
+
+	void DepthPyramid::accumulate(size_t level, int cx, int cy, const glm::ivec2& regionMin, const glm::ivec2& regionMax, DepthRegionStats& stats) const
+	{
+		const auto& lvl = this->levels[level];
+		const int idx = cy * lvl.stride + cx;
+		if (lvl.countData[idx] == 0) return;
+
+		const auto& frameDims = this->levels[0].dims;
+		const auto cellMin = glm::ivec2(cx << level, cy << level);
+		const auto cellMax = glm::min(cellMin + glm::ivec2(1 << level), frameDims);
+		if (cellMax.x <= regionMin.x || cellMin.x >= regionMax.x ||
+			cellMax.y <= regionMin.y || cellMin.y >= regionMax.y)
+		{
+			// Disjoint.
+			return;
+		}
+
+		if (cellMin.x >= regionMin.x && cellMax.x <= regionMax.x &&
+			cellMin.y >= regionMin.y && cellMax.y <= regionMax.y)
+		{
+			// Fully inside, use the cell summary.
+			stats.minDepth = std::min(stats.minDepth, lvl.minData[idx]);
+			stats.maxDepth = std::max(stats.maxDepth, lvl.maxData[idx]);
+			stats.numValid += lvl.countData[idx];
+			return;
+		}
+
+		// Straddles the border, refine. Level 0 cells are single pixels and never get here.
+		const auto& child = this->levels[level - 1];
+		for (int y = 2 * cy; y < std::min(2 * cy + 2, child.dims.y); ++y)
+		{
+			for (int x = 2 * cx; x < std::min(2 * cx + 2, child.dims.x); ++x)
+			{
+				this->accumulate(level - 1, x, y, regionMin, regionMax, stats);
+			}
+		}
+	}
+
+	bool DepthPyramid::findCloser(size_t level, int cx, int cy, const glm::ivec2& regionMin, const glm::ivec2& regionMax, uint16_t depth) const
+	{
+		const auto& lvl = this->levels[level];
+		const int idx = cy * lvl.stride + cx;
+		if (lvl.countData[idx] == 0 || lvl.minData[idx] >= depth) return false;
+
+		const auto& frameDims = this->levels[0].dims;
+		const auto cellMin = glm::ivec2(cx << level, cy << level);
+		const auto cellMax = glm::min(cellMin + glm::ivec2(1 << level), frameDims);
+		if (cellMax.x <= regionMin.x || cellMin.x >= regionMax.x ||
+			cellMax.y <= regionMin.y || cellMin.y >= regionMax.y)
+		{
+			return false;
+		}
+
+		if (cellMin.x >= regionMin.x && cellMax.x <= regionMax.x &&
+			cellMin.y >= regionMin.y && cellMax.y <= regionMax.y)
+		{
+			return true;
+		}
+
+		const auto& child = this->levels[level - 1];
+		for (int y = 2 * cy; y < std::min(2 * cy + 2, child.dims.y); ++y)
+		{
+			for (int x = 2 * cx; x < std::min(2 * cx + 2, child.dims.x); ++x)
+			{
+				if (this->findCloser(level - 1, x, y, regionMin, regionMax, depth)) return true;
+			}
+		}
+
+		return false;
+	}
+}
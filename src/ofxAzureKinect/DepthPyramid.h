@@ -0,0 +1,60 @@
+#pragma once
+
+#include "ofPixels.h"
+#include "ofRectangle.h"
+#include "ofVectorMath.h"
+
+namespace ofxAzureKinect
+{
+	struct DepthRegionStats
+	{
+		uint16_t minDepth;
+		uint16_t maxDepth;
+		size_t numValid;
+	};
+
+	// Hierarchical min / max / valid count pyramid over a depth frame.
+	// Each level halves the resolution of the one below, level 0 is the frame itself.
+	// Region queries only descend into cells that straddle the region border, so the
+	// cost grows with the region perimeter and the number of levels instead of its area.
+	class DepthPyramid
+	{
+	public:
+		DepthPyramid();
+		~DepthPyramid();
+
+		bool update(const ofShortPixels& depthPix);
+		void clear();
+
+		bool isAllocated() const;
+		size_t getNumLevels() const;
+		glm::ivec2 getLevelDims(size_t level) const;
+
+		// Region is in depth pixels and is clamped to the frame.
+		DepthRegionStats getRegionStats(const ofRectangle& region) const;
+		uint16_t getMinDepth(const ofRectangle& region) const;
+		uint16_t getMaxDepth(const ofRectangle& region) const;
+		size_t getNumValid(const ofRectangle& region) const;
+
+		// Early-out query, returns as soon as any valid pixel closer than depth is found.
+		bool isAnyCloserThan(const ofRectangle& region, uint16_t depth) const;
+
+	private:
+		struct Level
+		{
+			glm::ivec2 dims;
+			int stride;
+			std::vector<uint16_t> minData;
+			std::vector<uint16_t> maxData;
+			std::vector<uint32_t> countData;
+		};
+
+		bool clampRegion(const ofRectangle& region, glm::ivec2& regionMin, glm::ivec2& regionMax) const;
+
+		void accumulate(size_t level, int cx, int cy, const glm::ivec2& regionMin, const glm::ivec2& regionMax, DepthRegionStats& stats) const;
+		bool findCloser(size_t level, int cx, int cy, const glm::ivec2& regionMin, const glm::ivec2& regionMax, uint16_t depth) const;
+
+	private:
+		std::vector<Level> levels;
+	};
+}
@@ -1,21 +1,12 @@
 #pragma once
 
-#include <k4a/k4a.hpp>
-#include <k4abt.h>
-#include <turbojpeg.h>
-
-#include "ofBufferObject.h"
-#include "ofEvents.h"
-#include "ofPixels.h"
-#include "ofTexture.h"
-#include "ofVboMesh.h"
-#include "ofVectorMath.h"
-
-#include "Types.h"
+#include "Recorder.h"
+#include "Stream.h"
 
 namespace ofxAzureKinect
 {
 	struct DeviceSettings
+		: StreamSettings
 	{
 		int deviceIndex;
 
@@ -23,20 +14,17 @@ namespace ofxAzureKinect
 		ColorResolution colorResolution;
 		ImageFormat colorFormat;
 		FramesPerSecond cameraFps;
-		SensorOrientation sensorOrientation;
-		
-		bool updateColor;
-		bool updateIr;
-		bool updateBodies;
-		bool updateWorld;
-		bool updateVbo;
 
 		bool synchronized;
 
+		// Read IMU samples along with every capture.
+		bool updateImu;
+
 		DeviceSettings(int idx = 0);
 	};
 
 	class Device
+		: public Stream
 	{
 	public:
 		static int getInstalledCount();
@@ -47,110 +35,37 @@ namespace ofxAzureKinect
 
 		bool open(int idx = 0);
 		bool open(DeviceSettings settings);
-		bool close();
+		bool close() override;
 
 		bool startCameras();
 		bool stopCameras();
 
-		bool isOpen() const;
-		bool isStreaming() const;
-
-		const ofShortPixels& getDepthPix() const;
-		const ofTexture& getDepthTex() const;
-
-		const ofPixels& getColorPix() const;
-		const ofTexture& getColorTex() const;
-
-		const ofShortPixels& getIrPix() const;
-		const ofTexture& getIrTex() const;
-
-		const ofFloatPixels& getDepthToWorldPix() const;
-		const ofTexture& getDepthToWorldTex() const;
-
-		const ofFloatPixels& getColorToWorldPix() const;
-		const ofTexture& getColorToWorldTex() const;
-
-		const ofShortPixels& getDepthInColorPix() const;
-		const ofTexture& getDepthInColorTex() const;
-
-		const ofPixels& getColorInDepthPix() const;
-		const ofTexture& getColorInDepthTex() const;
-
-		const ofPixels& getBodyIndexPix() const;
-		const ofTexture& getBodyIndexTex() const;
-
-		size_t getNumBodies() const;
-		const std::vector<k4abt_skeleton_t>& getBodySkeletons() const;
-		const std::vector<uint32_t>& getBodyIDs() const;
+		const std::string& getSerialNumber() const;
 
-		const ofVbo& getPointCloudVbo() const;
+		// Saves the factory calibration blob, e.g. to replay this device's calibration with SyntheticStream.
+		bool saveRawCalibration(const std::string& filePath) const;
 
-	private:
-		void updateCameras(ofEventArgs& args);
-
-		bool setupDepthToWorldTable();
-		bool setupColorToWorldTable();
-		bool setupImageToWorldTable(k4a_calibration_type_t type, k4a::image& img);
+		// Records captures, and optionally IMU samples and body frames, to an .mkv file on a separate thread.
+		bool startRecording(const std::string& filePath, RecorderSettings settings = RecorderSettings());
+		bool stopRecording();
+		bool isRecording() const;
 
-		bool updateWorldVbo(k4a::image& frameImg, k4a::image& tableImg);
+		const Recorder& getRecorder() const;
 
-		bool updateDepthInColorFrame(const k4a::image& depthImg, const k4a::image& colorImg);
-		bool updateColorInDepthFrame(const k4a::image& depthImg, const k4a::image& colorImg);
+	protected:
+		bool updateCapture() override;
+		void postUpdate() override;
 
 	private:
 		int index;
-		bool bOpen;
-		bool bStreaming;
-
-		bool bUpdateColor;
-		bool bUpdateIr;
-		bool bUpdateBodies;
-		bool bUpdateWorld;
-		bool bUpdateVbo;
 
 		std::string serialNumber;
 
-		k4a_device_configuration_t config;
-		k4a::calibration calibration;
-		k4a::transformation transformation;
 		k4a::device device;
-		k4a::capture capture;
-
-		k4abt_tracker_configuration_t trackerConfig;
-		k4abt_tracker_t bodyTracker;
-
-		tjhandle jpegDecompressor;
-
-		ofShortPixels depthPix;
-		ofTexture depthTex;
-
-		ofPixels colorPix;
-		ofTexture colorTex;
-
-		ofShortPixels irPix;
-		ofTexture irTex;
-
-		k4a::image depthToWorldImg;
-		ofFloatPixels depthToWorldPix;
-		ofTexture depthToWorldTex;
-
-		k4a::image colorToWorldImg;
-		ofFloatPixels colorToWorldPix;
-		ofTexture colorToWorldTex;
-
-		ofShortPixels depthInColorPix;
-		ofTexture depthInColorTex;
-
-		ofPixels colorInDepthPix;
-		ofTexture colorInDepthTex;
 
-		ofPixels bodyIndexPix;
-		ofTexture bodyIndexTex;
-		std::vector<k4abt_skeleton_t> bodySkeletons;
-		std::vector<uint32_t> bodyIDs;
+		bool bUpdateImu;
 
-		std::vector<glm::vec3> positionCache;
-		std::vector<glm::vec2> uvCache;
-		ofVbo pointCloudVbo;
+		Recorder recorder;
+		uint64_t recordedBodyTimestampUsec;
 	};
-}
\ No newline at end of file
+}
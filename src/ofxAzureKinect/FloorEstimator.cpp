@@ -0,0 +1,401 @@
+#include "FloorEstimator.h"
+
+#include "ofLog.h"
+
+#include "Stream.h"
+#include "Parallel.h"
+
+namespace
+{
+	// Cyclic Jacobi eigen decomposition of a symmetric 3x3 matrix.
+	// Returns the eigenvector of the smallest eigenvalue.
+	glm::vec3 getSmallestEigenvector(double a[3][3])
+	{
+		double v[3][3] = { { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } };
+
+		for (int sweep = 0; sweep < 32; ++sweep)
+		{
+			const double offDiag = a[0][1] * a[0][1] + a[0][2] * a[0][2] + a[1][2] * a[1][2];
+			if (offDiag < 1e-18) break;
+
+			for (int p = 0; p < 2; ++p)
+			{
+				for (int q = p + 1; q < 3; ++q)
+				{
+					if (std::abs(a[p][q]) < 1e-30) continue;
+
+					const double theta = (a[q][q] - a[p][p]) / (2.0 * a[p][q]);
+					const double t = ((theta >= 0.0) ? 1.0 : -1.0) / (std::abs(theta) + std::sqrt(theta * theta + 1.0));
+					const double c = 1.0 / std::sqrt(t * t + 1.0);
+					const double s = t * c;
+
+					for (int k = 0; k < 3; ++k)
+					{
+						const double akp = a[k][p];
+						const double akq = a[k][q];
+						a[k][p] = c * akp - s * akq;
+						a[k][q] = s * akp + c * akq;
+					}
+					for (int k = 0; k < 3; ++k)
+					{
+						const double apk = a[p][k];
+						const double aqk = a[q][k];
+						a[p][k] = c * apk - s * aqk;
+						a[q][k] = s * apk + c * aqk;
+					}
+					for (int k = 0; k < 3; ++k)
+					{
+						const double vkp = v[k][p];
+						const double vkq = v[k][q];
+						v[k][p] = c * vkp - s * vkq;
+						v[k][q] = s * vkp + c * vkq;
+					}
+				}
+			}
+		}
+
+		int smallest = 0;
+		for (int i = 1; i < 3; ++i)
+		{
+			if (a[i][i] < a[smallest][smallest])
+			{
+				smallest = i;
+			}
+		}
+
+		return glm::vec3(v[0][smallest], v[1][smallest], v[2][smallest]);
+	}
+}
+
+namespace ofxAzureKinect
+{
+	FloorSettings::FloorSettings()
+		: sampleStep(8)
+		, iterations(64)
+		, inlierThreshold(20.0f)
+		, minInlierRatio(0.1f)
+		, smoothing(0.2f)
+		, maxGravityAngle(15.0f)
+	{}
+
+	FloorEstimator::FloorEstimator()
+		: bHasGravity(false)
+		, up(0.0f, -1.0f, 0.0f)
+		, bValid(false)
+		, plane(0.0f)
+		, inlierRatio(0.0f)
+		, rng(std::random_device()())
+	{}
+
+	FloorEstimator::~FloorEstimator()
+	{}
+
+	void FloorEstimator::setup(const FloorSettings& settings)
+	{
+		this->settings = settings;
+	}
+
+	void FloorEstimator::reset()
+	{
+		this->bValid = false;
+		this->plane = glm::vec4(0.0f);
+		this->inlierRatio = 0.0f;
+	}
+
+	void FloorEstimator::setGravity(const glm::vec3& gravity)
+	{
+		if (glm::length(gravity) < 1e-6f) return;
+
+		this->up = -glm::normalize(gravity);
+		this->bHasGravity = true;
+	}
+
+	void FloorEstimator::setGravityFromImu(const k4a_imu_sample_t& sample, const k4a::calibration& calibration)
+	{
+		const k4a_calibration_extrinsics_t& accelToDepth = calibration.extrinsics[K4A_CALIBRATION_TYPE_ACCEL][K4A_CALIBRATION_TYPE_DEPTH];
+		const float* acc = sample.acc_sample.v;
+
+		// Rotation is row major.
+		glm::vec3 specificForce;
+		for (int i = 0; i < 3; ++i)
+		{
+			specificForce[i] = accelToDepth.rotation[i * 3 + 0] * acc[0] +
+				accelToDepth.rotation[i * 3 + 1] * acc[1] +
+				accelToDepth.rotation[i * 3 + 2] * acc[2];
+		}
+
+		this->setGravity(-specificForce);
+	}
+
+	void FloorEstimator::clearGravity()
+	{
+		this->bHasGravity = false;
+	}
+
+	bool FloorEstimator::update(const Stream& stream)
+	{
+		return this->update(stream.getDepthPix(), stream.getDepthToWorldPix());
+	}
+
+	bool FloorEstimator::update(const ofShortPixels& depthPix, const ofFloatPixels& depthToWorldPix)
+	{
+		if (!depthPix.isAllocated() || !depthToWorldPix.isAllocated() ||
+			depthPix.getWidth() != depthToWorldPix.getWidth() ||
+			depthPix.getHeight() != depthToWorldPix.getHeight())
+		{
+			ofLogWarning(__FUNCTION__) << "Depth and LUT pixels missing or mismatched!";
+			return false;
+		}
+
+		this->samplePoints(depthPix, depthToWorldPix);
+		const size_t numPoints = this->xs.size();
+		if (numPoints < 3)
+		{
+			return false;
+		}
+
+		// Build hypotheses up front so scoring can run in parallel.
+		std::vector<glm::vec4> hypotheses;
+		hypotheses.reserve(this->settings.iterations + 1);
+		if (this->bValid)
+		{
+			// Keep competing with the current estimate so it only changes for a better plane.
+			hypotheses.push_back(this->plane);
+		}
+
+		std::uniform_int_distribution<size_t> pick(0, numPoints - 1);
+		const int maxAttempts = this->settings.iterations * 4;
+		for (int attempt = 0; attempt < maxAttempts && static_cast<int>(hypotheses.size()) < this->settings.iterations; ++attempt)
+		{
+			const size_t i0 = pick(this->rng);
+			const size_t i1 = pick(this->rng);
+			const size_t i2 = pick(this->rng);
+			const auto p0 = glm::vec3(this->xs[i0], this->ys[i0], this->zs[i0]);
+			const auto p1 = glm::vec3(this->xs[i1], this->ys[i1], this->zs[i1]);
+			const auto p2 = glm::vec3(this->xs[i2], this->ys[i2], this->zs[i2]);
+
+			const auto normal = glm::cross(p1 - p0, p2 - p0);
+			const float normalLength = glm::length(normal);
+			if (normalLength < 1e-3f) continue;
+
+			auto candidate = glm::vec4(normal / normalLength, 0.0f);
+			candidate.w = -glm::dot(glm::vec3(candidate.x, candidate.y, candidate.z), p0);
+			if (this->orientPlane(candidate))
+			{
+				hypotheses.push_back(candidate);
+			}
+		}
+
+		if (hypotheses.empty())
+		{
+			return false;
+		}
+
+		std::vector<size_t> scores(hypotheses.size(), 0);
+		parallelFor(0, static_cast<int>(hypotheses.size()), [&](int begin, int end)
+		{
+			for (int h = begin; h < end; ++h)
+			{
+				scores[h] = this->countInliers(hypotheses[h]);
+			}
+		}, 4);
+
+		const size_t best = std::max_element(scores.begin(), scores.end()) - scores.begin();
+		auto bestPlane = hypotheses[best];
+		if (!this->refinePlane(bestPlane))
+		{
+			return false;
+		}
+
+		const float ratio = static_cast<float>(this->countInliers(bestPlane)) / numPoints;
+		if (ratio < this->settings.minInlierRatio)
+		{
+			ofLogVerbose(__FUNCTION__) << "Best plane only has " << ratio << " inliers, keeping previous estimate.";
+			return false;
+		}
+
+		if (this->bValid)
+		{
+			// Blend towards the new estimate to keep the transform stable frame to frame.
+			const float weight = this->settings.smoothing;
+			const auto normal = glm::normalize(glm::mix(glm::vec3(this->plane.x, this->plane.y, this->plane.z), glm::vec3(bestPlane.x, bestPlane.y, bestPlane.z), weight));
+			this->plane = glm::vec4(normal, glm::mix(this->plane.w, bestPlane.w, weight));
+		}
+		else
+		{
+			this->plane = bestPlane;
+		}
+
+		this->inlierRatio = ratio;
+		this->bValid = true;
+
+		return true;
+	}
+
+	void FloorEstimator::samplePoints(const ofShortPixels& depthPix, const ofFloatPixels& depthToWorldPix)
+	{
+		const int width = static_cast<int>(depthPix.getWidth());
+		const int height = static_cast<int>(depthPix.getHeight());
+		const int step = std::max(1, this->settings.sampleStep);
+		const uint16_t* depthData = depthPix.getData();
+		const auto tableData = reinterpret_cast<const glm::vec2*>(depthToWorldPix.getData());
+
+		this->xs.clear();
+		this->ys.clear();
+		this->zs.clear();
+
+		// Offset rows every frame so successive updates see different samples.
+		const int offset = std::uniform_int_distribution<int>(0, step - 1)(this->rng);
+		for (int y = offset; y < height; y += step)
+		{
+			for (int x = offset; x < width; x += step)
+			{
+				const int idx = y * width + x;
+				const uint16_t d = depthData[idx];
+				const auto& lut = tableData[idx];
+				if (d == 0 || (lut.x == 0 && lut.y == 0)) continue;
+
+				const float depthVal = static_cast<float>(d);
+				this->xs.push_back(lut.x * depthVal);
+				this->ys.push_back(lut.y * depthVal);
+				this->zs.push_back(depthVal);
+			}
+		}
+	}
+
+	size_t FloorEstimator::countInliers(const glm::vec4& candidate) const
+	{
+		const float nx = candidate.x;
+		const float ny = candidate.y;
+		const float nz = candidate.z;
+		const float d = candidate.w;
+		const float threshold = this->settings.inlierThreshold;
+		const float* xData = this->xs.data();
+		const float* yData = this->ys.data();
+		const float* zData = this->zs.data();
+		const int numPoints = static_cast<int>(this->xs.size());
+
+		// SoA and branch-free so the compiler vectorizes it.
+		int count = 0;
+		for (int i = 0; i < numPoints; ++i)
+		{
+			const float dist = nx * xData[i] + ny * yData[i] + nz * zData[i] + d;
+			count += (std::abs(dist) < threshold) ? 1 : 0;
+		}
+		return count;
+	}
+
+	bool FloorEstimator::refinePlane(glm::vec4& candidate) const
+	{
+		const float threshold = this->settings.inlierThreshold;
+
+		glm::dvec3 sum(0.0);
+		double sumXX = 0, sumXY = 0, sumXZ = 0, sumYY = 0, sumYZ = 0, sumZZ = 0;
+		size_t count = 0;
+		for (size_t i = 0; i < this->xs.size(); ++i)
+		{
+			const float dist = candidate.x * this->xs[i] + candidate.y * this->ys[i] + candidate.z * this->zs[i] + candidate.w;
+			if (std::abs(dist) >= threshold) continue;
+
+			const double x = this->xs[i];
+			const double y = this->ys[i];
+			const double z = this->zs[i];
+			sum += glm::dvec3(x, y, z);
+			sumXX += x * x;
+			sumXY += x * y;
+			sumXZ += x * z;
+			sumYY += y * y;
+			sumYZ += y * z;
+			sumZZ += z * z;
+			++count;
+		}
+
+		if (count < 3) return false;
+
+		// The plane normal is the direction of least variance of the inliers.
+		const auto mean = sum / static_cast<double>(count);
+		double cov[3][3];
+		cov[0][0] = sumXX / count - mean.x * mean.x;
+		cov[0][1] = cov[1][0] = sumXY / count - mean.x * mean.y;
+		cov[0][2] = cov[2][0] = sumXZ / count - mean.x * mean.z;
+		cov[1][1] = sumYY / count - mean.y * mean.y;
+		cov[1][2] = cov[2][1] = sumYZ / count - mean.y * mean.z;
+		cov[2][2] = sumZZ / count - mean.z * mean.z;
+
+		const auto normal = glm::normalize(getSmallestEigenvector(cov));
+		auto refined = glm::vec4(normal, -glm::dot(normal, glm::vec3(mean)));
+		if (!this->orientPlane(refined))
+		{
+			return false;
+		}
+
+		candidate = refined;
+		return true;
+	}
+
+	bool FloorEstimator::orientPlane(glm::vec4& candidate) const
+	{
+		// Make the normal face the camera, which sits at the origin.
+		if (candidate.w < 0.0f)
+		{
+			candidate = -candidate;
+		}
+
+		if (this->bHasGravity)
+		{
+			const float cosAngle = glm::dot(glm::vec3(candidate.x, candidate.y, candidate.z), this->up);
+			if (cosAngle < std::cos(glm::radians(this->settings.maxGravityAngle)))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool FloorEstimator::isValid() const
+	{
+		return this->bValid;
+	}
+
+	const glm::vec4& FloorEstimator::getPlane() const
+	{
+		return this->plane;
+	}
+
+	float FloorEstimator::getCameraHeight() const
+	{
+		return this->plane.w;
+	}
+
+	float FloorEstimator::getInlierRatio() const
+	{
+		return this->inlierRatio;
+	}
+
+	glm::mat4 FloorEstimator::getCameraToFloor() const
+	{
+		if (!this->bValid) return glm::mat4(1.0f);
+
+		const auto axisY = glm::vec3(this->plane.x, this->plane.y, this->plane.z);
+
+		// Forward is the camera z axis projected on the floor, unless the camera looks straight down.
+		auto forward = glm::vec3(0.0f, 0.0f, 1.0f);
+		if (std::abs(glm::dot(forward, axisY)) > 0.99f)
+		{
+			forward = glm::vec3(0.0f, -1.0f, 0.0f);
+		}
+		const auto axisZ = glm::normalize(forward - axisY * glm::dot(forward, axisY));
+		const auto axisX = glm::cross(axisY, axisZ);
+
+		// Floor point right under the camera.
+		const auto origin = -axisY * this->plane.w;
+
+		glm::mat4 cameraToFloor(1.0f);
+		cameraToFloor[0] = glm::vec4(axisX.x, axisY.x, axisZ.x, 0.0f);
+		cameraToFloor[1] = glm::vec4(axisX.y, axisY.y, axisZ.y, 0.0f);
+		cameraToFloor[2] = glm::vec4(axisX.z, axisY.z, axisZ.z, 0.0f);
+		cameraToFloor[3] = glm::vec4(-glm::dot(axisX, origin), -glm::dot(axisY, origin), -glm::dot(axisZ, origin), 1.0f);
+		return cameraToFloor;
+	}
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <random>
+
+#include <k4a/k4a.hpp>
+
+#include "ofPixels.h"
+#include "ofVectorMath.h"
+
+namespace ofxAzureKinect
+{
+	class Stream;
+
+	struct FloorSettings
+	{
+		// Pixel stride used to subsample the depth frame.
+		int sampleStep;
+
+		// RANSAC hypotheses tested per update.
+		int iterations;
+
+		// Max point to plane distance for inliers, in mm.
+		float inlierThreshold;
+
+		// Minimum fraction of sampled points on the plane for an estimate to be accepted.
+		float minInlierRatio;
+
+		// Weight of each new estimate against the previous one, 1 disables smoothing.
+		float smoothing;
+
+		// Max angle between the plane normal and the gravity hint, in degrees.
+		float maxGravityAngle;
+
+		FloorSettings();
+	};
+
+	// Estimates the floor, or dominant plane, from a subsampled depth point cloud.
+	// Each update runs a few RANSAC iterations seeded with the current estimate, refines the
+	// winner with a least squares fit over its inliers, and blends it into the running estimate.
+	class FloorEstimator
+	{
+	public:
+		FloorEstimator();
+		~FloorEstimator();
+
+		void setup(const FloorSettings& settings);
+		void reset();
+
+		// Direction pointing down in depth camera space, any length.
+		// Restricts candidate planes to those roughly perpendicular to it.
+		void setGravity(const glm::vec3& gravity);
+		// Same from an accelerometer sample at rest, rotated into depth camera space. The
+		// accelerometer measures the force holding the device up, so its sign is flipped.
+		void setGravityFromImu(const k4a_imu_sample_t& sample, const k4a::calibration& calibration);
+		void clearGravity();
+
+		bool update(const Stream& stream);
+		bool update(const ofShortPixels& depthPix, const ofFloatPixels& depthToWorldPix);
+
+		bool isValid() const;
+
+		// Plane as (normal, distance) in depth camera space, the normal points towards the camera.
+		const glm::vec4& getPlane() const;
+		float getCameraHeight() const;
+		float getInlierRatio() const;
+
+		// Floor space is y-up with the floor at y = 0 under the camera, z points forward.
+		glm::mat4 getCameraToFloor() const;
+
+	private:
+		void samplePoints(const ofShortPixels& depthPix, const ofFloatPixels& depthToWorldPix);
+		size_t countInliers(const glm::vec4& plane) const;
+		bool refinePlane(glm::vec4& plane) const;
+		bool orientPlane(glm::vec4& plane) const;
+
+	private:
+		FloorSettings settings;
+
+		std::vector<float> xs;
+		std::vector<float> ys;
+		std::vector<float> zs;
+
+		bool bHasGravity;
+		glm::vec3 up;
+
+		bool bValid;
+		glm::vec4 plane;
+		float inlierRatio;
+
+		std::mt19937 rng;
+	};
+}
@@ -0,0 +1,210 @@
+#include "FrameTiming.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+
+#include "ofLog.h"
+
+namespace ofxAzureKinect
+{
+	FrameTimingSettings::FrameTimingSettings()
+		: lateThresholdUsec(0)
+		, maxSkewUsec(0)
+	{}
+
+	FrameTimingStats::FrameTimingStats()
+		: numLateFrames(0)
+		, numSkewedFrames(0)
+		, lastSkewUsec(0)
+	{
+		this->numFrames.fill(0);
+		this->numDropped.fill(0);
+	}
+
+	FrameTiming::FrameTiming()
+		: frameDurationUsec(33333)
+		, depthDelayUsec(0)
+		, numLateFrames(0)
+		, numSkewedFrames(0)
+		, lastSkewUsec(0)
+		, captureHostTimeUsec(0)
+	{
+		this->lastTimestampUsec.fill(0);
+		for (size_t i = 0; i < NUM_FRAME_STREAMS; ++i)
+		{
+			this->numFrames[i] = 0;
+			this->numDropped[i] = 0;
+		}
+	}
+
+	void FrameTiming::setup(const FrameTimingSettings& settings, size_t windowSize)
+	{
+		this->settings = settings;
+
+		for (auto& histogram : this->latencyHistograms)
+		{
+			histogram.setup(windowSize);
+		}
+	}
+
+	void FrameTiming::start(const k4a_device_configuration_t& config)
+	{
+		this->frameDurationUsec = getFrameDurationUsec(config.camera_fps);
+		this->depthDelayUsec = config.depth_delay_off_color_usec;
+
+		this->lastTimestampUsec.fill(0);
+		for (size_t i = 0; i < NUM_FRAME_STREAMS; ++i)
+		{
+			this->numFrames[i] = 0;
+			this->numDropped[i] = 0;
+		}
+		this->numLateFrames = 0;
+		this->numSkewedFrames = 0;
+		this->lastSkewUsec = 0;
+		this->captureHostTimeUsec = 0;
+
+		for (auto& histogram : this->latencyHistograms)
+		{
+			histogram.setup(histogram.getWindowSize());
+		}
+	}
+
+	void FrameTiming::addCapture(const k4a::capture& capture)
+	{
+		const auto depthImg = capture.get_depth_image();
+		const auto colorImg = capture.get_color_image();
+		const auto irImg = capture.get_ir_image();
+
+		this->addImage(FRAME_STREAM_DEPTH, depthImg);
+		this->addImage(FRAME_STREAM_COLOR, colorImg);
+		this->addImage(FRAME_STREAM_IR, irImg);
+
+		// Age of the capture, from the first image the host received.
+		this->captureHostTimeUsec = 0;
+		for (const auto* img : { &depthImg, &colorImg, &irImg })
+		{
+			if (!*img) continue;
+
+			const uint64_t hostTimeUsec = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(img->get_system_timestamp()).count());
+			if (hostTimeUsec > 0 && (this->captureHostTimeUsec == 0 || hostTimeUsec < this->captureHostTimeUsec))
+			{
+				this->captureHostTimeUsec = hostTimeUsec;
+			}
+		}
+
+		if (this->captureHostTimeUsec > 0)
+		{
+			const uint64_t nowUsec = getHostTimeUsec();
+			const uint64_t latencyUsec = (nowUsec > this->captureHostTimeUsec) ? (nowUsec - this->captureHostTimeUsec) : 0;
+			const uint64_t lateThresholdUsec = (this->settings.lateThresholdUsec > 0) ? this->settings.lateThresholdUsec : this->frameDurationUsec * 2;
+			if (latencyUsec > lateThresholdUsec)
+			{
+				++this->numLateFrames;
+
+				LateFrameEventArgs args;
+				args.latencyUsec = latencyUsec;
+				args.depthTimestampUsec = depthImg ? static_cast<uint64_t>(depthImg.get_device_timestamp().count()) : 0;
+				ofNotifyEvent(this->frameLate, args, this);
+			}
+		}
+
+		if (depthImg && colorImg)
+		{
+			const int64_t depthTimestampUsec = static_cast<int64_t>(depthImg.get_device_timestamp().count());
+			const int64_t colorTimestampUsec = static_cast<int64_t>(colorImg.get_device_timestamp().count());
+			const int64_t skewUsec = depthTimestampUsec - colorTimestampUsec - this->depthDelayUsec;
+			this->lastSkewUsec = skewUsec;
+
+			const uint64_t maxSkewUsec = (this->settings.maxSkewUsec > 0) ? this->settings.maxSkewUsec : this->frameDurationUsec / 2;
+			if (static_cast<uint64_t>(std::llabs(skewUsec)) > maxSkewUsec)
+			{
+				++this->numSkewedFrames;
+
+				FrameSkewEventArgs args;
+				args.skewUsec = skewUsec;
+				args.depthTimestampUsec = static_cast<uint64_t>(depthTimestampUsec);
+				args.colorTimestampUsec = static_cast<uint64_t>(colorTimestampUsec);
+				ofNotifyEvent(this->frameSkewed, args, this);
+			}
+		}
+
+		this->markStage(PIPELINE_STAGE_CAPTURE);
+	}
+
+	void FrameTiming::markDiscontinuity()
+	{
+		this->lastTimestampUsec.fill(0);
+		this->lastSkewUsec = 0;
+		this->captureHostTimeUsec = 0;
+	}
+
+	void FrameTiming::markStage(PipelineStage stage)
+	{
+		if (this->captureHostTimeUsec == 0) return;
+
+		const uint64_t nowUsec = getHostTimeUsec();
+		const uint64_t latencyUsec = (nowUsec > this->captureHostTimeUsec) ? (nowUsec - this->captureHostTimeUsec) : 0;
+		this->latencyHistograms[stage].add(static_cast<uint32_t>(std::min<uint64_t>(latencyUsec, UINT32_MAX)));
+	}
+
+	FrameTimingStats FrameTiming::getStats() const
+	{
+		FrameTimingStats stats;
+		for (size_t i = 0; i < NUM_FRAME_STREAMS; ++i)
+		{
+			stats.numFrames[i] = this->numFrames[i].load(std::memory_order_relaxed);
+			stats.numDropped[i] = this->numDropped[i].load(std::memory_order_relaxed);
+		}
+		stats.numLateFrames = this->numLateFrames.load(std::memory_order_relaxed);
+		stats.numSkewedFrames = this->numSkewedFrames.load(std::memory_order_relaxed);
+		stats.lastSkewUsec = this->lastSkewUsec.load(std::memory_order_relaxed);
+		for (size_t i = 0; i < NUM_PIPELINE_STAGES; ++i)
+		{
+			stats.latency[i] = this->latencyHistograms[i].getStats();
+		}
+		return stats;
+	}
+
+	const FrameTimingSettings& FrameTiming::getSettings() const
+	{
+		return this->settings;
+	}
+
+	void FrameTiming::addImage(FrameStream stream, const k4a::image& img)
+	{
+		if (!img) return;
+
+		++this->numFrames[stream];
+
+		const uint64_t timestampUsec = static_cast<uint64_t>(img.get_device_timestamp().count());
+		const uint64_t previousTimestampUsec = this->lastTimestampUsec[stream];
+		this->lastTimestampUsec[stream] = timestampUsec;
+
+		// Nothing to compare the first frame to, and timestamps jump back when a playback loops or seeks.
+		if (previousTimestampUsec == 0 || timestampUsec <= previousTimestampUsec) return;
+
+		// Round to whole frames, device timestamps jitter by a few microseconds.
+		const uint64_t gapUsec = timestampUsec - previousTimestampUsec;
+		const uint64_t numFrameDurations = (gapUsec + this->frameDurationUsec / 2) / this->frameDurationUsec;
+		if (numFrameDurations > 1)
+		{
+			const uint64_t numDropped = numFrameDurations - 1;
+			this->numDropped[stream] += numDropped;
+
+			ofLogVerbose(__FUNCTION__) << "Dropped " << numDropped << " frames before " << timestampUsec << "us on stream " << stream << ".";
+
+			FrameDropEventArgs args;
+			args.stream = stream;
+			args.numDropped = numDropped;
+			args.previousTimestampUsec = previousTimestampUsec;
+			args.timestampUsec = timestampUsec;
+			ofNotifyEvent(this->frameDropped, args, this);
+		}
+	}
+
+	uint64_t FrameTiming::getHostTimeUsec()
+	{
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+	}
+}
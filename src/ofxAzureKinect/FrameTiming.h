@@ -0,0 +1,131 @@
+#pragma once
+
+#include <atomic>
+
+#include <k4a/k4a.hpp>
+
+#include "ofEvents.h"
+
+#include "PipelineStats.h"
+#include "Types.h"
+
+namespace ofxAzureKinect
+{
+	enum FrameStream
+	{
+		FRAME_STREAM_DEPTH,
+		FRAME_STREAM_COLOR,
+		FRAME_STREAM_IR,
+		NUM_FRAME_STREAMS
+	};
+
+	struct FrameTimingSettings
+	{
+		// A capture is late when it reaches the pipeline this long after the host received it, 0 uses two frame durations.
+		uint64_t lateThresholdUsec;
+
+		// Depth and color captured further apart than this are skewed, 0 uses half a frame.
+		// Measured after removing the configured depth_delay_off_color_usec.
+		uint64_t maxSkewUsec;
+
+		FrameTimingSettings();
+	};
+
+	struct FrameDropEventArgs
+	{
+		FrameStream stream;
+		uint64_t numDropped;
+
+		// Device timestamps of the frames on both sides of the gap.
+		uint64_t previousTimestampUsec;
+		uint64_t timestampUsec;
+	};
+
+	struct LateFrameEventArgs
+	{
+		// Host time from receiving the capture to handing it to the pipeline.
+		uint64_t latencyUsec;
+		uint64_t depthTimestampUsec;
+	};
+
+	struct FrameSkewEventArgs
+	{
+		// Depth minus color device timestamp, minus the configured delay.
+		int64_t skewUsec;
+		uint64_t depthTimestampUsec;
+		uint64_t colorTimestampUsec;
+	};
+
+	struct FrameTimingStats
+	{
+		// Counted per image stream since the stream started.
+		std::array<uint64_t, NUM_FRAME_STREAMS> numFrames;
+		std::array<uint64_t, NUM_FRAME_STREAMS> numDropped;
+
+		uint64_t numLateFrames;
+		uint64_t numSkewedFrames;
+		int64_t lastSkewUsec;
+
+		// Host time from receiving the capture to the end of each stage, over the stats window.
+		// Only measured on live devices, captures from files and synthetic streams have no host timestamp.
+		std::array<StageStats, NUM_PIPELINE_STAGES> latency;
+
+		FrameTimingStats();
+	};
+
+	// Follows the device and host timestamps of the captures going through a stream,
+	// to count dropped, late and out of sync frames and measure how old frames are at each stage.
+	class FrameTiming
+	{
+	public:
+		FrameTiming();
+
+		void setup(const FrameTimingSettings& settings, size_t windowSize);
+
+		// Clears the counters, and takes the frame rate and depth delay from the config.
+		void start(const k4a_device_configuration_t& config);
+
+		// Checks the timestamps of the images in a new capture.
+		void addCapture(const k4a::capture& capture);
+
+		// Forgets the previous capture, for when timestamps jump on a seek or loop.
+		// The gap to the next capture isn't counted as dropped frames, counters are kept.
+		void markDiscontinuity();
+
+		// Adds the latency of the current capture at the end of a stage.
+		void markStage(PipelineStage stage);
+
+		// Safe to call from any thread.
+		FrameTimingStats getStats() const;
+
+		const FrameTimingSettings& getSettings() const;
+
+		// Notified on the update thread.
+		ofEvent<FrameDropEventArgs> frameDropped;
+		ofEvent<LateFrameEventArgs> frameLate;
+		ofEvent<FrameSkewEventArgs> frameSkewed;
+
+	private:
+		void addImage(FrameStream stream, const k4a::image& img);
+
+		// Host clock the SDK stamps images with, std::chrono::steady_clock on every supported platform.
+		static uint64_t getHostTimeUsec();
+
+	private:
+		FrameTimingSettings settings;
+
+		uint64_t frameDurationUsec;
+		int64_t depthDelayUsec;
+
+		std::array<uint64_t, NUM_FRAME_STREAMS> lastTimestampUsec;
+		std::array<std::atomic<uint64_t>, NUM_FRAME_STREAMS> numFrames;
+		std::array<std::atomic<uint64_t>, NUM_FRAME_STREAMS> numDropped;
+		std::atomic<uint64_t> numLateFrames;
+		std::atomic<uint64_t> numSkewedFrames;
+		std::atomic<int64_t> lastSkewUsec;
+
+		// Host timestamp of the current capture, 0 if it has none.
+		uint64_t captureHostTimeUsec;
+		std::array<LatencyHistogram, NUM_PIPELINE_STAGES> latencyHistograms;
+	};
+}
@@ -0,0 +1,175 @@
+#include "HeightMap.h"
+
+#include "ofLog.h"
+
+#include "Stream.h"
+#include "Parallel.h"
+
+namespace ofxAzureKinect
+{
+	HeightMapSettings::HeightMapSettings()
+		: cameraToFloor(1.0f)
+		, minBounds(-2500.0f, 0.0f)
+		, maxBounds(2500.0f, 5000.0f)
+		, cellSize(20.0f)
+		, minHeight(50.0f)
+		, maxHeight(2500.0f)
+		, updateTexture(true)
+	{}
+
+	HeightMap::HeightMap()
+		: gridDims(0)
+	{}
+
+	HeightMap::~HeightMap()
+	{}
+
+	void HeightMap::setup(const HeightMapSettings& settings)
+	{
+		this->settings = settings;
+
+		const auto extents = this->settings.maxBounds - this->settings.minBounds;
+		this->gridDims = glm::ivec2(
+			std::max(1, static_cast<int>(std::ceil(extents.x / this->settings.cellSize))),
+			std::max(1, static_cast<int>(std::ceil(extents.y / this->settings.cellSize))));
+
+		this->gridPix.allocate(this->gridDims.x, this->gridDims.y, 2);
+		this->gridPix.set(0);
+		if (this->settings.updateTexture)
+		{
+			this->gridTex.allocate(this->gridDims.x, this->gridDims.y, GL_RG32F);
+			this->gridTex.setTextureMinMagFilter(GL_NEAREST, GL_NEAREST);
+		}
+		else
+		{
+			this->gridTex.clear();
+		}
+
+		this->chunkGrids.clear();
+	}
+
+	void HeightMap::setCameraToFloor(const glm::mat4& cameraToFloor)
+	{
+		this->settings.cameraToFloor = cameraToFloor;
+	}
+
+	bool HeightMap::update(const Stream& stream)
+	{
+		return this->update(stream.getDepthPix(), stream.getDepthToWorldPix());
+	}
+
+	bool HeightMap::update(const ofShortPixels& depthPix, const ofFloatPixels& depthToWorldPix)
+	{
+		if (!this->gridPix.isAllocated())
+		{
+			this->setup(this->settings);
+		}
+
+		if (!depthPix.isAllocated() || !depthToWorldPix.isAllocated() ||
+			depthPix.getWidth() != depthToWorldPix.getWidth() ||
+			depthPix.getHeight() != depthToWorldPix.getHeight())
+		{
+			ofLogWarning(__FUNCTION__) << "Depth and LUT pixels missing or mismatched!";
+			return false;
+		}
+
+		const int width = static_cast<int>(depthPix.getWidth());
+		const int height = static_cast<int>(depthPix.getHeight());
+		const uint16_t* depthData = depthPix.getData();
+		const auto tableData = reinterpret_cast<const glm::vec2*>(depthToWorldPix.getData());
+
+		const auto rotation = glm::mat3(this->settings.cameraToFloor);
+		const auto translation = glm::vec3(this->settings.cameraToFloor[3]);
+		const auto minBounds = this->settings.minBounds;
+		const float invCellSize = 1.0f / this->settings.cellSize;
+		const float minHeight = this->settings.minHeight;
+		const float maxHeight = this->settings.maxHeight;
+		const auto gridDims = this->gridDims;
+		const size_t numCells = gridDims.x * gridDims.y;
+
+		// Each chunk writes its own grid (max height, count), merged below.
+		// The grids are kept between frames and only the cells touched last time are cleared,
+		// a frame usually covers a small part of the grid.
+		const int numChunks = getNumParallelChunks(height, 32, width);
+		this->chunkGrids.resize(numChunks);
+		parallelForChunks(0, height, numChunks, [&](int chunk, int rowBegin, int rowEnd)
+		{
+			auto& grid = this->chunkGrids[chunk];
+			if (grid.cells.size() != numCells)
+			{
+				grid.cells.assign(numCells, glm::vec2(0.0f));
+			}
+			else
+			{
+				for (const int c : grid.touchedCells)
+				{
+					grid.cells[c] = glm::vec2(0.0f);
+				}
+			}
+			grid.touchedCells.clear();
+
+			for (int i = rowBegin * width; i < rowEnd * width; ++i)
+			{
+				const uint16_t d = depthData[i];
+				const auto& lut = tableData[i];
+				if (d == 0 || (lut.x == 0 && lut.y == 0)) continue;
+
+				const float depthVal = static_cast<float>(d);
+				const auto p = rotation * glm::vec3(lut.x * depthVal, lut.y * depthVal, depthVal) + translation;
+				if (p.y < minHeight || p.y > maxHeight) continue;
+
+				const int cx = static_cast<int>(std::floor((p.x - minBounds.x) * invCellSize));
+				const int cy = static_cast<int>(std::floor((p.z - minBounds.y) * invCellSize));
+				if (cx < 0 || cy < 0 || cx >= gridDims.x || cy >= gridDims.y) continue;
+
+				const int c = cy * gridDims.x + cx;
+				auto& cell = grid.cells[c];
+				if (cell.y == 0.0f)
+				{
+					grid.touchedCells.push_back(c);
+				}
+				cell.x = std::max(cell.x, p.y);
+				cell.y += 1.0f;
+			}
+		});
+
+		// Merging only walks touched cells, at most one per valid pixel.
+		this->gridPix.set(0);
+		auto gridData = reinterpret_cast<glm::vec2*>(this->gridPix.getData());
+		for (const auto& grid : this->chunkGrids)
+		{
+			for (const int c : grid.touchedCells)
+			{
+				gridData[c].x = std::max(gridData[c].x, grid.cells[c].x);
+				gridData[c].y += grid.cells[c].y;
+			}
+		}
+
+		if (this->settings.updateTexture)
+		{
+			this->gridTex.loadData(this->gridPix);
+		}
+
+		return true;
+	}
+
+	const HeightMapSettings& HeightMap::getSettings() const
+	{
+		return this->settings;
+	}
+
+	glm::ivec2 HeightMap::getGridDims() const
+	{
+		return this->gridDims;
+	}
+
+	const ofFloatPixels& HeightMap::getPixels() const
+	{
+		return this->gridPix;
+	}
+
+	const ofTexture& HeightMap::getTexture() const
+	{
+		return this->gridTex;
+	}
+}
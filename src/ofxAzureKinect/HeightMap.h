@@ -0,0 +1,73 @@
+#pragma once
+
+#include "ofPixels.h"
+#include "ofTexture.h"
+#include "ofVectorMath.h"
+
+namespace ofxAzureKinect
+{
+	class Stream;
+
+	struct HeightMapSettings
+	{
+		// Transform from depth camera space to floor space, in mm.
+		// Floor space is y-up with the floor at y = 0, the grid lies on the xz plane.
+		glm::mat4 cameraToFloor;
+
+		// Grid extents on the floor, in mm.
+		glm::vec2 minBounds;
+		glm::vec2 maxBounds;
+
+		// Cell edge length, in mm.
+		float cellSize;
+
+		// Only points within this height band are projected, e.g. to drop floor noise.
+		// Empty cells read as 0, so keep minHeight above the floor.
+		float minHeight;
+		float maxHeight;
+
+		// Upload the grid to a texture every update.
+		bool updateTexture;
+
+		HeightMapSettings();
+	};
+
+	// Projects depth straight into a top-down grid without building a point cloud.
+	// Each cell stores the max height (R) and the number of points (G) that landed in it.
+	class HeightMap
+	{
+	public:
+		HeightMap();
+		~HeightMap();
+
+		void setup(const HeightMapSettings& settings);
+		void setCameraToFloor(const glm::mat4& cameraToFloor);
+
+		bool update(const Stream& stream);
+		bool update(const ofShortPixels& depthPix, const ofFloatPixels& depthToWorldPix);
+
+		const HeightMapSettings& getSettings() const;
+		glm::ivec2 getGridDims() const;
+
+		const ofFloatPixels& getPixels() const;
+		// Only allocated with updateTexture.
+		const ofTexture& getTexture() const;
+
+	private:
+		// Grid written by one chunk of depth rows. Only the cells it touched are cleared and merged.
+		struct ChunkGrid
+		{
+			std::vector<glm::vec2> cells;
+			std::vector<int> touchedCells;
+		};
+
+	private:
+		HeightMapSettings settings;
+		glm::ivec2 gridDims;
+
+		std::vector<ChunkGrid> chunkGrids;
+
+		ofFloatPixels gridPix;
+		ofTexture gridTex;
+	};
+}
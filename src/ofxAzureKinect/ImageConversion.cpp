@@ -0,0 +1,344 @@
+#include "ImageConversion.h"
+
+#include <algorithm>
+
+#include "ofLog.h"
+
+#include "Parallel.h"
+
+namespace
+{
+	// Histograms bin 16-bit values by their top 12 bits.
+	const int HISTOGRAM_SHIFT = 4;
+	const int HISTOGRAM_BINS = 65536 >> HISTOGRAM_SHIFT;
+
+	// Fixed-point precision of the linear ramp.
+	const int RAMP_SHIFT = 16;
+
+	// Builds a histogram of the non-zero values in src, split across cores.
+	void buildHistogram(const uint16_t* srcData, int width, int height, std::vector<uint32_t>& histogram)
+	{
+		const int numChunks = ofxAzureKinect::getNumParallelChunks(height, 64, width);
+		std::vector<std::vector<uint32_t>> chunkHistograms(numChunks);
+		ofxAzureKinect::parallelForChunks(0, height, numChunks, [&](int chunk, int rowBegin, int rowEnd)
+		{
+			auto& local = chunkHistograms[chunk];
+			local.assign(HISTOGRAM_BINS, 0);
+			for (int i = rowBegin * width; i < rowEnd * width; ++i)
+			{
+				++local[srcData[i] >> HISTOGRAM_SHIFT];
+			}
+		});
+
+		histogram.assign(HISTOGRAM_BINS, 0);
+		for (const auto& local : chunkHistograms)
+		{
+			for (int b = 0; b < HISTOGRAM_BINS; ++b)
+			{
+				histogram[b] += local[b];
+			}
+		}
+
+		// Drop zeros, those are invalid pixels. Bin 0 also holds values up to
+		// 1 << HISTOGRAM_SHIFT, which don't matter for visualization.
+		histogram[0] = 0;
+	}
+
+	// Picks the input range from the histogram percentiles.
+	void getAutoRange(const uint16_t* srcData, int width, int height, float lowPercentile, float highPercentile, uint16_t& minValue, uint16_t& maxValue)
+	{
+		std::vector<uint32_t> histogram;
+		buildHistogram(srcData, width, height, histogram);
+
+		uint64_t total = 0;
+		for (auto count : histogram)
+		{
+			total += count;
+		}
+		if (total == 0)
+		{
+			minValue = 0;
+			maxValue = 1;
+			return;
+		}
+
+		const uint64_t lowCount = static_cast<uint64_t>(total * std::max(0.0f, lowPercentile));
+		const uint64_t highCount = static_cast<uint64_t>(total * std::min(1.0f, highPercentile));
+
+		int lowBin = 0;
+		int highBin = HISTOGRAM_BINS - 1;
+		uint64_t accum = 0;
+		bool foundLow = false;
+		for (int b = 0; b < HISTOGRAM_BINS; ++b)
+		{
+			accum += histogram[b];
+			if (!foundLow && accum > lowCount)
+			{
+				lowBin = b;
+				foundLow = true;
+			}
+			if (accum >= highCount)
+			{
+				highBin = b;
+				break;
+			}
+		}
+
+		minValue = static_cast<uint16_t>(lowBin << HISTOGRAM_SHIFT);
+		maxValue = static_cast<uint16_t>(std::min(65535, ((highBin + 1) << HISTOGRAM_SHIFT) - 1));
+	}
+
+	// Maps a row to 8-bit through a fixed-point ramp. Branch-free so it vectorizes.
+	inline void rampRow(const uint16_t* src, uint8_t* dst, int count, int minValue, int maxValue, int scale, bool invert)
+	{
+		if (invert)
+		{
+			for (int x = 0; x < count; ++x)
+			{
+				const int v = std::min(std::max(static_cast<int>(src[x]), minValue), maxValue);
+				const int mapped = 255 - (((v - minValue) * scale) >> RAMP_SHIFT);
+				dst[x] = static_cast<uint8_t>(src[x] ? mapped : 0);
+			}
+		}
+		else
+		{
+			for (int x = 0; x < count; ++x)
+			{
+				const int v = std::min(std::max(static_cast<int>(src[x]), minValue), maxValue);
+				const int mapped = ((v - minValue) * scale) >> RAMP_SHIFT;
+				dst[x] = static_cast<uint8_t>(src[x] ? mapped : 0);
+			}
+		}
+	}
+
+	bool resolveRange(const ofShortPixels& srcPix, const ofxAzureKinect::ConversionSettings& settings, int& minValue, int& maxValue, int& scale)
+	{
+		uint16_t rangeMin = settings.minValue;
+		uint16_t rangeMax = settings.maxValue;
+		if (settings.autoRange)
+		{
+			getAutoRange(srcPix.getData(), static_cast<int>(srcPix.getWidth()), static_cast<int>(srcPix.getHeight()),
+				settings.lowPercentile, settings.highPercentile, rangeMin, rangeMax);
+		}
+
+		if (rangeMax <= rangeMin)
+		{
+			ofLogWarning(__FUNCTION__) << "Invalid range [" << rangeMin << ", " << rangeMax << "]!";
+			return false;
+		}
+
+		minValue = rangeMin;
+		maxValue = rangeMax;
+		// (max - min) * scale must fit in 31 bits, which holds for any 16-bit range.
+		scale = (255 << RAMP_SHIFT) / (maxValue - minValue);
+		return true;
+	}
+
+	// Google's polynomial approximation of the Turbo colormap.
+	glm::vec3 getTurbo(float x)
+	{
+		const glm::vec4 kRed(0.13572138f, 4.61539260f, -42.66032258f, 132.13108234f);
+		const glm::vec4 kGreen(0.09140261f, 2.19418839f, 4.84296658f, -14.18503333f);
+		const glm::vec4 kBlue(0.10667330f, 12.64194608f, -60.58204836f, 110.36276771f);
+		const glm::vec2 kRed2(-152.94239396f, 59.28637943f);
+		const glm::vec2 kGreen2(4.27729857f, 2.82956604f);
+		const glm::vec2 kBlue2(-89.90310912f, 27.34824973f);
+
+		x = glm::clamp(x, 0.0f, 1.0f);
+		const glm::vec4 v4(1.0f, x, x * x, x * x * x);
+		const glm::vec2 v2 = glm::vec2(v4.z, v4.w) * v4.z;
+		return glm::vec3(
+			glm::dot(v4, kRed) + glm::dot(v2, kRed2),
+			glm::dot(v4, kGreen) + glm::dot(v2, kGreen2),
+			glm::dot(v4, kBlue) + glm::dot(v2, kBlue2));
+	}
+
+	glm::vec3 getJet(float x)
+	{
+		return glm::vec3(
+			glm::clamp(1.5f - std::abs(4.0f * x - 3.0f), 0.0f, 1.0f),
+			glm::clamp(1.5f - std::abs(4.0f * x - 2.0f), 0.0f, 1.0f),
+			glm::clamp(1.5f - std::abs(4.0f * x - 1.0f), 0.0f, 1.0f));
+	}
+
+	// 256 entry RGB lookup.
+	std::vector<uint8_t> buildColormapLut(ofxAzureKinect::Colormap colormap)
+	{
+		std::vector<uint8_t> lut(256 * 3);
+		for (int i = 0; i < 256; ++i)
+		{
+			const float x = i / 255.0f;
+			glm::vec3 color;
+			switch (colormap)
+			{
+			case ofxAzureKinect::COLORMAP_JET:
+				color = getJet(x);
+				break;
+			case ofxAzureKinect::COLORMAP_TURBO:
+				color = getTurbo(x);
+				break;
+			default:
+				color = glm::vec3(x);
+				break;
+			}
+
+			for (int c = 0; c < 3; ++c)
+			{
+				lut[i * 3 + c] = static_cast<uint8_t>(glm::clamp(color[c], 0.0f, 1.0f) * 255.0f + 0.5f);
+			}
+		}
+		return lut;
+	}
+
+	// Built once on first use, static initialisation is thread safe so any thread can convert.
+	const std::vector<uint8_t>& getColormapLut(ofxAzureKinect::Colormap colormap)
+	{
+		static const std::vector<uint8_t> luts[3] =
+		{
+			buildColormapLut(ofxAzureKinect::COLORMAP_GRAY),
+			buildColormapLut(ofxAzureKinect::COLORMAP_JET),
+			buildColormapLut(ofxAzureKinect::COLORMAP_TURBO)
+		};
+		return luts[colormap];
+	}
+}
+
+namespace ofxAzureKinect
+{
+	ConversionSettings::ConversionSettings()
+		: minValue(500)
+		, maxValue(5000)
+		, autoRange(false)
+		, lowPercentile(0.01f)
+		, highPercentile(0.99f)
+		, invert(false)
+	{}
+
+	bool convertToGray(const ofShortPixels& srcPix, ofPixels& dstPix, const ConversionSettings& settings)
+	{
+		if (!srcPix.isAllocated() || srcPix.getNumChannels() != 1)
+		{
+			ofLogError(__FUNCTION__) << "Source must be allocated single channel pixels!";
+			return false;
+		}
+
+		int minValue, maxValue, scale;
+		if (!resolveRange(srcPix, settings, minValue, maxValue, scale)) return false;
+
+		const int width = static_cast<int>(srcPix.getWidth());
+		const int height = static_cast<int>(srcPix.getHeight());
+		if (dstPix.getWidth() != srcPix.getWidth() || dstPix.getHeight() != srcPix.getHeight() || dstPix.getNumChannels() != 1)
+		{
+			dstPix.allocate(width, height, 1);
+		}
+
+		const uint16_t* srcData = srcPix.getData();
+		uint8_t* dstData = dstPix.getData();
+		const bool invert = settings.invert;
+		parallelFor(0, height, [&](int rowBegin, int rowEnd)
+		{
+			for (int y = rowBegin; y < rowEnd; ++y)
+			{
+				rampRow(srcData + y * width, dstData + y * width, width, minValue, maxValue, scale, invert);
+			}
+		}, 64, width);
+
+		return true;
+	}
+
+	bool convertToEqualized(const ofShortPixels& srcPix, ofPixels& dstPix)
+	{
+		if (!srcPix.isAllocated() || srcPix.getNumChannels() != 1)
+		{
+			ofLogError(__FUNCTION__) << "Source must be allocated single channel pixels!";
+			return false;
+		}
+
+		const int width = static_cast<int>(srcPix.getWidth());
+		const int height = static_cast<int>(srcPix.getHeight());
+		const uint16_t* srcData = srcPix.getData();
+
+		std::vector<uint32_t> histogram;
+		buildHistogram(srcData, width, height, histogram);
+
+		// Turn the cumulative histogram into a bin to gray lookup.
+		uint64_t total = 0;
+		for (auto count : histogram)
+		{
+			total += count;
+		}
+
+		std::vector<uint8_t> lut(HISTOGRAM_BINS, 0);
+		if (total > 0)
+		{
+			uint64_t accum = 0;
+			for (int b = 1; b < HISTOGRAM_BINS; ++b)
+			{
+				accum += histogram[b];
+				lut[b] = static_cast<uint8_t>((accum * 255) / total);
+			}
+		}
+
+		if (dstPix.getWidth() != srcPix.getWidth() || dstPix.getHeight() != srcPix.getHeight() || dstPix.getNumChannels() != 1)
+		{
+			dstPix.allocate(width, height, 1);
+		}
+
+		uint8_t* dstData = dstPix.getData();
+		const uint8_t* lutData = lut.data();
+		parallelFor(0, height, [&](int rowBegin, int rowEnd)
+		{
+			for (int i = rowBegin * width; i < rowEnd * width; ++i)
+			{
+				dstData[i] = lutData[srcData[i] >> HISTOGRAM_SHIFT];
+			}
+		}, 64, width);
+
+		return true;
+	}
+
+	bool convertToColormap(const ofShortPixels& srcPix, ofPixels& dstPix, Colormap colormap, const ConversionSettings& settings)
+	{
+		if (!srcPix.isAllocated() || srcPix.getNumChannels() != 1)
+		{
+			ofLogError(__FUNCTION__) << "Source must be allocated single channel pixels!";
+			return false;
+		}
+
+		int minValue, maxValue, scale;
+		if (!resolveRange(srcPix, settings, minValue, maxValue, scale)) return false;
+
+		const int width = static_cast<int>(srcPix.getWidth());
+		const int height = static_cast<int>(srcPix.getHeight());
+		if (dstPix.getWidth() != srcPix.getWidth() || dstPix.getHeight() != srcPix.getHeight() || dstPix.getNumChannels() != 3)
+		{
+			dstPix.allocate(width, height, OF_PIXELS_RGB);
+		}
+
+		const uint16_t* srcData = srcPix.getData();
+		uint8_t* dstData = dstPix.getData();
+		const uint8_t* lutData = getColormapLut(colormap).data();
+		const bool invert = settings.invert;
+		parallelFor(0, height, [&](int rowBegin, int rowEnd)
+		{
+			// Ramp a row to indices first so that part vectorizes, then gather colors.
+			std::vector<uint8_t> indices(width);
+			for (int y = rowBegin; y < rowEnd; ++y)
+			{
+				const uint16_t* src = srcData + y * width;
+				uint8_t* dst = dstData + y * width * 3;
+				rampRow(src, indices.data(), width, minValue, maxValue, scale, invert);
+				for (int x = 0; x < width; ++x)
+				{
+					const uint8_t* color = lutData + indices[x] * 3;
+					const uint8_t valid = src[x] ? 0xFF : 0x00;
+					dst[x * 3 + 0] = color[0] & valid;
+					dst[x * 3 + 1] = color[1] & valid;
+					dst[x * 3 + 2] = color[2] & valid;
+				}
+			}
+		}, 64, width);
+
+		return true;
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "ofPixels.h"
+#include "ofVectorMath.h"
+
+namespace ofxAzureKinect
+{
+	enum Colormap
+	{
+		COLORMAP_GRAY,
+		COLORMAP_JET,
+		COLORMAP_TURBO
+	};
+
+	struct ConversionSettings
+	{
+		// Input range mapped to the full output range.
+		uint16_t minValue;
+		uint16_t maxValue;
+
+		// Pick the range every frame from the histogram of valid pixels instead.
+		bool autoRange;
+		float lowPercentile;
+		float highPercentile;
+
+		// Flip the ramp, e.g. to draw near depth bright.
+		bool invert;
+
+		ConversionSettings();
+	};
+
+	// Maps 16-bit depth or IR to 8-bit gray, linearly over the settings range.
+	// Zero input (invalid depth) always maps to zero.
+	bool convertToGray(const ofShortPixels& srcPix, ofPixels& dstPix, const ConversionSettings& settings = ConversionSettings());
+
+	// Maps 16-bit IR to 8-bit gray with histogram equalization, which handles
+	// the long tail of bright returns much better than a linear ramp.
+	bool convertToEqualized(const ofShortPixels& srcPix, ofPixels& dstPix);
+
+	// Maps 16-bit depth to RGB through a colormap. Zero input maps to black.
+	bool convertToColormap(const ofShortPixels& srcPix, ofPixels& dstPix, Colormap colormap, const ConversionSettings& settings = ConversionSettings());
+}
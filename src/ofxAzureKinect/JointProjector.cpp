@@ -0,0 +1,175 @@
+#include "JointProjector.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "ofLog.h"
+
+namespace ofxAzureKinect
+{
+	JointProjector::JointProjector()
+	{
+		this->depthCamera.bEnabled = false;
+		this->colorCamera.bEnabled = false;
+	}
+
+	JointProjector::~JointProjector()
+	{}
+
+	void JointProjector::setup(const k4a_calibration_t& calibration)
+	{
+		// Joints are in depth camera space, so depth uses the identity transform.
+		k4a_calibration_extrinsics_t identity;
+		for (int i = 0; i < 9; ++i)
+		{
+			identity.rotation[i] = (i % 4 == 0) ? 1.0f : 0.0f;
+		}
+		identity.translation[0] = identity.translation[1] = identity.translation[2] = 0.0f;
+
+		this->setupCamera(this->depthCamera, calibration.depth_camera_calibration, identity);
+		this->setupCamera(this->colorCamera, calibration.color_camera_calibration,
+			calibration.extrinsics[K4A_CALIBRATION_TYPE_DEPTH][K4A_CALIBRATION_TYPE_COLOR]);
+
+		this->clear();
+	}
+
+	void JointProjector::clear()
+	{
+		this->depthPoints.clear();
+		this->depthValid.clear();
+		this->colorPoints.clear();
+		this->colorValid.clear();
+	}
+
+	bool JointProjector::update(const std::vector<k4abt_skeleton_t>& skeletons)
+	{
+		if (!this->depthCamera.bEnabled)
+		{
+			ofLogWarning(__FUNCTION__) << "Projector not set up!";
+			return false;
+		}
+
+		const size_t count = skeletons.size() * K4ABT_JOINT_COUNT;
+		this->xs.resize(count);
+		this->ys.resize(count);
+		this->zs.resize(count);
+		for (size_t b = 0; b < skeletons.size(); ++b)
+		{
+			for (int j = 0; j < K4ABT_JOINT_COUNT; ++j)
+			{
+				const size_t i = b * K4ABT_JOINT_COUNT + j;
+				const auto& position = skeletons[b].joints[j].position;
+				this->xs[i] = position.v[0];
+				this->ys[i] = position.v[1];
+				this->zs[i] = position.v[2];
+			}
+		}
+
+		this->project(this->depthCamera, this->depthPoints, this->depthValid);
+		if (this->colorCamera.bEnabled)
+		{
+			this->project(this->colorCamera, this->colorPoints, this->colorValid);
+		}
+
+		return true;
+	}
+
+	bool JointProjector::hasColor() const
+	{
+		return this->colorCamera.bEnabled;
+	}
+
+	const std::vector<glm::vec2>& JointProjector::getDepthPoints() const
+	{
+		return this->depthPoints;
+	}
+
+	const std::vector<uint8_t>& JointProjector::getDepthValid() const
+	{
+		return this->depthValid;
+	}
+
+	const std::vector<glm::vec2>& JointProjector::getColorPoints() const
+	{
+		return this->colorPoints;
+	}
+
+	const std::vector<uint8_t>& JointProjector::getColorValid() const
+	{
+		return this->colorValid;
+	}
+
+	void JointProjector::setupCamera(Camera& camera, const k4a_calibration_camera_t& calibrationCamera, const k4a_calibration_extrinsics_t& extrinsics)
+	{
+		const auto model = calibrationCamera.intrinsics.type;
+		camera.bEnabled = calibrationCamera.resolution_width > 0 && calibrationCamera.resolution_height > 0 &&
+			(model == K4A_CALIBRATION_LENS_DISTORTION_MODEL_BROWN_CONRADY || model == K4A_CALIBRATION_LENS_DISTORTION_MODEL_RATIONAL_6KT);
+		if (!camera.bEnabled)
+		{
+			if (calibrationCamera.resolution_width > 0)
+			{
+				ofLogWarning(__FUNCTION__) << "Unsupported lens model " << model << ", skipping camera.";
+			}
+			return;
+		}
+
+		camera.extrinsics = extrinsics;
+		camera.params = calibrationCamera.intrinsics.parameters;
+		camera.tangentialScale = (model == K4A_CALIBRATION_LENS_DISTORTION_MODEL_BROWN_CONRADY) ? 2.0f : 1.0f;
+		camera.maxRadiusSq = calibrationCamera.metric_radius * calibrationCamera.metric_radius;
+		camera.size = glm::vec2(calibrationCamera.resolution_width, calibrationCamera.resolution_height);
+	}
+
+	void JointProjector::project(const Camera& camera, std::vector<glm::vec2>& points, std::vector<uint8_t>& valid) const
+	{
+		const int count = static_cast<int>(this->xs.size());
+		points.resize(count);
+		valid.resize(count);
+
+		const auto& p = camera.params.param;
+		// Extrinsic rotation is row major, translation in mm.
+		const float* r = camera.extrinsics.rotation;
+		const float* t = camera.extrinsics.translation;
+		const float maxRadiusSq = (camera.maxRadiusSq > 0.0f) ? camera.maxRadiusSq : std::numeric_limits<float>::max();
+
+		const float* xs = this->xs.data();
+		const float* ys = this->ys.data();
+		const float* zs = this->zs.data();
+		float* uv = reinterpret_cast<float*>(points.data());
+		uint8_t* validData = valid.data();
+
+		// Straight line math over flat arrays, invalid points are flagged rather than branched around.
+		for (int i = 0; i < count; ++i)
+		{
+			const float x = r[0] * xs[i] + r[1] * ys[i] + r[2] * zs[i] + t[0];
+			const float y = r[3] * xs[i] + r[4] * ys[i] + r[5] * zs[i] + t[1];
+			const float z = r[6] * xs[i] + r[7] * ys[i] + r[8] * zs[i] + t[2];
+
+			const float invZ = 1.0f / std::max(z, 1e-3f);
+			const float xp = x * invZ - p.codx;
+			const float yp = y * invZ - p.cody;
+
+			const float xp2 = xp * xp;
+			const float yp2 = yp * yp;
+			const float xyp = xp * yp;
+			const float rs = xp2 + yp2;
+			const float rss = rs * rs;
+			const float rsc = rss * rs;
+
+			const float a = 1.0f + p.k1 * rs + p.k2 * rss + p.k3 * rsc;
+			const float b = 1.0f + p.k4 * rs + p.k5 * rss + p.k6 * rsc;
+			const float d = a / ((b != 0.0f) ? b : 1.0f);
+
+			const float xd = xp * d + (rs + 2.0f * xp2) * p.p2 + camera.tangentialScale * xyp * p.p1;
+			const float yd = yp * d + (rs + 2.0f * yp2) * p.p1 + camera.tangentialScale * xyp * p.p2;
+
+			const float u = (xd + p.codx) * p.fx + p.cx;
+			const float v = (yd + p.cody) * p.fy + p.cy;
+			uv[i * 2 + 0] = u;
+			uv[i * 2 + 1] = v;
+
+			validData[i] = static_cast<uint8_t>((z > 0.0f) & (rs <= maxRadiusSq) &
+				(u >= 0.0f) & (u < camera.size.x) & (v >= 0.0f) & (v < camera.size.y));
+		}
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vector>
+
+#include <k4a/k4atypes.h>
+#include <k4abttypes.h>
+
+#include "ofVectorMath.h"
+
+namespace ofxAzureKinect
+{
+	// Projects every joint of every body into depth and color pixel coordinates in one batch.
+	// Uses the same Brown-Conrady / rational lens model as k4a_calibration_3d_to_2d, but runs
+	// over flat coordinate arrays instead of calling into the SDK once per joint.
+	class JointProjector
+	{
+	public:
+		JointProjector();
+		~JointProjector();
+
+		void setup(const k4a_calibration_t& calibration);
+		void clear();
+
+		bool update(const std::vector<k4abt_skeleton_t>& skeletons);
+
+		bool hasColor() const;
+
+		// Packed as body * K4ABT_JOINT_COUNT + joint, in skeleton order.
+		// A point is valid if it is in front of the camera, inside the lens model range and inside the image.
+		const std::vector<glm::vec2>& getDepthPoints() const;
+		const std::vector<uint8_t>& getDepthValid() const;
+
+		const std::vector<glm::vec2>& getColorPoints() const;
+		const std::vector<uint8_t>& getColorValid() const;
+
+	private:
+		struct Camera
+		{
+			bool bEnabled;
+			k4a_calibration_extrinsics_t extrinsics;
+			k4a_calibration_intrinsic_parameters_t params;
+			float tangentialScale;
+			float maxRadiusSq;
+			glm::vec2 size;
+		};
+
+		void setupCamera(Camera& camera, const k4a_calibration_camera_t& calibrationCamera, const k4a_calibration_extrinsics_t& extrinsics);
+		void project(const Camera& camera, std::vector<glm::vec2>& points, std::vector<uint8_t>& valid) const;
+
+	private:
+		Camera depthCamera;
+		Camera colorCamera;
+
+		std::vector<float> xs;
+		std::vector<float> ys;
+		std::vector<float> zs;
+
+		std::vector<glm::vec2> depthPoints;
+		std::vector<uint8_t> depthValid;
+
+		std::vector<glm::vec2> colorPoints;
+		std::vector<uint8_t> colorValid;
+	};
+}
@@ -0,0 +1,124 @@
+#include "Parallel.h"
+
+namespace ofxAzureKinect
+{
+	ParallelPool& ParallelPool::getInstance()
+	{
+		static ParallelPool pool;
+		return pool;
+	}
+
+	int ParallelPool::getNumThreads()
+	{
+		static const int numThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+		return numThreads;
+	}
+
+	ParallelPool::ParallelPool()
+		: bStopping(false)
+		, bJobActive(false)
+		, generation(0)
+		, numBusy(0)
+		, task(nullptr)
+		, context(nullptr)
+		, numTasks(0)
+		, nextTask(0)
+	{
+		const int numWorkers = getNumThreads() - 1;
+		this->workers.reserve(numWorkers);
+		for (int i = 0; i < numWorkers; ++i)
+		{
+			this->workers.emplace_back(&ParallelPool::workerLoop, this);
+		}
+	}
+
+	ParallelPool::~ParallelPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->bStopping = true;
+		}
+		this->startCondition.notify_all();
+
+		for (auto& worker : this->workers)
+		{
+			worker.join();
+		}
+	}
+
+	void ParallelPool::run(int numTasks, TaskFn task, void* context)
+	{
+		std::unique_lock<std::mutex> runLock(this->runMutex, std::try_to_lock);
+		if (!runLock.owns_lock() || this->workers.empty())
+		{
+			for (int i = 0; i < numTasks; ++i)
+			{
+				task(context, i);
+			}
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->task = task;
+			this->context = context;
+			this->numTasks = numTasks;
+			this->nextTask = 0;
+			this->bJobActive = true;
+			++this->generation;
+		}
+		this->startCondition.notify_all();
+
+		this->runTasks();
+
+		// All tasks are claimed, wait for the workers still running theirs.
+		std::unique_lock<std::mutex> lock(this->mutex);
+		this->doneCondition.wait(lock, [this]
+		{
+			return this->numBusy == 0;
+		});
+		this->bJobActive = false;
+		this->task = nullptr;
+		this->context = nullptr;
+	}
+
+	void ParallelPool::workerLoop()
+	{
+		uint64_t lastGeneration = 0;
+		while (true)
+		{
+			{
+				std::unique_lock<std::mutex> lock(this->mutex);
+				this->startCondition.wait(lock, [this, lastGeneration]
+				{
+					return this->bStopping || (this->bJobActive && this->generation != lastGeneration);
+				});
+
+				if (this->bStopping) return;
+
+				// Joining under the lock keeps the job alive until this worker is done with it.
+				lastGeneration = this->generation;
+				++this->numBusy;
+			}
+
+			this->runTasks();
+
+			{
+				std::lock_guard<std::mutex> lock(this->mutex);
+				--this->numBusy;
+			}
+			this->doneCondition.notify_one();
+		}
+	}
+
+	void ParallelPool::runTasks()
+	{
+		while (true)
+		{
+			const int i = this->nextTask.fetch_add(1);
+			if (i >= this->numTasks) break;
+
+			this->task(this->context, i);
+		}
+	}
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ofxAzureKinect
+{
+	// Work below this many units per chunk (e.g. pixels) costs less than waking a worker for it.
+	const int PARALLEL_MIN_CHUNK_WORK = 16384;
+
+	// Worker threads shared by every parallel loop, started on first use and kept until exit.
+	// One loop runs on the pool at a time and the calling thread takes part in it. Loops started
+	// while the pool is busy, from another stream or nested inside a task, run inline instead.
+	class ParallelPool
+	{
+	public:
+		typedef void(*TaskFn)(void* context, int index);
+
+		static ParallelPool& getInstance();
+
+		// Workers plus the calling thread.
+		static int getNumThreads();
+
+		// Runs task(context, i) for every i in [0, numTasks) and returns once all are done.
+		void run(int numTasks, TaskFn task, void* context);
+
+	private:
+		ParallelPool();
+		~ParallelPool();
+
+		void workerLoop();
+
+		// Claims and runs tasks of the current job until none are left.
+		void runTasks();
+
+	private:
+		std::vector<std::thread> workers;
+
+		// Held by the thread running a job on the pool.
+		std::mutex runMutex;
+
+		std::mutex mutex;
+		std::condition_variable startCondition;
+		std::condition_variable doneCondition;
+		bool bStopping;
+		bool bJobActive;
+		uint64_t generation;
+		int numBusy;
+
+		TaskFn task;
+		void* context;
+		int numTasks;
+		std::atomic<int> nextTask;
+	};
+
+	// Returns how many chunks a range of count items should be split into, keeping at least
+	// minChunk items per chunk. With itemWork set, e.g. to the pixels in a row, chunks also get
+	// at least PARALLEL_MIN_CHUNK_WORK units, so small frames run inline.
+	inline int getNumParallelChunks(int count, int minChunk = 16, int itemWork = 0)
+	{
+		int minItems = std::max(1, minChunk);
+		if (itemWork > 0)
+		{
+			minItems = std::max(minItems, (PARALLEL_MIN_CHUNK_WORK + itemWork - 1) / itemWork);
+		}
+		return std::max(1, std::min(ParallelPool::getNumThreads(), count / minItems));
+	}
+
+	// Runs fn(chunk, chunkBegin, chunkEnd) over numChunks contiguous slices of [begin, end).
+	// Every chunk is called, trailing ones may get an empty range.
+	template<typename Fn>
+	void parallelForChunks(int begin, int end, int numChunks, Fn fn)
+	{
+		const int count = end - begin;
+		if (count <= 0) return;
+
+		numChunks = std::max(1, std::min(numChunks, count));
+		if (numChunks == 1)
+		{
+			fn(0, begin, end);
+			return;
+		}
+
+		const int chunkSize = (count + numChunks - 1) / numChunks;
+		auto runChunk = [&](int chunk)
+		{
+			const int chunkBegin = std::min(end, begin + chunk * chunkSize);
+			const int chunkEnd = (chunk == numChunks - 1) ? end : std::min(end, chunkBegin + chunkSize);
+			fn(chunk, chunkBegin, chunkEnd);
+		};
+		ParallelPool::getInstance().run(numChunks, [](void* context, int chunk)
+		{
+			(*static_cast<decltype(runChunk)*>(context))(chunk);
+		}, &runChunk);
+	}
+
+	// Runs fn(chunkBegin, chunkEnd) over [begin, end) split across the available cores.
+	template<typename Fn>
+	void parallelFor(int begin, int end, Fn fn, int minChunk = 16, int itemWork = 0)
+	{
+		parallelForChunks(begin, end, getNumParallelChunks(end - begin, minChunk, itemWork), [&fn](int, int chunkBegin, int chunkEnd)
+		{
+			fn(chunkBegin, chunkEnd);
+		});
+	}
+}
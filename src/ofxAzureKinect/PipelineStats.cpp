@@ -0,0 +1,287 @@
+#include "PipelineStats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+#include "ofFileUtils.h"
+#include "ofLog.h"
+#include "ofUtils.h"
+
+namespace ofxAzureKinect
+{
+	const char* getPipelineStageName(PipelineStage stage)
+	{
+		switch (stage)
+		{
+		case PIPELINE_STAGE_UPDATE: return "update";
+		case PIPELINE_STAGE_CAPTURE: return "capture";
+		case PIPELINE_STAGE_DEPTH: return "depth";
+		case PIPELINE_STAGE_COLOR: return "color";
+		case PIPELINE_STAGE_IR: return "ir";
+		case PIPELINE_STAGE_BODIES: return "bodies";
+		case PIPELINE_STAGE_POINT_CLOUDS: return "pointClouds";
+		case PIPELINE_STAGE_TRANSFORMS: return "transforms";
+		case PIPELINE_STAGE_UPLOAD: return "upload";
+		case PIPELINE_STAGE_POST_UPDATE: return "postUpdate";
+		default: return "unknown";
+		}
+	}
+
+	StageStats::StageStats()
+		: numFrames(0)
+		, lastUsec(0)
+		, meanUsec(0.0f)
+		, p50Usec(0)
+		, p95Usec(0)
+		, p99Usec(0)
+		, maxUsec(0)
+	{}
+
+	PipelineStats::PipelineStats()
+		: numFrames(0)
+	{}
+
+	const StageStats& PipelineStats::operator[](PipelineStage stage) const
+	{
+		return this->stages[stage];
+	}
+
+	LatencyHistogram::LatencyHistogram()
+		: numSamples(0)
+		, windowSum(0)
+		, lastValue(0)
+		, windowIndex(0)
+	{
+		for (auto& bucket : this->buckets)
+		{
+			bucket = 0;
+		}
+	}
+
+	void LatencyHistogram::setup(size_t windowSize)
+	{
+		for (auto& bucket : this->buckets)
+		{
+			bucket = 0;
+		}
+		this->numSamples = 0;
+		this->windowSum = 0;
+		this->lastValue = 0;
+
+		this->window.assign(std::max<size_t>(windowSize, 1), 0);
+		this->windowIndex = 0;
+	}
+
+	size_t LatencyHistogram::getWindowSize() const
+	{
+		return this->window.size();
+	}
+
+	void LatencyHistogram::add(uint32_t valueUsec)
+	{
+		if (this->window.empty())
+		{
+			this->setup(1);
+		}
+
+		// Evict the oldest sample once the window is full.
+		const uint64_t count = this->numSamples.load(std::memory_order_relaxed);
+		if (count >= this->window.size())
+		{
+			const uint32_t oldValue = this->window[this->windowIndex];
+			this->buckets[getBucket(oldValue)].fetch_sub(1, std::memory_order_relaxed);
+			this->windowSum.fetch_sub(oldValue, std::memory_order_relaxed);
+		}
+
+		this->window[this->windowIndex] = valueUsec;
+		this->windowIndex = (this->windowIndex + 1) % this->window.size();
+
+		this->buckets[getBucket(valueUsec)].fetch_add(1, std::memory_order_relaxed);
+		this->windowSum.fetch_add(valueUsec, std::memory_order_relaxed);
+		this->lastValue.store(valueUsec, std::memory_order_relaxed);
+		this->numSamples.store(count + 1, std::memory_order_release);
+	}
+
+	StageStats LatencyHistogram::getStats() const
+	{
+		StageStats stats;
+		stats.numFrames = this->numSamples.load(std::memory_order_acquire);
+		stats.lastUsec = this->lastValue.load(std::memory_order_relaxed);
+
+		// Copy the buckets first, the writer may be adding samples.
+		std::array<uint32_t, NUM_BUCKETS> counts;
+		uint64_t total = 0;
+		for (size_t i = 0; i < NUM_BUCKETS; ++i)
+		{
+			counts[i] = this->buckets[i].load(std::memory_order_relaxed);
+			total += counts[i];
+		}
+		if (total == 0) return stats;
+
+		stats.meanUsec = static_cast<float>(this->windowSum.load(std::memory_order_relaxed)) / total;
+
+		const uint64_t rank50 = static_cast<uint64_t>(std::ceil(total * 0.50));
+		const uint64_t rank95 = static_cast<uint64_t>(std::ceil(total * 0.95));
+		const uint64_t rank99 = static_cast<uint64_t>(std::ceil(total * 0.99));
+		uint64_t seen = 0;
+		for (size_t i = 0; i < NUM_BUCKETS; ++i)
+		{
+			if (counts[i] == 0) continue;
+
+			const uint64_t prevSeen = seen;
+			seen += counts[i];
+
+			const uint32_t value = getBucketValue(i);
+			if (prevSeen < rank50 && seen >= rank50) stats.p50Usec = value;
+			if (prevSeen < rank95 && seen >= rank95) stats.p95Usec = value;
+			if (prevSeen < rank99 && seen >= rank99) stats.p99Usec = value;
+			stats.maxUsec = value;
+		}
+
+		return stats;
+	}
+
+	size_t LatencyHistogram::getBucket(uint32_t value)
+	{
+		// Values under 8 get a bucket each, then every octave is split in 8.
+		if (value < 8) return value;
+
+		int octave = 0;
+		while ((value >> octave) >= 16)
+		{
+			++octave;
+		}
+		const uint32_t subBucket = (value >> octave) & 7;
+		return 8 + octave * 8 + subBucket;
+	}
+
+	uint32_t LatencyHistogram::getBucketValue(size_t bucket)
+	{
+		if (bucket < 8) return static_cast<uint32_t>(bucket);
+
+		// Middle of the bucket range.
+		const size_t octave = (bucket - 8) / 8;
+		const uint64_t lower = static_cast<uint64_t>(8 + (bucket - 8) % 8) << octave;
+		const uint64_t width = static_cast<uint64_t>(1) << octave;
+		return static_cast<uint32_t>(std::min<uint64_t>(lower + width / 2, UINT32_MAX));
+	}
+
+	PipelineProfiler::PipelineProfiler()
+		: numFrames(0)
+		, bTracing(false)
+		, maxTraceEvents(0)
+	{
+		this->frameUsec.fill(0);
+		this->frameStages.fill(false);
+	}
+
+	void PipelineProfiler::setup(size_t windowSize)
+	{
+		for (auto& histogram : this->histograms)
+		{
+			histogram.setup(windowSize);
+		}
+		this->numFrames = 0;
+	}
+
+	void PipelineProfiler::beginFrame()
+	{
+		this->frameUsec.fill(0);
+		this->frameStages.fill(false);
+	}
+
+	void PipelineProfiler::endFrame()
+	{
+		for (size_t i = 0; i < NUM_PIPELINE_STAGES; ++i)
+		{
+			if (this->frameStages[i])
+			{
+				this->histograms[i].add(static_cast<uint32_t>(std::min<uint64_t>(this->frameUsec[i], UINT32_MAX)));
+			}
+		}
+		this->numFrames.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void PipelineProfiler::addTime(PipelineStage stage, uint64_t startUsec, uint64_t durationUsec)
+	{
+		this->frameUsec[stage] += durationUsec;
+		this->frameStages[stage] = true;
+
+		if (this->bTracing)
+		{
+			this->traceEvents.push_back({ stage, startUsec, durationUsec });
+			if (this->traceEvents.size() >= this->maxTraceEvents)
+			{
+				ofLogNotice(__FUNCTION__) << "Trace full after " << this->traceEvents.size() << " events, stopping.";
+				this->bTracing = false;
+			}
+		}
+	}
+
+	PipelineStats PipelineProfiler::getStats() const
+	{
+		PipelineStats stats;
+		stats.numFrames = this->numFrames.load(std::memory_order_relaxed);
+		for (size_t i = 0; i < NUM_PIPELINE_STAGES; ++i)
+		{
+			stats.stages[i] = this->histograms[i].getStats();
+		}
+		return stats;
+	}
+
+	void PipelineProfiler::startTrace(size_t maxEvents)
+	{
+		this->traceEvents.clear();
+		this->traceEvents.reserve(std::min<size_t>(maxEvents, 100000));
+		this->maxTraceEvents = std::max<size_t>(maxEvents, 1);
+		this->bTracing = true;
+	}
+
+	void PipelineProfiler::stopTrace()
+	{
+		this->bTracing = false;
+	}
+
+	bool PipelineProfiler::isTracing() const
+	{
+		return this->bTracing;
+	}
+
+	bool PipelineProfiler::saveTrace(const std::string& filePath) const
+	{
+		// Complete events, one per timed section, all on the update thread.
+		std::ostringstream json;
+		json << "{\"traceEvents\":[";
+		for (size_t i = 0; i < this->traceEvents.size(); ++i)
+		{
+			const auto& event = this->traceEvents[i];
+			json << (i > 0 ? ",\n" : "\n")
+				<< "{\"name\":\"" << getPipelineStageName(event.stage) << "\",\"cat\":\"ofxAzureKinect\",\"ph\":\"X\""
+				<< ",\"ts\":" << event.startUsec << ",\"dur\":" << event.durationUsec << ",\"pid\":0,\"tid\":0}";
+		}
+		json << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+		const std::string text = json.str();
+		ofBuffer buffer(text.c_str(), text.size());
+		if (!ofBufferToFile(filePath, buffer))
+		{
+			ofLogError(__FUNCTION__) << "Could not write trace to " << filePath << "!";
+			return false;
+		}
+
+		ofLogNotice(__FUNCTION__) << "Saved " << this->traceEvents.size() << " trace events to " << filePath << ".";
+		return true;
+	}
+
+	ScopedStageTimer::ScopedStageTimer(PipelineProfiler& profiler, PipelineStage stage)
+		: profiler(profiler)
+		, stage(stage)
+		, startUsec(ofGetElapsedTimeMicros())
+	{}
+
+	ScopedStageTimer::~ScopedStageTimer()
+	{
+		this->profiler.addTime(this->stage, this->startUsec, ofGetElapsedTimeMicros() - this->startUsec);
+	}
+}
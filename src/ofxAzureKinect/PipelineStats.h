@@ -0,0 +1,147 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <string>
+#include <vector>
+
+namespace ofxAzureKinect
+{
+	// Timed sections of Stream::update(). Stages can nest, uploads are also counted in the stage they happen in.
+	enum PipelineStage
+	{
+		// The whole update, from asking for a capture to the end of post processing.
+		PIPELINE_STAGE_UPDATE,
+		// Waiting for (or producing) the next capture.
+		PIPELINE_STAGE_CAPTURE,
+		// Depth copy or filtering, pyramid, background model and blobs.
+		PIPELINE_STAGE_DEPTH,
+		// MJPG decode or BGRA copy.
+		PIPELINE_STAGE_COLOR,
+		PIPELINE_STAGE_IR,
+		// Handing captures to the body tracker and waiting for its results.
+		PIPELINE_STAGE_BODIES,
+		PIPELINE_STAGE_POINT_CLOUDS,
+		// Depth in color and color in depth.
+		PIPELINE_STAGE_TRANSFORMS,
+		// Texture and VBO uploads.
+		PIPELINE_STAGE_UPLOAD,
+		// Recorders and subclass post processing.
+		PIPELINE_STAGE_POST_UPDATE,
+		NUM_PIPELINE_STAGES
+	};
+
+	const char* getPipelineStageName(PipelineStage stage);
+
+	struct StageStats
+	{
+		// Frames the stage ran in since the last reset, the percentiles only cover the window.
+		uint64_t numFrames;
+
+		// Time per frame, in microseconds. Percentiles are accurate to about 6%.
+		uint32_t lastUsec;
+		float meanUsec;
+		uint32_t p50Usec;
+		uint32_t p95Usec;
+		uint32_t p99Usec;
+		uint32_t maxUsec;
+
+		StageStats();
+	};
+
+	struct PipelineStats
+	{
+		uint64_t numFrames;
+		std::array<StageStats, NUM_PIPELINE_STAGES> stages;
+
+		PipelineStats();
+
+		const StageStats& operator[](PipelineStage stage) const;
+	};
+
+	// Distribution of the last windowSize samples, in log-linear buckets of 1/8 octave.
+	// Written by one thread, samples and percentiles can be read from any thread without locking.
+	class LatencyHistogram
+	{
+	public:
+		static const size_t NUM_BUCKETS = 8 + 29 * 8;
+
+		LatencyHistogram();
+
+		// Clears all samples.
+		void setup(size_t windowSize);
+		size_t getWindowSize() const;
+
+		void add(uint32_t valueUsec);
+
+		StageStats getStats() const;
+
+	private:
+		static size_t getBucket(uint32_t value);
+		static uint32_t getBucketValue(size_t bucket);
+
+		std::array<std::atomic<uint32_t>, NUM_BUCKETS> buckets;
+		std::atomic<uint64_t> numSamples;
+		std::atomic<uint64_t> windowSum;
+		std::atomic<uint32_t> lastValue;
+
+		// Only touched by the writer.
+		std::vector<uint32_t> window;
+		size_t windowIndex;
+	};
+
+	// Times the stages of a stream on every frame, and optionally records them as a Chrome trace.
+	class PipelineProfiler
+	{
+	public:
+		PipelineProfiler();
+
+		void setup(size_t windowSize);
+
+		// Time spent in each stage is summed over the frame, and added to the histograms at the end.
+		void beginFrame();
+		void endFrame();
+
+		void addTime(PipelineStage stage, uint64_t startUsec, uint64_t durationUsec);
+
+		PipelineStats getStats() const;
+
+		// Records every timed section until maxEvents are collected or the trace is stopped.
+		void startTrace(size_t maxEvents = 100000);
+		void stopTrace();
+		bool isTracing() const;
+
+		// Saves the recorded sections in the Chrome trace event format, for chrome://tracing or Perfetto.
+		bool saveTrace(const std::string& filePath) const;
+
+	private:
+		struct TraceEvent
+		{
+			PipelineStage stage;
+			uint64_t startUsec;
+			uint64_t durationUsec;
+		};
+
+		std::array<LatencyHistogram, NUM_PIPELINE_STAGES> histograms;
+		std::array<uint64_t, NUM_PIPELINE_STAGES> frameUsec;
+		std::array<bool, NUM_PIPELINE_STAGES> frameStages;
+		std::atomic<uint64_t> numFrames;
+
+		bool bTracing;
+		size_t maxTraceEvents;
+		std::vector<TraceEvent> traceEvents;
+	};
+
+	// Adds the time until it goes out of scope to a stage.
+	class ScopedStageTimer
+	{
+	public:
+		ScopedStageTimer(PipelineProfiler& profiler, PipelineStage stage);
+		~ScopedStageTimer();
+
+	private:
+		PipelineProfiler& profiler;
+		PipelineStage stage;
+		uint64_t startUsec;
+	};
+}
@@ -0,0 +1,280 @@
+#include "Playback.h"
+
+#include "ofLog.h"
+#include "ofUtils.h"
+
+namespace
+{
+	// Device timestamp of the first image found in the capture, in microseconds.
+	uint64_t getCaptureTimestampUsec(const k4a::capture& capture)
+	{
+		auto img = capture.get_depth_image();
+		if (!img) img = capture.get_color_image();
+		if (!img) img = capture.get_ir_image();
+		return img ? static_cast<uint64_t>(img.get_device_timestamp().count()) : 0;
+	}
+}
+
+namespace ofxAzureKinect
+{
+	PlaybackSettings::PlaybackSettings()
+		: realtime(true)
+		, loop(true)
+	{}
+
+	Playback::Playback()
+		: bRealtime(true)
+		, bLoop(true)
+		, bFinished(false)
+		, bRewound(false)
+		, bClockStarted(false)
+		, clockStartTimestampUsec(0)
+		, clockStartTimeUsec(0)
+	{}
+
+	Playback::~Playback()
+	{
+		close();
+	}
+
+	bool Playback::open(const std::string& filePath)
+	{
+		return open(filePath, PlaybackSettings());
+	}
+
+	bool Playback::open(const std::string& filePath, PlaybackSettings settings)
+	{
+		if (this->bOpen)
+		{
+			ofLogWarning(__FUNCTION__) << "Playback " << this->filePath << " already open!";
+			return false;
+		}
+
+		try
+		{
+			// Open the recording and read its calibration and configuration.
+			this->playback = k4a::playback::open(filePath.c_str());
+			this->calibration = this->playback.get_calibration();
+			this->recordConfig = this->playback.get_record_configuration();
+		}
+		catch (const k4a::error& e)
+		{
+			ofLogError(__FUNCTION__) << e.what();
+
+			this->playback.close();
+
+			return false;
+		}
+
+		this->config = K4A_DEVICE_CONFIG_INIT_DISABLE_ALL;
+		this->config.depth_mode = this->recordConfig.depth_mode;
+		this->config.color_format = this->recordConfig.color_format;
+		this->config.color_resolution = this->recordConfig.color_resolution;
+		this->config.camera_fps = this->recordConfig.camera_fps;
+		this->config.depth_delay_off_color_usec = this->recordConfig.depth_delay_off_color_usec;
+		this->config.wired_sync_mode = this->recordConfig.wired_sync_mode;
+		this->config.subordinate_delay_off_master_usec = this->recordConfig.subordinate_delay_off_master_usec;
+
+		if (this->recordConfig.color_track_enabled &&
+			this->config.color_format != K4A_IMAGE_FORMAT_COLOR_MJPG && this->config.color_format != K4A_IMAGE_FORMAT_COLOR_BGRA32)
+		{
+			// The pipeline only handles MJPG and BGRA, let the SDK convert anything else.
+			try
+			{
+				this->playback.set_color_conversion(K4A_IMAGE_FORMAT_COLOR_BGRA32);
+				this->config.color_format = K4A_IMAGE_FORMAT_COLOR_BGRA32;
+			}
+			catch (const k4a::error& e)
+			{
+				ofLogError(__FUNCTION__) << e.what();
+			}
+		}
+
+		this->filePath = filePath;
+		this->bRealtime = settings.realtime;
+		this->bLoop = settings.loop;
+		this->bOpen = true;
+
+		this->setupStream(settings);
+
+		// Only process the tracks stored in the file.
+		this->bUpdateColor = this->bUpdateColor && this->recordConfig.color_track_enabled;
+		this->bUpdateIr = this->bUpdateIr && this->recordConfig.ir_track_enabled;
+		if (!this->recordConfig.depth_track_enabled || !this->recordConfig.ir_track_enabled)
+		{
+			this->bUpdateBodies = false;
+			this->bUpdateBodyStats = false;
+			this->bUpdateBodyPointClouds = false;
+		}
+
+		ofLogNotice(__FUNCTION__) << "Successfully opened playback " << this->filePath << " with duration " << (this->getDurationUsec() / 1000000.0) << "s.";
+
+		return true;
+	}
+
+	bool Playback::close()
+	{
+		if (!this->bOpen) return false;
+
+		this->stopPlayback();
+
+		this->playback.close();
+
+		this->bOpen = false;
+		this->filePath = "";
+
+		return true;
+	}
+
+	bool Playback::startPlayback()
+	{
+		if (!this->bOpen)
+		{
+			ofLogError(__FUNCTION__) << "Open playback before starting!";
+			return false;
+		}
+
+		this->bFinished = false;
+		this->bClockStarted = false;
+
+		return this->startStreaming();
+	}
+
+	bool Playback::stopPlayback()
+	{
+		this->pendingCapture.reset();
+
+		return this->stopStreaming();
+	}
+
+	bool Playback::seek(uint64_t offsetUsec)
+	{
+		if (!this->bOpen) return false;
+
+		try
+		{
+			this->playback.seek_timestamp(std::chrono::microseconds(offsetUsec), K4A_PLAYBACK_SEEK_BEGIN);
+		}
+		catch (const k4a::error& e)
+		{
+			ofLogError(__FUNCTION__) << e.what();
+			return false;
+		}
+
+		this->pendingCapture.reset();
+		this->bFinished = false;
+		this->bRewound = true;
+		this->bClockStarted = false;
+
+		return true;
+	}
+
+	uint64_t Playback::getDurationUsec() const
+	{
+		return this->bOpen ? static_cast<uint64_t>(this->playback.get_recording_length().count()) : 0;
+	}
+
+	bool Playback::isFinished() const
+	{
+		return this->bFinished;
+	}
+
+	const std::string& Playback::getFilePath() const
+	{
+		return this->filePath;
+	}
+
+	const k4a_record_configuration_t& Playback::getRecordConfiguration() const
+	{
+		return this->recordConfig;
+	}
+
+	bool Playback::updateCapture()
+	{
+		if (!this->pendingCapture && !this->readCapture(this->pendingCapture))
+		{
+			return false;
+		}
+
+		if (!this->bRealtime)
+		{
+			this->takePendingCapture();
+			return true;
+		}
+
+		const uint64_t nowUsec = ofGetElapsedTimeMicros();
+		if (!this->bClockStarted)
+		{
+			// Line up the recording clock with the app clock at the first capture.
+			this->clockStartTimestampUsec = getCaptureTimestampUsec(this->pendingCapture);
+			this->clockStartTimeUsec = nowUsec;
+			this->bClockStarted = true;
+		}
+
+		if (!this->isDue(this->pendingCapture, nowUsec))
+		{
+			return false;
+		}
+
+		// Skip to the latest capture that is due, like a live device drops frames when the app falls behind.
+		this->takePendingCapture();
+		while (this->readCapture(this->pendingCapture) && this->isDue(this->pendingCapture, nowUsec))
+		{
+			this->takePendingCapture();
+		}
+
+		return true;
+	}
+
+	bool Playback::readCapture(k4a::capture& nextCapture)
+	{
+		if (this->bFinished) return false;
+
+		try
+		{
+			if (this->playback.get_next_capture(&nextCapture))
+			{
+				return true;
+			}
+
+			if (this->bLoop)
+			{
+				// Rewind and restart the clock, the first capture is picked up on the next update.
+				this->playback.seek_timestamp(std::chrono::microseconds(0), K4A_PLAYBACK_SEEK_BEGIN);
+				this->bRewound = true;
+				this->bClockStarted = false;
+				return this->playback.get_next_capture(&nextCapture);
+			}
+		}
+		catch (const k4a::error& e)
+		{
+			ofLogError(__FUNCTION__) << e.what();
+		}
+
+		ofLogNotice(__FUNCTION__) << "Reached end of playback " << this->filePath << ".";
+		this->bFinished = true;
+		return false;
+	}
+
+	bool Playback::isDue(const k4a::capture& nextCapture, uint64_t nowUsec) const
+	{
+		if (!this->bClockStarted) return false;
+
+		const uint64_t timestampUsec = getCaptureTimestampUsec(nextCapture);
+		return timestampUsec <= this->clockStartTimestampUsec ||
+			timestampUsec - this->clockStartTimestampUsec <= nowUsec - this->clockStartTimeUsec;
+	}
+
+	void Playback::takePendingCapture()
+	{
+		if (this->bRewound)
+		{
+			// Timestamps jumped, drop state that relies on them following each other.
+			this->markDiscontinuity();
+			this->bRewound = false;
+		}
+
+		this->capture = this->pendingCapture;
+		this->pendingCapture.reset();
+	}
+}
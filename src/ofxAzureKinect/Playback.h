@@ -0,0 +1,75 @@
+#pragma once
+
+#include <k4arecord/playback.hpp>
+
+#include "Stream.h"
+
+namespace ofxAzureKinect
+{
+	struct PlaybackSettings
+		: StreamSettings
+	{
+		// Pace captures by their recorded timestamps, skipping any the app is too slow for.
+		// Otherwise every update reads the next capture, as fast as the pipeline runs.
+		bool realtime;
+
+		// Seek back to the start at the end of the file, otherwise the playback finishes.
+		bool loop;
+
+		PlaybackSettings();
+	};
+
+	// Reads captures from an Azure Kinect .mkv recording and runs them through the same pipeline
+	// as a live Device, using the calibration and camera configuration stored in the file.
+	class Playback
+		: public Stream
+	{
+	public:
+		Playback();
+		~Playback();
+
+		bool open(const std::string& filePath);
+		bool open(const std::string& filePath, PlaybackSettings settings);
+		bool close() override;
+
+		bool startPlayback();
+		bool stopPlayback();
+
+		// Offset from the start of the recording, in microseconds.
+		bool seek(uint64_t offsetUsec);
+
+		uint64_t getDurationUsec() const;
+
+		// True once the end of the file is reached without looping.
+		bool isFinished() const;
+
+		const std::string& getFilePath() const;
+		const k4a_record_configuration_t& getRecordConfiguration() const;
+
+	protected:
+		bool updateCapture() override;
+
+	private:
+		bool readCapture(k4a::capture& nextCapture);
+		bool isDue(const k4a::capture& nextCapture, uint64_t nowUsec) const;
+		void takePendingCapture();
+
+	private:
+		std::string filePath;
+
+		k4a::playback playback;
+		k4a_record_configuration_t recordConfig;
+
+		bool bRealtime;
+		bool bLoop;
+		bool bFinished;
+		bool bRewound;
+
+		// Next capture in the file, held until it is due in realtime mode.
+		k4a::capture pendingCapture;
+
+		bool bClockStarted;
+		uint64_t clockStartTimestampUsec;
+		uint64_t clockStartTimeUsec;
+	};
+}
@@ -0,0 +1,391 @@
+#include "PoseMatcher.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "ofLog.h"
+
+namespace ofxAzureKinect
+{
+	PoseMatcherSettings::PoseMatcherSettings()
+		: maxDistance(0.3f)
+		, weightByConfidence(true)
+		, lowConfidenceWeight(0.25f)
+		, maxGestureFrames(60)
+	{}
+
+	bool PoseMatcher::normalize(const k4abt_skeleton_t& skeleton, float* values)
+	{
+		const auto& root = skeleton.joints[K4ABT_JOINT_PELVIS].position.v;
+
+		float sumSq = 0.0f;
+		for (int j = 0; j < K4ABT_JOINT_COUNT; ++j)
+		{
+			const auto& p = skeleton.joints[j].position.v;
+			for (int c = 0; c < 3; ++c)
+			{
+				const float v = p[c] - root[c];
+				values[j * 3 + c] = v;
+				sumSq += v * v;
+			}
+		}
+
+		const float radius = std::sqrt(sumSq / K4ABT_JOINT_COUNT);
+		if (radius < 1.0f)
+		{
+			return false;
+		}
+
+		const float invRadius = 1.0f / radius;
+		for (int i = 0; i < NUM_VALUES; ++i)
+		{
+			values[i] *= invRadius;
+		}
+		return true;
+	}
+
+	PoseMatcher::PoseMatcher()
+		: bPoseDataDirty(false)
+	{}
+
+	PoseMatcher::~PoseMatcher()
+	{}
+
+	void PoseMatcher::setup(const PoseMatcherSettings& settings)
+	{
+		this->settings = settings;
+		this->settings.maxGestureFrames = std::max(this->settings.maxGestureFrames, size_t(2));
+	}
+
+	const PoseMatcherSettings& PoseMatcher::getSettings() const
+	{
+		return this->settings;
+	}
+
+	int PoseMatcher::addPose(const k4abt_skeleton_t& skeleton, const std::string& name)
+	{
+		const size_t offset = this->poseValues.size();
+		this->poseValues.resize(offset + NUM_VALUES);
+		if (!normalize(skeleton, this->poseValues.data() + offset))
+		{
+			ofLogError(__FUNCTION__) << "Degenerate skeleton, skipping pose " << name << "!";
+			this->poseValues.resize(offset);
+			return -1;
+		}
+
+		this->poseNames.push_back(name);
+		this->bPoseDataDirty = true;
+		return static_cast<int>(this->poseNames.size() - 1);
+	}
+
+	void PoseMatcher::clearPoses()
+	{
+		this->poseValues.clear();
+		this->poseNames.clear();
+		this->poseData.clear();
+		this->poseMatches.clear();
+		this->poseDistances.clear();
+		this->bPoseDataDirty = false;
+	}
+
+	size_t PoseMatcher::getNumPoses() const
+	{
+		return this->poseNames.size();
+	}
+
+	const std::string& PoseMatcher::getPoseName(size_t index) const
+	{
+		return this->poseNames[index];
+	}
+
+	int PoseMatcher::addGesture(const std::vector<k4abt_skeleton_t>& frames, const std::string& name)
+	{
+		if (frames.size() < 2)
+		{
+			ofLogError(__FUNCTION__) << "Gesture " << name << " needs at least 2 frames!";
+			return -1;
+		}
+
+		const size_t offset = this->gestureValues.size();
+		this->gestureValues.resize(offset + frames.size() * NUM_VALUES);
+		for (size_t i = 0; i < frames.size(); ++i)
+		{
+			if (!normalize(frames[i], this->gestureValues.data() + offset + i * NUM_VALUES))
+			{
+				ofLogError(__FUNCTION__) << "Degenerate skeleton in frame " << i << ", skipping gesture " << name << "!";
+				this->gestureValues.resize(offset);
+				return -1;
+			}
+		}
+
+		this->gestureOffsets.push_back(offset);
+		this->gestureLengths.push_back(frames.size());
+		this->gestureNames.push_back(name);
+		return static_cast<int>(this->gestureNames.size() - 1);
+	}
+
+	void PoseMatcher::clearGestures()
+	{
+		this->gestureValues.clear();
+		this->gestureOffsets.clear();
+		this->gestureLengths.clear();
+		this->gestureNames.clear();
+		this->gestureMatches.clear();
+	}
+
+	size_t PoseMatcher::getNumGestures() const
+	{
+		return this->gestureNames.size();
+	}
+
+	const std::string& PoseMatcher::getGestureName(size_t index) const
+	{
+		return this->gestureNames[index];
+	}
+
+	bool PoseMatcher::matchPoses(const std::vector<k4abt_skeleton_t>& skeletons, const std::vector<uint32_t>& ids)
+	{
+		this->poseMatches.resize(skeletons.size());
+		this->poseDistances.resize(skeletons.size() * this->getNumPoses());
+		if (skeletons.empty() || this->getNumPoses() == 0)
+		{
+			return false;
+		}
+
+		if (this->bPoseDataDirty)
+		{
+			this->rebuildPoseData();
+		}
+
+		const size_t numPoses = this->getNumPoses();
+		this->queryValues.resize(NUM_VALUES);
+		this->queryWeights.resize(NUM_VALUES);
+		float* query = this->queryValues.data();
+		float* weights = this->queryWeights.data();
+
+		for (size_t b = 0; b < skeletons.size(); ++b)
+		{
+			auto& match = this->poseMatches[b];
+			match.id = ids[b];
+			match.index = -1;
+			match.distance = std::numeric_limits<float>::max();
+
+			float* distances = this->poseDistances.data() + b * numPoses;
+			std::fill(distances, distances + numPoses, std::numeric_limits<float>::max());
+
+			if (!normalize(skeletons[b], query)) continue;
+
+			this->computeWeights(skeletons[b], weights);
+			float weightSum = 0.0f;
+			for (int i = 0; i < NUM_VALUES; ++i)
+			{
+				weightSum += weights[i];
+			}
+			if (weightSum <= 0.0f) continue;
+
+			// Accumulate one coordinate at a time over every template, the inner loop runs
+			// over contiguous template values.
+			std::fill(distances, distances + numPoses, 0.0f);
+			for (int i = 0; i < NUM_VALUES; ++i)
+			{
+				const float w = weights[i];
+				if (w == 0.0f) continue;
+
+				const float q = query[i];
+				const float* column = this->poseData.data() + i * numPoses;
+				for (size_t t = 0; t < numPoses; ++t)
+				{
+					const float d = column[t] - q;
+					distances[t] += w * d * d;
+				}
+			}
+
+			// RMS distance over the weighted joint coordinates.
+			const float invWeightSum = 3.0f / weightSum;
+			for (size_t t = 0; t < numPoses; ++t)
+			{
+				distances[t] = std::sqrt(distances[t] * invWeightSum);
+			}
+
+			const auto best = std::min_element(distances, distances + numPoses);
+			if (*best <= this->settings.maxDistance)
+			{
+				match.index = static_cast<int>(best - distances);
+			}
+			match.distance = *best;
+		}
+
+		return true;
+	}
+
+	bool PoseMatcher::matchGestures(const SkeletonHistory& history, const std::vector<uint32_t>& ids)
+	{
+		this->gestureMatches.resize(ids.size());
+		if (ids.empty() || this->getNumGestures() == 0)
+		{
+			return false;
+		}
+
+		for (size_t b = 0; b < ids.size(); ++b)
+		{
+			auto& match = this->gestureMatches[b];
+			match.id = ids[b];
+			match.index = -1;
+			match.distance = std::numeric_limits<float>::max();
+
+			// Collect the latest frames, oldest first.
+			const size_t numAvailable = std::min(history.getNumFrames(ids[b]), this->settings.maxGestureFrames);
+			this->queryValues.resize(numAvailable * NUM_VALUES);
+			this->queryWeights.resize(numAvailable * NUM_VALUES);
+			size_t numFrames = 0;
+			for (size_t age = numAvailable; age-- > 0;)
+			{
+				const k4abt_skeleton_t* skeleton = history.getSkeleton(ids[b], age);
+				float* query = this->queryValues.data() + numFrames * NUM_VALUES;
+				if (skeleton && normalize(*skeleton, query))
+				{
+					this->computeWeights(*skeleton, this->queryWeights.data() + numFrames * NUM_VALUES);
+					++numFrames;
+				}
+			}
+			if (numFrames < 2) continue;
+
+			for (size_t g = 0; g < this->getNumGestures(); ++g)
+			{
+				const float distance = this->matchGesture(this->gestureValues.data() + this->gestureOffsets[g], this->gestureLengths[g], numFrames);
+				if (distance < match.distance)
+				{
+					match.distance = distance;
+					match.index = static_cast<int>(g);
+				}
+			}
+
+			if (match.distance > this->settings.maxDistance)
+			{
+				match.index = -1;
+			}
+		}
+
+		return true;
+	}
+
+	const std::vector<PoseMatch>& PoseMatcher::getPoseMatches() const
+	{
+		return this->poseMatches;
+	}
+
+	const std::vector<PoseMatch>& PoseMatcher::getGestureMatches() const
+	{
+		return this->gestureMatches;
+	}
+
+	const std::vector<float>& PoseMatcher::getPoseDistances() const
+	{
+		return this->poseDistances;
+	}
+
+	void PoseMatcher::rebuildPoseData()
+	{
+		const size_t numPoses = this->getNumPoses();
+		this->poseData.resize(numPoses * NUM_VALUES);
+		for (size_t t = 0; t < numPoses; ++t)
+		{
+			const float* values = this->poseValues.data() + t * NUM_VALUES;
+			for (int i = 0; i < NUM_VALUES; ++i)
+			{
+				this->poseData[i * numPoses + t] = values[i];
+			}
+		}
+		this->bPoseDataDirty = false;
+	}
+
+	void PoseMatcher::computeWeights(const k4abt_skeleton_t& skeleton, float* weights) const
+	{
+		for (int j = 0; j < K4ABT_JOINT_COUNT; ++j)
+		{
+			float w = 1.0f;
+			if (this->settings.weightByConfidence)
+			{
+				const auto confidence = skeleton.joints[j].confidence_level;
+				w = (confidence == K4ABT_JOINT_CONFIDENCE_NONE) ? 0.0f :
+					(confidence == K4ABT_JOINT_CONFIDENCE_LOW) ? this->settings.lowConfidenceWeight : 1.0f;
+			}
+			weights[j * 3 + 0] = weights[j * 3 + 1] = weights[j * 3 + 2] = w;
+		}
+	}
+
+	float PoseMatcher::matchGesture(const float* gesture, size_t numGestureFrames, size_t numFrames)
+	{
+		// Frame to frame costs, gesture frames are rows and live frames are columns.
+		this->costs.resize(numGestureFrames * numFrames);
+		for (size_t j = 0; j < numFrames; ++j)
+		{
+			const float* query = this->queryValues.data() + j * NUM_VALUES;
+			const float* weights = this->queryWeights.data() + j * NUM_VALUES;
+
+			float weightSum = 0.0f;
+			for (int k = 0; k < NUM_VALUES; ++k)
+			{
+				weightSum += weights[k];
+			}
+			const float invWeightSum = (weightSum > 0.0f) ? 3.0f / weightSum : 0.0f;
+
+			for (size_t i = 0; i < numGestureFrames; ++i)
+			{
+				const float* values = gesture + i * NUM_VALUES;
+				float sum = 0.0f;
+				for (int k = 0; k < NUM_VALUES; ++k)
+				{
+					const float d = values[k] - query[k];
+					sum += weights[k] * d * d;
+				}
+				this->costs[i * numFrames + j] = (weightSum > 0.0f) ? std::sqrt(sum * invWeightSum) : std::numeric_limits<float>::max();
+			}
+		}
+
+		// Open-begin DTW, the gesture can start at any live frame but must end on the latest one.
+		// Only two rows are kept, and path lengths are tracked to return the mean cost along the path.
+		this->pathCosts.resize(numFrames * 2);
+		this->pathLengths.resize(numFrames * 2);
+		float* prevCosts = this->pathCosts.data();
+		float* currCosts = prevCosts + numFrames;
+		uint32_t* prevLengths = this->pathLengths.data();
+		uint32_t* currLengths = prevLengths + numFrames;
+
+		for (size_t j = 0; j < numFrames; ++j)
+		{
+			currCosts[j] = this->costs[j];
+			currLengths[j] = 1;
+		}
+
+		for (size_t i = 1; i < numGestureFrames; ++i)
+		{
+			std::swap(prevCosts, currCosts);
+			std::swap(prevLengths, currLengths);
+
+			const float* rowCosts = this->costs.data() + i * numFrames;
+			currCosts[0] = prevCosts[0] + rowCosts[0];
+			currLengths[0] = prevLengths[0] + 1;
+			for (size_t j = 1; j < numFrames; ++j)
+			{
+				float best = prevCosts[j - 1];
+				uint32_t length = prevLengths[j - 1];
+				if (prevCosts[j] < best)
+				{
+					best = prevCosts[j];
+					length = prevLengths[j];
+				}
+				if (currCosts[j - 1] < best)
+				{
+					best = currCosts[j - 1];
+					length = currLengths[j - 1];
+				}
+				currCosts[j] = best + rowCosts[j];
+				currLengths[j] = length + 1;
+			}
+		}
+
+		return currCosts[numFrames - 1] / currLengths[numFrames - 1];
+	}
+}
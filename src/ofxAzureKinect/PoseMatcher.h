@@ -0,0 +1,116 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <k4abttypes.h>
+
+#include "SkeletonHistory.h"
+
+namespace ofxAzureKinect
+{
+	struct PoseMatcherSettings
+	{
+		// Best matches further than this are reported as no match, in normalized skeleton units.
+		float maxDistance;
+
+		// Weight each live joint by its confidence level, joints out of range are ignored
+		// and low confidence (occluded, predicted) joints count for lowConfidenceWeight.
+		bool weightByConfidence;
+		float lowConfidenceWeight;
+
+		// Most recent history frames searched for gestures.
+		size_t maxGestureFrames;
+
+		PoseMatcherSettings();
+	};
+
+	struct PoseMatch
+	{
+		uint32_t id;
+
+		// Template index, or -1 if nothing is within maxDistance.
+		int index;
+		float distance;
+	};
+
+	// Matches live skeletons against a library of recorded poses and gestures.
+	// Skeletons are normalized to be relative to the pelvis and divided by their RMS joint
+	// radius, so matches are independent of where the body stands and how tall it is.
+	// Pose templates are stored transposed (one array per joint coordinate across all
+	// templates), so each body is compared against the whole library in flat loops.
+	// Gestures are matched with open-begin DTW over the latest frames in a SkeletonHistory.
+	class PoseMatcher
+	{
+	public:
+		// Values per normalized skeleton.
+		static const int NUM_VALUES = K4ABT_JOINT_COUNT * 3;
+
+		// Fills NUM_VALUES floats, returns false for degenerate skeletons.
+		static bool normalize(const k4abt_skeleton_t& skeleton, float* values);
+
+	public:
+		PoseMatcher();
+		~PoseMatcher();
+
+		void setup(const PoseMatcherSettings& settings);
+
+		const PoseMatcherSettings& getSettings() const;
+
+		// Returns the template index, or -1 if the skeleton could not be normalized.
+		int addPose(const k4abt_skeleton_t& skeleton, const std::string& name = "");
+		void clearPoses();
+
+		size_t getNumPoses() const;
+		const std::string& getPoseName(size_t index) const;
+
+		// Returns the template index, or -1 if any frame could not be normalized.
+		int addGesture(const std::vector<k4abt_skeleton_t>& frames, const std::string& name = "");
+		void clearGestures();
+
+		size_t getNumGestures() const;
+		const std::string& getGestureName(size_t index) const;
+
+		bool matchPoses(const std::vector<k4abt_skeleton_t>& skeletons, const std::vector<uint32_t>& ids);
+		bool matchGestures(const SkeletonHistory& history, const std::vector<uint32_t>& ids);
+
+		// Best match per body, in the same order as the IDs passed to the last match call.
+		const std::vector<PoseMatch>& getPoseMatches() const;
+		const std::vector<PoseMatch>& getGestureMatches() const;
+
+		// Distance to every template, packed as body * getNumPoses() + pose.
+		const std::vector<float>& getPoseDistances() const;
+
+	private:
+		void rebuildPoseData();
+		void computeWeights(const k4abt_skeleton_t& skeleton, float* weights) const;
+		float matchGesture(const float* gesture, size_t numGestureFrames, size_t numFrames);
+
+	private:
+		PoseMatcherSettings settings;
+
+		// One normalized skeleton after another, as added.
+		std::vector<float> poseValues;
+		std::vector<std::string> poseNames;
+
+		// poseValues transposed, value * numPoses + pose.
+		std::vector<float> poseData;
+		bool bPoseDataDirty;
+
+		std::vector<float> gestureValues;
+		std::vector<size_t> gestureOffsets;
+		std::vector<size_t> gestureLengths;
+		std::vector<std::string> gestureNames;
+
+		std::vector<PoseMatch> poseMatches;
+		std::vector<PoseMatch> gestureMatches;
+		std::vector<float> poseDistances;
+
+		// Scratch buffers.
+		std::vector<float> queryValues;
+		std::vector<float> queryWeights;
+		std::vector<float> costs;
+		std::vector<float> pathCosts;
+		std::vector<uint32_t> pathLengths;
+	};
+}
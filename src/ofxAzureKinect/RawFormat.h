@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include <k4a/k4atypes.h>
+#include <k4abttypes.h>
+
+namespace ofxAzureKinect
+{
+	// Native recording format, laid out so any frame can be mapped and read in place.
+	//
+	// [RawFileHeader][padding to dataOffset]
+	// [frame 0][frame 1]...[frame N-1]          fixed recordSize each, page aligned
+	// [frame index]                             N x uint64_t timestamps, in microseconds
+	// [k4a_calibration_t][depth LUT][color LUT] LUTs are k4a_float2_t per pixel
+	// [RawFileFooter]
+	//
+	// Each frame record starts with a RawFrameHeader, followed by the depth, IR, BGRA color,
+	// body index, body ID, skeleton and IMU sections at the offsets in RawFrameLayout.
+	// Missing images are zero filled and flagged off in the frame header.
+
+	const char RAW_FILE_MAGIC[8] = { 'O', 'F', 'X', 'K', '4', 'A', 'R', 'W' };
+	const uint32_t RAW_FILE_VERSION = 1;
+
+	// Alignment of the data section and every frame record, one page on common platforms.
+	const uint64_t RAW_RECORD_ALIGNMENT = 4096;
+
+	// Alignment of the sections inside a frame record.
+	const uint64_t RAW_SECTION_ALIGNMENT = 64;
+
+	enum RawFrameFlags
+	{
+		RAW_FRAME_DEPTH = 1 << 0,
+		RAW_FRAME_IR = 1 << 1,
+		RAW_FRAME_COLOR = 1 << 2,
+		RAW_FRAME_BODY_INDEX = 1 << 3,
+		RAW_FRAME_BODIES = 1 << 4
+	};
+
+	struct RawFileHeader
+	{
+		char magic[8];
+		uint32_t version;
+		uint32_t headerSize;
+
+		int32_t depthMode;
+		int32_t colorResolution;
+		int32_t cameraFps;
+
+		uint32_t depthWidth;
+		uint32_t depthHeight;
+		uint32_t irWidth;
+		uint32_t irHeight;
+		uint32_t colorWidth;
+		uint32_t colorHeight;
+		uint32_t bodyIndexWidth;
+		uint32_t bodyIndexHeight;
+
+		uint32_t maxBodies;
+		uint32_t maxImuSamples;
+
+		uint64_t recordSize;
+		uint64_t dataOffset;
+	};
+
+	struct RawFileFooter
+	{
+		uint64_t numFrames;
+		uint64_t indexOffset;
+		uint64_t calibrationOffset;
+		uint64_t calibrationSize;
+		uint64_t depthLutOffset;
+		uint64_t depthLutSize;
+		uint64_t colorLutOffset;
+		uint64_t colorLutSize;
+		char magic[8];
+	};
+
+	struct RawFrameHeader
+	{
+		uint64_t depthTimestampUsec;
+		uint64_t irTimestampUsec;
+		uint64_t colorTimestampUsec;
+		uint64_t bodyTimestampUsec;
+
+		uint32_t flags;
+		uint32_t numBodies;
+		uint32_t numImuSamples;
+		uint32_t reserved;
+	};
+
+	// Byte offsets of each section inside a frame record.
+	struct RawFrameLayout
+	{
+		uint64_t depthOffset;
+		uint64_t irOffset;
+		uint64_t colorOffset;
+		uint64_t bodyIndexOffset;
+		uint64_t bodyIDsOffset;
+		uint64_t skeletonsOffset;
+		uint64_t imuOffset;
+		uint64_t recordSize;
+	};
+
+	inline uint64_t alignRawOffset(uint64_t offset, uint64_t alignment)
+	{
+		return (offset + alignment - 1) / alignment * alignment;
+	}
+
+	inline RawFrameLayout computeRawFrameLayout(const RawFileHeader& header)
+	{
+		RawFrameLayout layout;
+		uint64_t offset = alignRawOffset(sizeof(RawFrameHeader), RAW_SECTION_ALIGNMENT);
+
+		layout.depthOffset = offset;
+		offset = alignRawOffset(offset + uint64_t(header.depthWidth) * header.depthHeight * sizeof(uint16_t), RAW_SECTION_ALIGNMENT);
+
+		layout.irOffset = offset;
+		offset = alignRawOffset(offset + uint64_t(header.irWidth) * header.irHeight * sizeof(uint16_t), RAW_SECTION_ALIGNMENT);
+
+		layout.colorOffset = offset;
+		offset = alignRawOffset(offset + uint64_t(header.colorWidth) * header.colorHeight * 4, RAW_SECTION_ALIGNMENT);
+
+		layout.bodyIndexOffset = offset;
+		offset = alignRawOffset(offset + uint64_t(header.bodyIndexWidth) * header.bodyIndexHeight, RAW_SECTION_ALIGNMENT);
+
+		layout.bodyIDsOffset = offset;
+		offset = alignRawOffset(offset + uint64_t(header.maxBodies) * sizeof(uint32_t), RAW_SECTION_ALIGNMENT);
+
+		layout.skeletonsOffset = offset;
+		offset = alignRawOffset(offset + uint64_t(header.maxBodies) * sizeof(k4abt_skeleton_t), RAW_SECTION_ALIGNMENT);
+
+		layout.imuOffset = offset;
+		offset += uint64_t(header.maxImuSamples) * sizeof(k4a_imu_sample_t);
+
+		layout.recordSize = alignRawOffset(offset, RAW_RECORD_ALIGNMENT);
+		return layout;
+	}
+}
@@ -0,0 +1,385 @@
+#include "RawPlayback.h"
+
+#include <algorithm>
+
+#include "ofLog.h"
+#include "ofUtils.h"
+
+namespace
+{
+	// Wraps a section of a mapped frame in a k4a::image, without copying.
+	k4a::image createMappedImage(k4a_image_format_t format, int width, int height, int bytesPerPixel, const void* data, uint64_t timestampUsec)
+	{
+		// The mapping is read-only, but nothing in the pipeline writes to capture buffers.
+		auto img = k4a::image::create_from_buffer(format,
+			width, height,
+			width * bytesPerPixel,
+			const_cast<uint8_t*>(static_cast<const uint8_t*>(data)),
+			static_cast<size_t>(width) * height * bytesPerPixel,
+			nullptr, nullptr);
+		img.set_timestamp(std::chrono::microseconds(timestampUsec));
+		return img;
+	}
+}
+
+namespace ofxAzureKinect
+{
+	RawPlaybackSettings::RawPlaybackSettings()
+		: realtime(true)
+		, loop(true)
+		, prefetchFrames(4)
+	{}
+
+	RawPlayback::RawPlayback()
+		: bRealtime(true)
+		, bLoop(true)
+		, bFinished(false)
+		, bRewound(false)
+		, frameIndex(0)
+		, nextFrameIndex(0)
+		, numPrefetchFrames(0)
+		, prefetchEndIndex(0)
+		, bClockStarted(false)
+		, clockStartTimestampUsec(0)
+		, clockStartTimeUsec(0)
+	{}
+
+	RawPlayback::~RawPlayback()
+	{
+		close();
+	}
+
+	bool RawPlayback::open(const std::string& filePath)
+	{
+		return open(filePath, RawPlaybackSettings());
+	}
+
+	bool RawPlayback::open(const std::string& filePath, RawPlaybackSettings settings)
+	{
+		if (this->bOpen)
+		{
+			ofLogWarning(__FUNCTION__) << "Playback " << this->reader.getFilePath() << " already open!";
+			return false;
+		}
+
+		if (!this->reader.open(filePath))
+		{
+			return false;
+		}
+
+		if (this->reader.getNumFrames() == 0)
+		{
+			ofLogError(__FUNCTION__) << "Playback " << filePath << " has no frames!";
+			this->reader.close();
+			return false;
+		}
+
+		const auto& header = this->reader.getHeader();
+		static_cast<k4a_calibration_t&>(this->calibration) = this->reader.getCalibration();
+
+		// Color is always stored decoded.
+		this->config = K4A_DEVICE_CONFIG_INIT_DISABLE_ALL;
+		this->config.depth_mode = static_cast<k4a_depth_mode_t>(header.depthMode);
+		this->config.color_format = K4A_IMAGE_FORMAT_COLOR_BGRA32;
+		this->config.color_resolution = (header.colorWidth > 0) ? static_cast<k4a_color_resolution_t>(header.colorResolution) : K4A_COLOR_RESOLUTION_OFF;
+		this->config.camera_fps = static_cast<k4a_fps_t>(header.cameraFps);
+
+		this->bRealtime = settings.realtime;
+		this->bLoop = settings.loop;
+		this->numPrefetchFrames = settings.prefetchFrames;
+		this->prefetchEndIndex = 0;
+		this->bOpen = true;
+
+		this->setupStream(settings);
+
+		// Only process the sections stored in the file.
+		this->bUpdateColor = this->bUpdateColor && header.colorWidth > 0;
+		this->bUpdateIr = this->bUpdateIr && header.irWidth > 0;
+		if (header.depthWidth == 0 || header.irWidth == 0)
+		{
+			this->bUpdateBodies = false;
+			this->bUpdateBodyStats = false;
+			this->bUpdateBodyPointClouds = false;
+		}
+
+		ofLogNotice(__FUNCTION__) << "Successfully opened raw playback " << filePath << " with duration " << (this->getDurationUsec() / 1000000.0) << "s.";
+
+		return true;
+	}
+
+	bool RawPlayback::close()
+	{
+		if (!this->bOpen) return false;
+
+		// Stop first, the tracker may still reference mapped frames.
+		this->stopPlayback();
+
+		this->recordedBodySkeletons.clear();
+		this->recordedBodyIDs.clear();
+		this->recordedBodyIndexPix.clear();
+
+		this->reader.close();
+		this->imuSamples.clear();
+
+		this->bOpen = false;
+
+		return true;
+	}
+
+	bool RawPlayback::startPlayback()
+	{
+		if (!this->bOpen)
+		{
+			ofLogError(__FUNCTION__) << "Open playback before starting!";
+			return false;
+		}
+
+		this->bFinished = false;
+		this->bClockStarted = false;
+
+		return this->startStreaming();
+	}
+
+	bool RawPlayback::stopPlayback()
+	{
+		return this->stopStreaming();
+	}
+
+	bool RawPlayback::seek(uint64_t offsetUsec)
+	{
+		if (!this->bOpen) return false;
+
+		return this->seekFrame(this->reader.findFrame(this->reader.getFrameTimestampUsec(0) + offsetUsec));
+	}
+
+	bool RawPlayback::seekFrame(size_t index)
+	{
+		if (!this->bOpen || index >= this->reader.getNumFrames()) return false;
+
+		this->nextFrameIndex = index;
+		this->bFinished = false;
+		this->bRewound = true;
+		this->bClockStarted = false;
+
+		// Seeks usually come in bursts while scrubbing, stop reading ahead until playback runs on.
+		this->reader.setSequentialAccess(false);
+		this->prefetchEndIndex = 0;
+
+		return true;
+	}
+
+	size_t RawPlayback::getNumFrames() const
+	{
+		return this->reader.getNumFrames();
+	}
+
+	size_t RawPlayback::getFrameIndex() const
+	{
+		return this->frameIndex;
+	}
+
+	uint64_t RawPlayback::getDurationUsec() const
+	{
+		const size_t numFrames = this->reader.getNumFrames();
+		if (numFrames == 0) return 0;
+
+		return this->reader.getFrameTimestampUsec(numFrames - 1) - this->reader.getFrameTimestampUsec(0);
+	}
+
+	bool RawPlayback::isFinished() const
+	{
+		return this->bFinished;
+	}
+
+	const std::string& RawPlayback::getFilePath() const
+	{
+		return this->reader.getFilePath();
+	}
+
+	const RawReader& RawPlayback::getReader() const
+	{
+		return this->reader;
+	}
+
+	const std::vector<k4abt_skeleton_t>& RawPlayback::getRecordedBodySkeletons() const
+	{
+		return this->recordedBodySkeletons;
+	}
+
+	const std::vector<uint32_t>& RawPlayback::getRecordedBodyIDs() const
+	{
+		return this->recordedBodyIDs;
+	}
+
+	const ofPixels& RawPlayback::getRecordedBodyIndexPix() const
+	{
+		return this->recordedBodyIndexPix;
+	}
+
+	bool RawPlayback::updateCapture()
+	{
+		if (this->bFinished) return false;
+
+		const size_t numFrames = this->reader.getNumFrames();
+		if (this->nextFrameIndex >= numFrames)
+		{
+			if (!this->bLoop)
+			{
+				ofLogNotice(__FUNCTION__) << "Reached end of playback " << this->reader.getFilePath() << ".";
+				this->bFinished = true;
+				return false;
+			}
+
+			// Rewind and restart the clock.
+			this->nextFrameIndex = 0;
+			this->prefetchEndIndex = 0;
+			this->bRewound = true;
+			this->bClockStarted = false;
+		}
+
+		size_t index = this->nextFrameIndex;
+		if (this->bRealtime)
+		{
+			const uint64_t nowUsec = ofGetElapsedTimeMicros();
+			if (!this->bClockStarted)
+			{
+				// Line up the recording clock with the app clock at the next frame.
+				this->clockStartTimestampUsec = this->reader.getFrameTimestampUsec(index);
+				this->clockStartTimeUsec = nowUsec;
+				this->bClockStarted = true;
+			}
+
+			const uint64_t targetTimestampUsec = this->clockStartTimestampUsec + (nowUsec - this->clockStartTimeUsec);
+			if (this->reader.getFrameTimestampUsec(index) > targetTimestampUsec)
+			{
+				return false;
+			}
+
+			// Jump straight to the latest frame that is due, like a live device drops frames when the app falls behind.
+			index = std::max(index, this->reader.findFrame(targetTimestampUsec));
+		}
+
+		if (this->bRewound)
+		{
+			// Timestamps jumped, drop state that relies on them following each other.
+			this->markDiscontinuity();
+			this->bRewound = false;
+		}
+
+		// Frames follow each other again after a seek, read ahead.
+		if (index == this->frameIndex + 1)
+		{
+			this->reader.setSequentialAccess(true);
+		}
+
+		if (!this->loadFrame(index))
+		{
+			return false;
+		}
+
+		this->frameIndex = index;
+		this->nextFrameIndex = index + 1;
+
+		return true;
+	}
+
+	bool RawPlayback::loadFrame(size_t index)
+	{
+		RawFrame frame;
+		if (!this->reader.getFrame(index, frame))
+		{
+			return false;
+		}
+
+		if (this->reader.isSequentialAccess())
+		{
+			// Keep the next few records on their way in, only asking for the ones not requested yet.
+			const size_t prefetchBeginIndex = std::max(index + 1, this->prefetchEndIndex);
+			const size_t prefetchEndIndex = index + 1 + this->numPrefetchFrames;
+			if (prefetchBeginIndex < prefetchEndIndex)
+			{
+				this->reader.prefetchFrames(prefetchBeginIndex, prefetchEndIndex - prefetchBeginIndex);
+				this->prefetchEndIndex = prefetchEndIndex;
+			}
+		}
+
+		const auto& header = this->reader.getHeader();
+		try
+		{
+			this->capture = k4a::capture::create();
+			if (frame.depthData)
+			{
+				this->capture.set_depth_image(createMappedImage(K4A_IMAGE_FORMAT_DEPTH16,
+					header.depthWidth, header.depthHeight, sizeof(uint16_t), frame.depthData, frame.header->depthTimestampUsec));
+			}
+			if (frame.irData)
+			{
+				this->capture.set_ir_image(createMappedImage(K4A_IMAGE_FORMAT_IR16,
+					header.irWidth, header.irHeight, sizeof(uint16_t), frame.irData, frame.header->irTimestampUsec));
+			}
+			if (frame.colorData)
+			{
+				this->capture.set_color_image(createMappedImage(K4A_IMAGE_FORMAT_COLOR_BGRA32,
+					header.colorWidth, header.colorHeight, 4, frame.colorData, frame.header->colorTimestampUsec));
+			}
+		}
+		catch (const k4a::error& e)
+		{
+			ofLogError(__FUNCTION__) << e.what();
+			this->capture.reset();
+			return false;
+		}
+
+		if (frame.header->flags & RAW_FRAME_BODIES)
+		{
+			this->recordedBodySkeletons.assign(frame.skeletons, frame.skeletons + frame.header->numBodies);
+			this->recordedBodyIDs.assign(frame.bodyIDs, frame.bodyIDs + frame.header->numBodies);
+		}
+		else
+		{
+			this->recordedBodySkeletons.clear();
+			this->recordedBodyIDs.clear();
+		}
+		if (frame.bodyIndexData)
+		{
+			// Like the capture images, the pixels wrap the read-only mapping and are never written to.
+			this->recordedBodyIndexPix.setFromExternalPixels(const_cast<uint8_t*>(frame.bodyIndexData), header.bodyIndexWidth, header.bodyIndexHeight, 1);
+		}
+		else
+		{
+			this->recordedBodyIndexPix.clear();
+		}
+		this->imuSamples.assign(frame.imuSamples, frame.imuSamples + frame.header->numImuSamples);
+
+		return true;
+	}
+
+	bool RawPlayback::setupImageToWorldTable(k4a_calibration_type_t type, k4a::image& img)
+	{
+		const auto& header = this->reader.getHeader();
+		const bool bDepth = (type == K4A_CALIBRATION_TYPE_DEPTH);
+		const k4a_float2_t* tableData = bDepth ? this->reader.getDepthToWorldData() : this->reader.getColorToWorldData();
+		const int width = bDepth ? header.depthWidth : header.colorWidth;
+		const int height = bDepth ? header.depthHeight : header.colorHeight;
+		if (!tableData)
+		{
+			return Stream::setupImageToWorldTable(type, img);
+		}
+
+		try
+		{
+			img = k4a::image::create(K4A_IMAGE_FORMAT_CUSTOM,
+				width, height,
+				width * static_cast<int>(sizeof(k4a_float2_t)));
+		}
+		catch (const k4a::error& e)
+		{
+			ofLogError(__FUNCTION__) << e.what();
+			return false;
+		}
+
+		std::memcpy(img.get_buffer(), tableData, static_cast<size_t>(width) * height * sizeof(k4a_float2_t));
+
+		return true;
+	}
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "RawReader.h"
+#include "Stream.h"
+
+namespace ofxAzureKinect
+{
+	struct RawPlaybackSettings
+		: StreamSettings
+	{
+		// Pace frames by their recorded timestamps, skipping any the app is too slow for.
+		// Otherwise every update shows the next frame, as fast as the pipeline runs.
+		bool realtime;
+
+		// Jump back to the first frame at the end of the file, otherwise the playback finishes.
+		bool loop;
+
+		// Frames read ahead of playback in the background. Each is a full record, about 45 MB with 2160P color.
+		size_t prefetchFrames;
+
+		RawPlaybackSettings();
+	};
+
+	// Plays back a file written with Stream::startRawRecording().
+	// The file is memory mapped and captures are built on top of the mapped frames without copying,
+	// so seeking to any frame is as cheap as reading the next one.
+	class RawPlayback
+		: public Stream
+	{
+	public:
+		RawPlayback();
+		~RawPlayback();
+
+		bool open(const std::string& filePath);
+		bool open(const std::string& filePath, RawPlaybackSettings settings);
+		bool close() override;
+
+		bool startPlayback();
+		bool stopPlayback();
+
+		// Offset from the first frame, in microseconds.
+		bool seek(uint64_t offsetUsec);
+		bool seekFrame(size_t index);
+
+		size_t getNumFrames() const;
+
+		// Index of the frame processed by the last update.
+		size_t getFrameIndex() const;
+
+		uint64_t getDurationUsec() const;
+
+		// True once the last frame is played without looping.
+		bool isFinished() const;
+
+		const std::string& getFilePath() const;
+		const RawReader& getReader() const;
+
+		// Bodies as tracked while recording, for the frame processed by the last update.
+		const std::vector<k4abt_skeleton_t>& getRecordedBodySkeletons() const;
+		const std::vector<uint32_t>& getRecordedBodyIDs() const;
+
+		// Body index map as segmented while recording, pointing into the mapped file.
+		// Unallocated when the frame has none.
+		const ofPixels& getRecordedBodyIndexPix() const;
+
+	protected:
+		bool updateCapture() override;
+
+		// Uses the tables stored in the file when they match the calibration.
+		bool setupImageToWorldTable(k4a_calibration_type_t type, k4a::image& img) override;
+
+	private:
+		bool loadFrame(size_t index);
+
+	private:
+		RawReader reader;
+
+		bool bRealtime;
+		bool bLoop;
+		bool bFinished;
+		bool bRewound;
+
+		size_t frameIndex;
+		size_t nextFrameIndex;
+
+		size_t numPrefetchFrames;
+		size_t prefetchEndIndex;
+
+		std::vector<k4abt_skeleton_t> recordedBodySkeletons;
+		std::vector<uint32_t> recordedBodyIDs;
+		ofPixels recordedBodyIndexPix;
+
+		bool bClockStarted;
+		uint64_t clockStartTimestampUsec;
+		uint64_t clockStartTimeUsec;
+	};
+}
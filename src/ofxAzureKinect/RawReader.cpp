@@ -0,0 +1,343 @@
+#include "RawReader.h"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "ofLog.h"
+
+namespace ofxAzureKinect
+{
+	RawFrame::RawFrame()
+		: header(nullptr)
+		, depthData(nullptr)
+		, irData(nullptr)
+		, colorData(nullptr)
+		, bodyIndexData(nullptr)
+		, bodyIDs(nullptr)
+		, skeletons(nullptr)
+		, imuSamples(nullptr)
+	{}
+
+	RawReader::RawReader()
+		: data(nullptr)
+		, size(0)
+		, bSequentialAccess(true)
+#ifdef _WIN32
+		, fileHandle(INVALID_HANDLE_VALUE)
+		, mappingHandle(nullptr)
+#else
+		, fileDescriptor(-1)
+#endif
+		, frameIndex(nullptr)
+	{}
+
+	RawReader::~RawReader()
+	{
+		close();
+	}
+
+	bool RawReader::open(const std::string& filePath)
+	{
+		if (this->isOpen())
+		{
+			ofLogWarning(__FUNCTION__) << "Reader already open on " << this->filePath << "!";
+			return false;
+		}
+
+		if (!this->map(filePath))
+		{
+			ofLogError(__FUNCTION__) << "Could not map " << filePath << "!";
+			return false;
+		}
+
+		bool bValid = this->size >= sizeof(RawFileHeader) + sizeof(RawFileFooter);
+		if (bValid)
+		{
+			std::memcpy(&this->header, this->data, sizeof(RawFileHeader));
+			std::memcpy(&this->footer, this->data + this->size - sizeof(RawFileFooter), sizeof(RawFileFooter));
+
+			// A missing footer means the recording was not closed properly.
+			bValid = std::memcmp(this->header.magic, RAW_FILE_MAGIC, sizeof(RAW_FILE_MAGIC)) == 0 &&
+				std::memcmp(this->footer.magic, RAW_FILE_MAGIC, sizeof(RAW_FILE_MAGIC)) == 0 &&
+				this->header.version == RAW_FILE_VERSION &&
+				this->header.headerSize == sizeof(RawFileHeader);
+		}
+		if (bValid)
+		{
+			this->layout = computeRawFrameLayout(this->header);
+			bValid = this->layout.recordSize == this->header.recordSize &&
+				this->header.dataOffset + this->footer.numFrames * this->header.recordSize <= this->footer.indexOffset &&
+				this->footer.indexOffset + this->footer.numFrames * sizeof(uint64_t) <= this->size &&
+				this->footer.calibrationSize == sizeof(k4a_calibration_t) &&
+				this->footer.calibrationOffset + this->footer.calibrationSize <= this->size &&
+				this->footer.depthLutOffset + this->footer.depthLutSize <= this->size &&
+				this->footer.colorLutOffset + this->footer.colorLutSize <= this->size;
+		}
+		if (!bValid)
+		{
+			ofLogError(__FUNCTION__) << filePath << " is not a valid raw recording!";
+			this->unmap();
+			return false;
+		}
+
+		std::memcpy(&this->calibration, this->data + this->footer.calibrationOffset, sizeof(k4a_calibration_t));
+		this->frameIndex = reinterpret_cast<const uint64_t*>(this->data + this->footer.indexOffset);
+		this->filePath = filePath;
+
+		ofLogNotice(__FUNCTION__) << "Opened " << this->filePath << " with " << this->footer.numFrames << " frames.";
+
+		return true;
+	}
+
+	bool RawReader::close()
+	{
+		if (!this->isOpen()) return false;
+
+		this->unmap();
+		this->frameIndex = nullptr;
+
+		return true;
+	}
+
+	bool RawReader::isOpen() const
+	{
+		return this->data != nullptr;
+	}
+
+	const std::string& RawReader::getFilePath() const
+	{
+		return this->filePath;
+	}
+
+	const RawFileHeader& RawReader::getHeader() const
+	{
+		return this->header;
+	}
+
+	const k4a_calibration_t& RawReader::getCalibration() const
+	{
+		return this->calibration;
+	}
+
+	const k4a_float2_t* RawReader::getDepthToWorldData() const
+	{
+		const uint64_t expectedSize = uint64_t(this->header.depthWidth) * this->header.depthHeight * sizeof(k4a_float2_t);
+		if (!this->isOpen() || this->footer.depthLutSize == 0 || this->footer.depthLutSize != expectedSize) return nullptr;
+
+		return reinterpret_cast<const k4a_float2_t*>(this->data + this->footer.depthLutOffset);
+	}
+
+	const k4a_float2_t* RawReader::getColorToWorldData() const
+	{
+		const uint64_t expectedSize = uint64_t(this->header.colorWidth) * this->header.colorHeight * sizeof(k4a_float2_t);
+		if (!this->isOpen() || this->footer.colorLutSize == 0 || this->footer.colorLutSize != expectedSize) return nullptr;
+
+		return reinterpret_cast<const k4a_float2_t*>(this->data + this->footer.colorLutOffset);
+	}
+
+	size_t RawReader::getNumFrames() const
+	{
+		return this->isOpen() ? static_cast<size_t>(this->footer.numFrames) : 0;
+	}
+
+	uint64_t RawReader::getFrameTimestampUsec(size_t index) const
+	{
+		if (index >= this->getNumFrames()) return 0;
+
+		return this->frameIndex[index];
+	}
+
+	size_t RawReader::findFrame(uint64_t timestampUsec) const
+	{
+		const size_t numFrames = this->getNumFrames();
+		if (numFrames == 0) return 0;
+
+		const auto it = std::upper_bound(this->frameIndex, this->frameIndex + numFrames, timestampUsec);
+		return (it == this->frameIndex) ? 0 : static_cast<size_t>(it - this->frameIndex) - 1;
+	}
+
+	bool RawReader::getFrame(size_t index, RawFrame& frame) const
+	{
+		if (index >= this->getNumFrames()) return false;
+
+		const uint8_t* record = this->data + this->header.dataOffset + index * this->header.recordSize;
+		frame.header = reinterpret_cast<const RawFrameHeader*>(record);
+
+		const uint32_t flags = frame.header->flags;
+		frame.depthData = (flags & RAW_FRAME_DEPTH) ? reinterpret_cast<const uint16_t*>(record + this->layout.depthOffset) : nullptr;
+		frame.irData = (flags & RAW_FRAME_IR) ? reinterpret_cast<const uint16_t*>(record + this->layout.irOffset) : nullptr;
+		frame.colorData = (flags & RAW_FRAME_COLOR) ? record + this->layout.colorOffset : nullptr;
+		frame.bodyIndexData = (flags & RAW_FRAME_BODY_INDEX) ? record + this->layout.bodyIndexOffset : nullptr;
+		frame.bodyIDs = reinterpret_cast<const uint32_t*>(record + this->layout.bodyIDsOffset);
+		frame.skeletons = reinterpret_cast<const k4abt_skeleton_t*>(record + this->layout.skeletonsOffset);
+		frame.imuSamples = reinterpret_cast<const k4a_imu_sample_t*>(record + this->layout.imuOffset);
+
+		return true;
+	}
+
+	void RawReader::setSequentialAccess(bool sequential)
+	{
+		if (!this->isOpen() || sequential == this->bSequentialAccess) return;
+
+		this->adviseAccess(sequential);
+		this->bSequentialAccess = sequential;
+	}
+
+	bool RawReader::isSequentialAccess() const
+	{
+		return this->bSequentialAccess;
+	}
+
+	void RawReader::prefetchFrames(size_t index, size_t count) const
+	{
+		const size_t numFrames = this->getNumFrames();
+		if (index >= numFrames || count == 0) return;
+
+		count = std::min(count, numFrames - index);
+		this->prefetch(this->header.dataOffset + index * this->header.recordSize, count * this->header.recordSize);
+	}
+
+#ifdef _WIN32
+	bool RawReader::map(const std::string& filePath)
+	{
+		HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE) return false;
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!mapping)
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (!view)
+		{
+			CloseHandle(mapping);
+			CloseHandle(file);
+			return false;
+		}
+
+		this->fileHandle = file;
+		this->mappingHandle = mapping;
+		this->data = static_cast<const uint8_t*>(view);
+		this->size = static_cast<uint64_t>(fileSize.QuadPart);
+		this->bSequentialAccess = true;
+
+		return true;
+	}
+
+	void RawReader::unmap()
+	{
+		if (this->data)
+		{
+			UnmapViewOfFile(this->data);
+			this->data = nullptr;
+		}
+		if (this->mappingHandle)
+		{
+			CloseHandle(this->mappingHandle);
+			this->mappingHandle = nullptr;
+		}
+		if (this->fileHandle != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(this->fileHandle);
+			this->fileHandle = INVALID_HANDLE_VALUE;
+		}
+		this->size = 0;
+	}
+
+	void RawReader::adviseAccess(bool sequential)
+	{
+		// Mapped views have no access hints, readahead only follows the file flags.
+	}
+
+	void RawReader::prefetch(uint64_t offset, uint64_t size) const
+	{
+		WIN32_MEMORY_RANGE_ENTRY range;
+		range.VirtualAddress = const_cast<uint8_t*>(this->data + offset);
+		range.NumberOfBytes = static_cast<SIZE_T>(std::min(size, this->size - offset));
+		PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+	}
+#else
+	bool RawReader::map(const std::string& filePath)
+	{
+		const int fd = ::open(filePath.c_str(), O_RDONLY);
+		if (fd < 0) return false;
+
+		struct stat fileStat;
+		if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0)
+		{
+			::close(fd);
+			return false;
+		}
+
+		void* view = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_SHARED, fd, 0);
+		if (view == MAP_FAILED)
+		{
+			::close(fd);
+			return false;
+		}
+
+		// Playback mostly reads frames in order, let the kernel read ahead.
+		madvise(view, static_cast<size_t>(fileStat.st_size), MADV_SEQUENTIAL);
+
+		this->fileDescriptor = fd;
+		this->data = static_cast<const uint8_t*>(view);
+		this->size = static_cast<uint64_t>(fileStat.st_size);
+		this->bSequentialAccess = true;
+
+		return true;
+	}
+
+	void RawReader::unmap()
+	{
+		if (this->data)
+		{
+			munmap(const_cast<uint8_t*>(this->data), static_cast<size_t>(this->size));
+			this->data = nullptr;
+		}
+		if (this->fileDescriptor >= 0)
+		{
+			::close(this->fileDescriptor);
+			this->fileDescriptor = -1;
+		}
+		this->size = 0;
+	}
+
+	void RawReader::adviseAccess(bool sequential)
+	{
+		madvise(const_cast<uint8_t*>(this->data), static_cast<size_t>(this->size), sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+	}
+
+	void RawReader::prefetch(uint64_t offset, uint64_t size) const
+	{
+		// madvise() needs a page aligned start.
+		const uint64_t pageSize = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+		const uint64_t alignedOffset = offset / pageSize * pageSize;
+		const uint64_t end = std::min(offset + size, this->size);
+		madvise(const_cast<uint8_t*>(this->data + alignedOffset), static_cast<size_t>(end - alignedOffset), MADV_WILLNEED);
+	}
+#endif
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <string>
+
+#include "RawFormat.h"
+
+namespace ofxAzureKinect
+{
+	// Pointers into a mapped frame record, null for sections flagged off in the frame header.
+	struct RawFrame
+	{
+		const RawFrameHeader* header;
+
+		const uint16_t* depthData;
+		const uint16_t* irData;
+		const uint8_t* colorData;
+		const uint8_t* bodyIndexData;
+
+		const uint32_t* bodyIDs;
+		const k4abt_skeleton_t* skeletons;
+		const k4a_imu_sample_t* imuSamples;
+
+		RawFrame();
+	};
+
+	// Maps a file written by RawRecorder into memory and gives random access to its frames.
+	// Nothing is copied, the returned pointers stay valid until the reader is closed.
+	class RawReader
+	{
+	public:
+		RawReader();
+		~RawReader();
+
+		bool open(const std::string& filePath);
+		bool close();
+
+		bool isOpen() const;
+
+		const std::string& getFilePath() const;
+
+		const RawFileHeader& getHeader() const;
+		const k4a_calibration_t& getCalibration() const;
+
+		// Unit plane rays per pixel, as computed by the recording stream. Null if the table was not recorded.
+		const k4a_float2_t* getDepthToWorldData() const;
+		const k4a_float2_t* getColorToWorldData() const;
+
+		size_t getNumFrames() const;
+
+		// Depth timestamp of the frame, or color if the frame has no depth.
+		uint64_t getFrameTimestampUsec(size_t index) const;
+
+		// Index of the last frame at or before the timestamp, 0 if all frames are later.
+		size_t findFrame(uint64_t timestampUsec) const;
+
+		bool getFrame(size_t index, RawFrame& frame) const;
+
+		// The mapping is read ahead by the OS for sequential playback, switch it off while
+		// scrubbing so jumps don't pull in pages that won't be used.
+		void setSequentialAccess(bool sequential);
+		bool isSequentialAccess() const;
+
+		// Asks the OS to start reading frames [index, index + count) in the background.
+		void prefetchFrames(size_t index, size_t count) const;
+
+	private:
+		bool map(const std::string& filePath);
+		void unmap();
+
+		void adviseAccess(bool sequential);
+		void prefetch(uint64_t offset, uint64_t size) const;
+
+	private:
+		std::string filePath;
+
+		const uint8_t* data;
+		uint64_t size;
+		bool bSequentialAccess;
+#ifdef _WIN32
+		void* fileHandle;
+		void* mappingHandle;
+#else
+		int fileDescriptor;
+#endif
+
+		RawFileHeader header;
+		RawFileFooter footer;
+		RawFrameLayout layout;
+		k4a_calibration_t calibration;
+		const uint64_t* frameIndex;
+	};
+}
@@ -0,0 +1,407 @@
+#include "RawRecorder.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "ofLog.h"
+
+#include "Stream.h"
+
+namespace
+{
+	// Copies a section into a frame record, and zero fills the rest of it up to the next section.
+	void copyRawSection(uint8_t* record, uint64_t offset, uint64_t endOffset, const void* data, uint64_t size)
+	{
+		if (size > 0)
+		{
+			std::memcpy(record + offset, data, size);
+		}
+		std::memset(record + offset + size, 0, endOffset - offset - size);
+	}
+}
+
+namespace ofxAzureKinect
+{
+	RawRecorderSettings::RawRecorderSettings()
+		: recordIr(true)
+		, recordColor(true)
+		, recordBodyIndex(true)
+		, maxBodies(8)
+		, maxImuSamples(512)
+		, frameQueueSize(8)
+	{}
+
+	RawRecorderStats::RawRecorderStats()
+		: numFrames(0)
+		, numFramesDropped(0)
+		, maxFrameQueueSize(0)
+	{}
+
+	RawRecorder::RawRecorder()
+		: file(nullptr)
+		, position(0)
+		, frameQueueSize(0)
+		, bRecording(false)
+		, bWriteFailed(false)
+	{}
+
+	RawRecorder::~RawRecorder()
+	{
+		close();
+	}
+
+	bool RawRecorder::open(const std::string& filePath, const Stream& stream, const RawRecorderSettings& settings)
+	{
+		if (this->isRecording())
+		{
+			ofLogWarning(__FUNCTION__) << "Recorder already writing to " << this->filePath << "!";
+			return false;
+		}
+
+		if (!stream.isStreaming())
+		{
+			ofLogError(__FUNCTION__) << "Start the stream before recording!";
+			return false;
+		}
+
+		this->file = std::fopen(filePath.c_str(), "wb");
+		if (!this->file)
+		{
+			ofLogError(__FUNCTION__) << "Could not open " << filePath << " for writing!";
+			return false;
+		}
+		this->filePath = filePath;
+		this->position = 0;
+		this->frameIndex.clear();
+
+		this->calibration = stream.getCalibration();
+		const auto& depthCamera = this->calibration.depth_camera_calibration;
+		const auto& colorCamera = this->calibration.color_camera_calibration;
+		const bool bHasDepth = this->calibration.depth_mode != K4A_DEPTH_MODE_OFF;
+		const bool bHasColor = settings.recordColor && this->calibration.color_resolution != K4A_COLOR_RESOLUTION_OFF;
+
+		std::memset(&this->header, 0, sizeof(RawFileHeader));
+		std::memcpy(this->header.magic, RAW_FILE_MAGIC, sizeof(RAW_FILE_MAGIC));
+		this->header.version = RAW_FILE_VERSION;
+		this->header.headerSize = sizeof(RawFileHeader);
+		this->header.depthMode = this->calibration.depth_mode;
+		this->header.colorResolution = this->calibration.color_resolution;
+		this->header.cameraFps = stream.getConfig().camera_fps;
+		if (bHasDepth)
+		{
+			this->header.depthWidth = depthCamera.resolution_width;
+			this->header.depthHeight = depthCamera.resolution_height;
+			if (settings.recordIr)
+			{
+				this->header.irWidth = depthCamera.resolution_width;
+				this->header.irHeight = depthCamera.resolution_height;
+			}
+			if (settings.recordBodyIndex)
+			{
+				this->header.bodyIndexWidth = depthCamera.resolution_width;
+				this->header.bodyIndexHeight = depthCamera.resolution_height;
+			}
+		}
+		if (bHasColor)
+		{
+			this->header.colorWidth = colorCamera.resolution_width;
+			this->header.colorHeight = colorCamera.resolution_height;
+		}
+		this->header.maxBodies = settings.maxBodies;
+		this->header.maxImuSamples = settings.maxImuSamples;
+
+		this->layout = computeRawFrameLayout(this->header);
+		this->header.recordSize = this->layout.recordSize;
+		this->header.dataOffset = alignRawOffset(sizeof(RawFileHeader), RAW_RECORD_ALIGNMENT);
+
+		// Keep the LUTs for the footer, they don't change while streaming.
+		const auto& depthToWorldPix = stream.getDepthToWorldPix();
+		const auto depthLutData = reinterpret_cast<const k4a_float2_t*>(depthToWorldPix.getData());
+		this->depthLut.assign(depthLutData, depthLutData + (depthToWorldPix.isAllocated() ? depthToWorldPix.getWidth() * depthToWorldPix.getHeight() : 0));
+		const auto& colorToWorldPix = stream.getColorToWorldPix();
+		const auto colorLutData = reinterpret_cast<const k4a_float2_t*>(colorToWorldPix.getData());
+		this->colorLut.assign(colorLutData, colorLutData + ((bHasColor && colorToWorldPix.isAllocated()) ? colorToWorldPix.getWidth() * colorToWorldPix.getHeight() : 0));
+
+		this->zeros.assign(RAW_RECORD_ALIGNMENT, 0);
+
+		if (!this->write(&this->header, sizeof(RawFileHeader)) || !this->seekForward(this->header.dataOffset))
+		{
+			ofLogError(__FUNCTION__) << "Failed writing header to " << this->filePath << "!";
+			std::fclose(this->file);
+			this->file = nullptr;
+			return false;
+		}
+
+		this->frameQueueSize = std::max<size_t>(settings.frameQueueSize, 1);
+		this->stats = RawRecorderStats();
+		this->bWriteFailed = false;
+		this->bRecording = true;
+
+		this->writerThread = std::thread(&RawRecorder::writeLoop, this);
+
+		ofLogNotice(__FUNCTION__) << "Started recording to " << this->filePath << ", " << this->header.recordSize << " bytes per frame.";
+
+		return true;
+	}
+
+	bool RawRecorder::close()
+	{
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			if (!this->bRecording) return false;
+
+			this->bRecording = false;
+		}
+		this->condition.notify_one();
+
+		// The writer thread drains the queue before exiting, unless a write failed.
+		this->writerThread.join();
+
+		this->frameQueue.clear();
+		this->freeRecords.clear();
+
+		RawFileFooter footer;
+		std::memset(&footer, 0, sizeof(RawFileFooter));
+		footer.numFrames = this->frameIndex.size();
+
+		bool bSuccess = true;
+		footer.indexOffset = this->position;
+		bSuccess = bSuccess && this->write(this->frameIndex.data(), this->frameIndex.size() * sizeof(uint64_t));
+
+		footer.calibrationOffset = alignRawOffset(this->position, RAW_SECTION_ALIGNMENT);
+		footer.calibrationSize = sizeof(k4a_calibration_t);
+		bSuccess = bSuccess && this->seekForward(footer.calibrationOffset) && this->write(&this->calibration, footer.calibrationSize);
+
+		footer.depthLutOffset = alignRawOffset(this->position, RAW_SECTION_ALIGNMENT);
+		footer.depthLutSize = this->depthLut.size() * sizeof(k4a_float2_t);
+		bSuccess = bSuccess && this->seekForward(footer.depthLutOffset) && this->write(this->depthLut.data(), footer.depthLutSize);
+
+		footer.colorLutOffset = alignRawOffset(this->position, RAW_SECTION_ALIGNMENT);
+		footer.colorLutSize = this->colorLut.size() * sizeof(k4a_float2_t);
+		bSuccess = bSuccess && this->seekForward(footer.colorLutOffset) && this->write(this->colorLut.data(), footer.colorLutSize);
+
+		std::memcpy(footer.magic, RAW_FILE_MAGIC, sizeof(RAW_FILE_MAGIC));
+		bSuccess = bSuccess && this->write(&footer, sizeof(RawFileFooter));
+
+		bSuccess = (std::fclose(this->file) == 0) && bSuccess;
+		this->file = nullptr;
+
+		if (!bSuccess)
+		{
+			ofLogError(__FUNCTION__) << "Failed finalizing " << this->filePath << "!";
+			return false;
+		}
+
+		ofLogNotice(__FUNCTION__) << "Finished recording " << footer.numFrames << " frames to " << this->filePath << " (" << this->stats.numFramesDropped << " dropped).";
+
+		return true;
+	}
+
+	bool RawRecorder::isRecording() const
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		return this->bRecording;
+	}
+
+	const std::string& RawRecorder::getFilePath() const
+	{
+		return this->filePath;
+	}
+
+	uint64_t RawRecorder::getNumFrames() const
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		return this->stats.numFrames;
+	}
+
+	RawRecorderStats RawRecorder::getStats() const
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		return this->stats;
+	}
+
+	bool RawRecorder::addFrame(const Stream& stream)
+	{
+		FrameRecord record;
+		bool bWriteFailed = false;
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			if (!this->bRecording) return false;
+
+			bWriteFailed = this->bWriteFailed;
+			if (!bWriteFailed)
+			{
+				if (this->frameQueue.size() >= this->frameQueueSize)
+				{
+					if (this->stats.numFramesDropped == 0)
+					{
+						ofLogWarning(__FUNCTION__) << "Writer is falling behind, dropping frames!";
+					}
+					++this->stats.numFramesDropped;
+					return false;
+				}
+
+				if (!this->freeRecords.empty())
+				{
+					record.data.swap(this->freeRecords.back());
+					this->freeRecords.pop_back();
+				}
+			}
+		}
+
+		if (bWriteFailed)
+		{
+			// Finalize with the frames written so far, the partial record is left out of the index.
+			ofLogError(__FUNCTION__) << "Failed writing frame to " << this->filePath << ", stopping!";
+			this->close();
+			return false;
+		}
+
+		RawFrameHeader frameHeader;
+		std::memset(&frameHeader, 0, sizeof(RawFrameHeader));
+		frameHeader.depthTimestampUsec = stream.getDepthTimestampUsec();
+		frameHeader.irTimestampUsec = stream.getIrTimestampUsec();
+		frameHeader.colorTimestampUsec = stream.getColorTimestampUsec();
+		frameHeader.bodyTimestampUsec = stream.getBodyTimestampUsec();
+
+		// Only sections that came in with this capture and match the header sizes are stored.
+		const auto& depthPix = stream.getDepthPix();
+		const bool bDepth = frameHeader.depthTimestampUsec != 0 && this->header.depthWidth > 0 &&
+			depthPix.getWidth() == this->header.depthWidth && depthPix.getHeight() == this->header.depthHeight;
+		const auto& irPix = stream.getIrPix();
+		const bool bIr = frameHeader.irTimestampUsec != 0 && this->header.irWidth > 0 &&
+			irPix.getWidth() == this->header.irWidth && irPix.getHeight() == this->header.irHeight;
+		const auto& colorPix = stream.getColorPix();
+		const bool bColor = frameHeader.colorTimestampUsec != 0 && this->header.colorWidth > 0 &&
+			colorPix.getWidth() == this->header.colorWidth && colorPix.getHeight() == this->header.colorHeight && colorPix.getNumChannels() == 4;
+		const auto& bodyIndexPix = stream.getBodyIndexPix();
+		const bool bBodyIndex = this->header.bodyIndexWidth > 0 &&
+			bodyIndexPix.getWidth() == this->header.bodyIndexWidth && bodyIndexPix.getHeight() == this->header.bodyIndexHeight;
+		const auto& skeletons = stream.getRawBodySkeletons();
+		const auto& bodyIDs = stream.getBodyIDs();
+		const auto& imuSamples = stream.getImuSamples();
+
+		frameHeader.flags = (bDepth ? RAW_FRAME_DEPTH : 0) | (bIr ? RAW_FRAME_IR : 0) | (bColor ? RAW_FRAME_COLOR : 0) |
+			(bBodyIndex ? RAW_FRAME_BODY_INDEX : 0) | (frameHeader.bodyTimestampUsec != 0 ? RAW_FRAME_BODIES : 0);
+		frameHeader.numBodies = static_cast<uint32_t>(std::min<size_t>(std::min(skeletons.size(), bodyIDs.size()), this->header.maxBodies));
+		frameHeader.numImuSamples = static_cast<uint32_t>(std::min<size_t>(imuSamples.size(), this->header.maxImuSamples));
+		if (frameHeader.numImuSamples < imuSamples.size())
+		{
+			ofLogWarning(__FUNCTION__) << "Dropping " << (imuSamples.size() - frameHeader.numImuSamples) << " IMU samples, increase maxImuSamples.";
+		}
+
+		const uint64_t depthSize = uint64_t(this->header.depthWidth) * this->header.depthHeight * sizeof(uint16_t);
+		const uint64_t irSize = uint64_t(this->header.irWidth) * this->header.irHeight * sizeof(uint16_t);
+		const uint64_t colorSize = uint64_t(this->header.colorWidth) * this->header.colorHeight * 4;
+		const uint64_t bodyIndexSize = uint64_t(this->header.bodyIndexWidth) * this->header.bodyIndexHeight;
+
+		// Sections are copied in order, skipped ones are zero filled up to the next offset.
+		record.data.resize(this->layout.recordSize);
+		uint8_t* data = record.data.data();
+		copyRawSection(data, 0, this->layout.depthOffset, &frameHeader, sizeof(RawFrameHeader));
+		copyRawSection(data, this->layout.depthOffset, this->layout.irOffset, depthPix.getData(), bDepth ? depthSize : 0);
+		copyRawSection(data, this->layout.irOffset, this->layout.colorOffset, irPix.getData(), bIr ? irSize : 0);
+		copyRawSection(data, this->layout.colorOffset, this->layout.bodyIndexOffset, colorPix.getData(), bColor ? colorSize : 0);
+		copyRawSection(data, this->layout.bodyIndexOffset, this->layout.bodyIDsOffset, bodyIndexPix.getData(), bBodyIndex ? bodyIndexSize : 0);
+		copyRawSection(data, this->layout.bodyIDsOffset, this->layout.skeletonsOffset, bodyIDs.data(), frameHeader.numBodies * sizeof(uint32_t));
+		copyRawSection(data, this->layout.skeletonsOffset, this->layout.imuOffset, skeletons.data(), frameHeader.numBodies * sizeof(k4abt_skeleton_t));
+		copyRawSection(data, this->layout.imuOffset, this->layout.recordSize, imuSamples.data(), frameHeader.numImuSamples * sizeof(k4a_imu_sample_t));
+
+		record.timestampUsec = bDepth ? frameHeader.depthTimestampUsec : bColor ? frameHeader.colorTimestampUsec : frameHeader.irTimestampUsec;
+
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			if (!this->bRecording) return false;
+
+			this->frameQueue.push_back(std::move(record));
+		}
+		this->condition.notify_one();
+
+		return true;
+	}
+
+	void RawRecorder::writeLoop()
+	{
+		std::deque<FrameRecord> records;
+
+		while (true)
+		{
+			{
+				// Grab everything queued so far, and write it without holding the lock.
+				std::unique_lock<std::mutex> lock(this->mutex);
+				this->condition.wait(lock, [this]
+				{
+					return !this->bRecording || !this->frameQueue.empty();
+				});
+
+				if (!this->bRecording && this->frameQueue.empty())
+				{
+					break;
+				}
+
+				this->stats.maxFrameQueueSize = std::max(this->stats.maxFrameQueueSize, this->frameQueue.size());
+
+				records.swap(this->frameQueue);
+			}
+
+			size_t numWritten = 0;
+			while (numWritten < records.size() && this->write(records[numWritten].data.data(), records[numWritten].data.size()))
+			{
+				++numWritten;
+			}
+			const bool bFailed = numWritten < records.size();
+
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->stats.numFrames += numWritten;
+			if (bFailed)
+			{
+				// Nothing else is written, the next addFrame() closes the file.
+				this->stats.numFramesDropped += (records.size() - numWritten) + this->frameQueue.size();
+				this->bWriteFailed = true;
+			}
+
+			for (size_t i = 0; i < records.size(); ++i)
+			{
+				if (i < numWritten)
+				{
+					this->frameIndex.push_back(records[i].timestampUsec);
+				}
+				if (this->freeRecords.size() < this->frameQueueSize)
+				{
+					this->freeRecords.push_back(std::move(records[i].data));
+				}
+			}
+			records.clear();
+
+			if (bFailed) break;
+		}
+	}
+
+	bool RawRecorder::write(const void* data, uint64_t size)
+	{
+		if (size == 0) return true;
+
+		// Count partial writes too, so the footer offsets still match the file after a failure.
+		const uint64_t numWritten = std::fwrite(data, 1, size, this->file);
+		this->position += numWritten;
+		return numWritten == size;
+	}
+
+	bool RawRecorder::writeZeros(uint64_t size)
+	{
+		while (size > 0)
+		{
+			const uint64_t chunk = std::min<uint64_t>(size, this->zeros.size());
+			if (!this->write(this->zeros.data(), chunk)) return false;
+			size -= chunk;
+		}
+		return true;
+	}
+
+	bool RawRecorder::seekForward(uint64_t offset)
+	{
+		if (offset < this->position) return false;
+
+		return this->writeZeros(offset - this->position);
+	}
+}
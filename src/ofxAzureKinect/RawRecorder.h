@@ -0,0 +1,117 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "RawFormat.h"
+
+namespace ofxAzureKinect
+{
+	class Stream;
+
+	struct RawRecorderSettings
+	{
+		bool recordIr;
+		bool recordColor;
+		bool recordBodyIndex;
+
+		// Room reserved in every frame record.
+		uint32_t maxBodies;
+		uint32_t maxImuSamples;
+
+		// Frames waiting for the writer thread, anything past this is dropped.
+		// Each one holds a full record in memory, about 45 MB with 2160P color.
+		size_t frameQueueSize;
+
+		RawRecorderSettings();
+	};
+
+	struct RawRecorderStats
+	{
+		uint64_t numFrames;
+		uint64_t numFramesDropped;
+
+		// Largest frame backlog seen by the writer thread.
+		size_t maxFrameQueueSize;
+
+		RawRecorderStats();
+	};
+
+	// Writes processed Stream frames to the native raw format, see RawFormat.h.
+	// Frames are copied into a record on the update thread and appended to the file on a dedicated
+	// thread, and the index, calibration and LUTs are written on close. Uncompressed frames add up
+	// to about 1 GB/s at 2160P and 30 fps, so when the disk can't keep up frames are dropped and
+	// counted instead of stalling the stream.
+	class RawRecorder
+	{
+	public:
+		RawRecorder();
+		~RawRecorder();
+
+		// The stream must be streaming, image sizes come from its calibration.
+		bool open(const std::string& filePath, const Stream& stream, const RawRecorderSettings& settings = RawRecorderSettings());
+
+		// Waits for the queue to drain, then finalizes the file.
+		bool close();
+
+		bool isRecording() const;
+
+		const std::string& getFilePath() const;
+
+		// Frames written to the file so far.
+		uint64_t getNumFrames() const;
+
+		RawRecorderStats getStats() const;
+
+		// Queues the stream's current images, bodies and IMU samples as one frame record.
+		// Closes the recorder if the writer thread failed.
+		bool addFrame(const Stream& stream);
+
+	private:
+		struct FrameRecord
+		{
+			uint64_t timestampUsec;
+			std::vector<uint8_t> data;
+		};
+
+		void writeLoop();
+
+		bool write(const void* data, uint64_t size);
+		bool writeZeros(uint64_t size);
+		bool seekForward(uint64_t offset);
+
+	private:
+		std::string filePath;
+		FILE* file;
+		uint64_t position;
+		size_t frameQueueSize;
+
+		std::thread writerThread;
+		mutable std::mutex mutex;
+		std::condition_variable condition;
+		bool bRecording;
+		bool bWriteFailed;
+
+		std::deque<FrameRecord> frameQueue;
+
+		// Written records are kept for reuse, so frames don't allocate once the queue is warm.
+		std::vector<std::vector<uint8_t>> freeRecords;
+
+		RawRecorderStats stats;
+
+		RawFileHeader header;
+		RawFrameLayout layout;
+
+		k4a_calibration_t calibration;
+		std::vector<k4a_float2_t> depthLut;
+		std::vector<k4a_float2_t> colorLut;
+
+		std::vector<uint64_t> frameIndex;
+		std::vector<uint8_t> zeros;
+	};
+}
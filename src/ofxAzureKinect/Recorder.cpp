@@ -0,0 +1,277 @@
+#include "Recorder.h"
+
+#include <cstring>
+
+#include "ofLog.h"
+
+namespace ofxAzureKinect
+{
+	const char* Recorder::BODY_TRACK_NAME = "BODY";
+	const char* Recorder::BODY_TRACK_CODEC = "S_K4A/BODY";
+
+	RecorderSettings::RecorderSettings()
+		: captureQueueSize(30)
+		, imuQueueSize(2000)
+		, bodyQueueSize(30)
+		, recordImu(false)
+		, recordBodies(false)
+	{}
+
+	RecorderStats::RecorderStats()
+		: numCaptures(0)
+		, numCapturesDropped(0)
+		, numImuSamples(0)
+		, numImuSamplesDropped(0)
+		, numBodyFrames(0)
+		, numBodyFramesDropped(0)
+		, numWriteErrors(0)
+		, maxCaptureQueueSize(0)
+	{}
+
+	Recorder::Recorder()
+		: recording(nullptr)
+		, bRecording(false)
+	{}
+
+	Recorder::~Recorder()
+	{
+		close();
+	}
+
+	bool Recorder::open(const std::string& filePath, k4a_device_t device, const k4a_device_configuration_t& config, const RecorderSettings& settings)
+	{
+		if (this->isRecording())
+		{
+			ofLogWarning(__FUNCTION__) << "Recorder already writing to " << this->filePath << "!";
+			return false;
+		}
+
+		if (K4A_FAILED(k4a_record_create(filePath.c_str(), device, config, &this->recording)))
+		{
+			ofLogError(__FUNCTION__) << "Failed to create recording " << filePath << "!";
+			this->recording = nullptr;
+			return false;
+		}
+
+		// Tracks must all be added before the header is written.
+		bool bSuccess = true;
+		if (settings.recordImu)
+		{
+			bSuccess = bSuccess && K4A_SUCCEEDED(k4a_record_add_imu_track(this->recording));
+		}
+		if (settings.recordBodies)
+		{
+			k4a_record_subtitle_settings_t subtitleSettings;
+			subtitleSettings.high_freq_data = false;
+			bSuccess = bSuccess && K4A_SUCCEEDED(k4a_record_add_custom_subtitle_track(this->recording, BODY_TRACK_NAME, BODY_TRACK_CODEC, nullptr, 0, &subtitleSettings));
+		}
+		bSuccess = bSuccess && K4A_SUCCEEDED(k4a_record_write_header(this->recording));
+		if (!bSuccess)
+		{
+			ofLogError(__FUNCTION__) << "Failed to set up tracks for recording " << filePath << "!";
+			k4a_record_close(this->recording);
+			this->recording = nullptr;
+			return false;
+		}
+
+		this->filePath = filePath;
+		this->settings = settings;
+		this->stats = RecorderStats();
+		this->bRecording = true;
+
+		this->writerThread = std::thread(&Recorder::writeLoop, this);
+
+		ofLogNotice(__FUNCTION__) << "Started recording to " << this->filePath << ".";
+
+		return true;
+	}
+
+	bool Recorder::close()
+	{
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			if (!this->bRecording) return false;
+
+			this->bRecording = false;
+		}
+		this->condition.notify_one();
+
+		// The writer thread drains the queues before exiting.
+		this->writerThread.join();
+
+		k4a_record_flush(this->recording);
+		k4a_record_close(this->recording);
+		this->recording = nullptr;
+
+		const auto finalStats = this->getStats();
+		ofLogNotice(__FUNCTION__) << "Finished recording to " << this->filePath << ", wrote "
+			<< finalStats.numCaptures << " captures (" << finalStats.numCapturesDropped << " dropped), "
+			<< finalStats.numImuSamples << " IMU samples (" << finalStats.numImuSamplesDropped << " dropped), "
+			<< finalStats.numBodyFrames << " body frames (" << finalStats.numBodyFramesDropped << " dropped).";
+
+		return true;
+	}
+
+	bool Recorder::isRecording() const
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		return this->bRecording;
+	}
+
+	const std::string& Recorder::getFilePath() const
+	{
+		return this->filePath;
+	}
+
+	const RecorderSettings& Recorder::getSettings() const
+	{
+		return this->settings;
+	}
+
+	RecorderStats Recorder::getStats() const
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		return this->stats;
+	}
+
+	bool Recorder::addCapture(const k4a::capture& capture)
+	{
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			if (!this->bRecording) return false;
+
+			if (this->captureQueue.size() >= this->settings.captureQueueSize)
+			{
+				if (this->stats.numCapturesDropped == 0)
+				{
+					ofLogWarning(__FUNCTION__) << "Writer is falling behind, dropping captures!";
+				}
+				++this->stats.numCapturesDropped;
+				return false;
+			}
+
+			// Only adds a reference, the image buffers are shared with the capture path.
+			this->captureQueue.push_back(capture);
+		}
+		this->condition.notify_one();
+
+		return true;
+	}
+
+	bool Recorder::addImuSample(const k4a_imu_sample_t& sample)
+	{
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			if (!this->bRecording || !this->settings.recordImu) return false;
+
+			if (this->imuQueue.size() >= this->settings.imuQueueSize)
+			{
+				++this->stats.numImuSamplesDropped;
+				return false;
+			}
+
+			this->imuQueue.push_back(sample);
+		}
+		this->condition.notify_one();
+
+		return true;
+	}
+
+	bool Recorder::addBodyFrame(uint64_t timestampUsec, const std::vector<k4abt_skeleton_t>& skeletons, const std::vector<uint32_t>& ids)
+	{
+		BodyFrame frame;
+		frame.timestampUsec = timestampUsec;
+
+		const uint32_t numBodies = static_cast<uint32_t>(skeletons.size());
+		const size_t bodySize = sizeof(uint32_t) + sizeof(k4abt_skeleton_t);
+		frame.data.resize(sizeof(uint32_t) + numBodies * bodySize);
+		uint8_t* dst = frame.data.data();
+		std::memcpy(dst, &numBodies, sizeof(uint32_t));
+		dst += sizeof(uint32_t);
+		for (uint32_t i = 0; i < numBodies; ++i)
+		{
+			std::memcpy(dst, &ids[i], sizeof(uint32_t));
+			std::memcpy(dst + sizeof(uint32_t), &skeletons[i], sizeof(k4abt_skeleton_t));
+			dst += bodySize;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			if (!this->bRecording || !this->settings.recordBodies) return false;
+
+			if (this->bodyQueue.size() >= this->settings.bodyQueueSize)
+			{
+				++this->stats.numBodyFramesDropped;
+				return false;
+			}
+
+			this->bodyQueue.push_back(std::move(frame));
+		}
+		this->condition.notify_one();
+
+		return true;
+	}
+
+	void Recorder::writeLoop()
+	{
+		std::deque<k4a::capture> captures;
+		std::deque<k4a_imu_sample_t> imuSamples;
+		std::deque<BodyFrame> bodyFrames;
+
+		while (true)
+		{
+			{
+				// Grab everything queued so far, and write it without holding the lock.
+				std::unique_lock<std::mutex> lock(this->mutex);
+				this->condition.wait(lock, [this]
+				{
+					return !this->bRecording || !this->captureQueue.empty() || !this->imuQueue.empty() || !this->bodyQueue.empty();
+				});
+
+				if (!this->bRecording && this->captureQueue.empty() && this->imuQueue.empty() && this->bodyQueue.empty())
+				{
+					break;
+				}
+
+				this->stats.maxCaptureQueueSize = std::max(this->stats.maxCaptureQueueSize, this->captureQueue.size());
+
+				captures.swap(this->captureQueue);
+				imuSamples.swap(this->imuQueue);
+				bodyFrames.swap(this->bodyQueue);
+			}
+
+			uint64_t numCaptures = 0, numImuSamples = 0, numBodyFrames = 0, numErrors = 0;
+			for (auto& capture : captures)
+			{
+				if (K4A_SUCCEEDED(k4a_record_write_capture(this->recording, capture.handle()))) ++numCaptures;
+				else ++numErrors;
+			}
+			for (const auto& sample : imuSamples)
+			{
+				if (K4A_SUCCEEDED(k4a_record_write_imu_sample(this->recording, sample))) ++numImuSamples;
+				else ++numErrors;
+			}
+			for (auto& frame : bodyFrames)
+			{
+				if (K4A_SUCCEEDED(k4a_record_write_custom_track_data(this->recording, BODY_TRACK_NAME, frame.timestampUsec, frame.data.data(), frame.data.size()))) ++numBodyFrames;
+				else ++numErrors;
+			}
+
+			// Releases the capture references.
+			captures.clear();
+			imuSamples.clear();
+			bodyFrames.clear();
+
+			if (numErrors > 0)
+			{
+				ofLogError(__FUNCTION__) << "Failed writing " << numErrors << " items to " << this->filePath << "!";
+			}
+
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->stats.numCaptures += numCaptures;
+			this->stats.numImuSamples += numImuSamples;
+			this->stats.numBodyFrames += numBodyFrames;
+			this->stats.numWriteErrors += numErrors;
+		}
+	}
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <k4a/k4a.hpp>
+#include <k4abttypes.h>
+#include <k4arecord/record.h>
+
+namespace ofxAzureKinect
+{
+	struct RecorderSettings
+	{
+		// Items waiting for the writer thread, anything past this is dropped.
+		size_t captureQueueSize;
+		size_t imuQueueSize;
+		size_t bodyQueueSize;
+
+		// IMU samples need DeviceSettings::updateImu.
+		bool recordImu;
+
+		// Raw skeletons and IDs of every body frame, in a custom "BODY" track.
+		bool recordBodies;
+
+		RecorderSettings();
+	};
+
+	struct RecorderStats
+	{
+		uint64_t numCaptures;
+		uint64_t numCapturesDropped;
+		uint64_t numImuSamples;
+		uint64_t numImuSamplesDropped;
+		uint64_t numBodyFrames;
+		uint64_t numBodyFramesDropped;
+		uint64_t numWriteErrors;
+
+		// Largest capture backlog seen by the writer thread.
+		size_t maxCaptureQueueSize;
+
+		RecorderStats();
+	};
+
+	// Writes captures to an Azure Kinect .mkv file on a dedicated thread.
+	// Captures are queued by reference, so nothing is copied on the capture path, and items
+	// that don't fit in the bounded queues are dropped and counted instead of blocking.
+	class Recorder
+	{
+	public:
+		// Custom track holding body frames, each block is a uint32_t body count followed by
+		// a uint32_t ID and a k4abt_skeleton_t per body.
+		static const char* BODY_TRACK_NAME;
+		static const char* BODY_TRACK_CODEC;
+
+	public:
+		Recorder();
+		~Recorder();
+
+		// The device handle is only used to store its calibration and serial number, it can be null.
+		bool open(const std::string& filePath, k4a_device_t device, const k4a_device_configuration_t& config, const RecorderSettings& settings = RecorderSettings());
+
+		// Waits for the queues to drain, then finalizes the file.
+		bool close();
+
+		bool isRecording() const;
+
+		const std::string& getFilePath() const;
+		const RecorderSettings& getSettings() const;
+
+		RecorderStats getStats() const;
+
+		bool addCapture(const k4a::capture& capture);
+		bool addImuSample(const k4a_imu_sample_t& sample);
+		bool addBodyFrame(uint64_t timestampUsec, const std::vector<k4abt_skeleton_t>& skeletons, const std::vector<uint32_t>& ids);
+
+	private:
+		struct BodyFrame
+		{
+			uint64_t timestampUsec;
+			std::vector<uint8_t> data;
+		};
+
+		void writeLoop();
+
+	private:
+		std::string filePath;
+		RecorderSettings settings;
+
+		k4a_record_t recording;
+
+		std::thread writerThread;
+		mutable std::mutex mutex;
+		std::condition_variable condition;
+		bool bRecording;
+
+		std::deque<k4a::capture> captureQueue;
+		std::deque<k4a_imu_sample_t> imuQueue;
+		std::deque<BodyFrame> bodyQueue;
+
+		RecorderStats stats;
+	};
+}
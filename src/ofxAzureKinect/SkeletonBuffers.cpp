@@ -0,0 +1,190 @@
+#include "SkeletonBuffers.h"
+
+namespace ofxAzureKinect
+{
+	const std::vector<ofIndexType>& SkeletonBuffers::getBoneIndices()
+	{
+		static const std::vector<ofIndexType> boneIndices = {
+			// Spine.
+			K4ABT_JOINT_PELVIS, K4ABT_JOINT_SPINE_NAVAL,
+			K4ABT_JOINT_SPINE_NAVAL, K4ABT_JOINT_SPINE_CHEST,
+			K4ABT_JOINT_SPINE_CHEST, K4ABT_JOINT_NECK,
+			K4ABT_JOINT_NECK, K4ABT_JOINT_HEAD,
+
+			// Head.
+			K4ABT_JOINT_HEAD, K4ABT_JOINT_NOSE,
+			K4ABT_JOINT_NOSE, K4ABT_JOINT_EYE_LEFT,
+			K4ABT_JOINT_EYE_LEFT, K4ABT_JOINT_EAR_LEFT,
+			K4ABT_JOINT_NOSE, K4ABT_JOINT_EYE_RIGHT,
+			K4ABT_JOINT_EYE_RIGHT, K4ABT_JOINT_EAR_RIGHT,
+
+			// Left leg.
+			K4ABT_JOINT_PELVIS, K4ABT_JOINT_HIP_LEFT,
+			K4ABT_JOINT_HIP_LEFT, K4ABT_JOINT_KNEE_LEFT,
+			K4ABT_JOINT_KNEE_LEFT, K4ABT_JOINT_ANKLE_LEFT,
+			K4ABT_JOINT_ANKLE_LEFT, K4ABT_JOINT_FOOT_LEFT,
+
+			// Right leg.
+			K4ABT_JOINT_PELVIS, K4ABT_JOINT_HIP_RIGHT,
+			K4ABT_JOINT_HIP_RIGHT, K4ABT_JOINT_KNEE_RIGHT,
+			K4ABT_JOINT_KNEE_RIGHT, K4ABT_JOINT_ANKLE_RIGHT,
+			K4ABT_JOINT_ANKLE_RIGHT, K4ABT_JOINT_FOOT_RIGHT,
+
+			// Left arm.
+			K4ABT_JOINT_NECK, K4ABT_JOINT_CLAVICLE_LEFT,
+			K4ABT_JOINT_CLAVICLE_LEFT, K4ABT_JOINT_SHOULDER_LEFT,
+			K4ABT_JOINT_SHOULDER_LEFT, K4ABT_JOINT_ELBOW_LEFT,
+			K4ABT_JOINT_ELBOW_LEFT, K4ABT_JOINT_WRIST_LEFT,
+
+			// Right arm.
+			K4ABT_JOINT_NECK, K4ABT_JOINT_CLAVICLE_RIGHT,
+			K4ABT_JOINT_CLAVICLE_RIGHT, K4ABT_JOINT_SHOULDER_RIGHT,
+			K4ABT_JOINT_SHOULDER_RIGHT, K4ABT_JOINT_ELBOW_RIGHT,
+			K4ABT_JOINT_ELBOW_RIGHT, K4ABT_JOINT_WRIST_RIGHT
+		};
+		return boneIndices;
+	}
+
+	SkeletonBuffers::SkeletonBuffers()
+		: numBodies(0)
+		, numIndexedBodies(0)
+	{}
+
+	SkeletonBuffers::~SkeletonBuffers()
+	{}
+
+	void SkeletonBuffers::update(const std::vector<k4abt_skeleton_t>& skeletons, bool upload)
+	{
+		this->numBodies = skeletons.size();
+
+		const size_t numJoints = this->getNumJoints();
+		this->positions.resize(numJoints);
+		this->transforms.resize(numJoints);
+		this->confidences.resize(numJoints);
+
+		const float confidenceScale = 1.0f / K4ABT_JOINT_CONFIDENCE_HIGH;
+		for (size_t b = 0; b < this->numBodies; ++b)
+		{
+			for (int j = 0; j < K4ABT_JOINT_COUNT; ++j)
+			{
+				const size_t i = b * K4ABT_JOINT_COUNT + j;
+				const auto& joint = skeletons[b].joints[j];
+				const auto& p = joint.position.v;
+				const auto& q = joint.orientation.v;
+
+				this->positions[i] = glm::vec3(p[0], p[1], p[2]);
+
+				// Rotation from the (w, x, y, z) quaternion with the translation in the last column.
+				const float w = q[0], x = q[1], y = q[2], z = q[3];
+				auto& m = this->transforms[i];
+				m[0] = glm::vec4(1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + w * z), 2.0f * (x * z - w * y), 0.0f);
+				m[1] = glm::vec4(2.0f * (x * y - w * z), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + w * x), 0.0f);
+				m[2] = glm::vec4(2.0f * (x * z + w * y), 2.0f * (y * z - w * x), 1.0f - 2.0f * (x * x + y * y), 0.0f);
+				m[3] = glm::vec4(p[0], p[1], p[2], 1.0f);
+
+				this->confidences[i] = joint.confidence_level * confidenceScale;
+			}
+		}
+
+		if (numJoints == 0 || !upload) return;
+
+		this->updateIndices(this->numBodies);
+
+		this->vbo.setVertexData(this->positions.data(), static_cast<int>(numJoints), GL_STREAM_DRAW);
+		this->transformBuffer.setData(this->transforms, GL_STREAM_DRAW);
+		if (!this->transformTex.isAllocated())
+		{
+			// The texture follows the buffer object, so it only needs to be set up once.
+			this->transformTex.allocateAsBufferTexture(this->transformBuffer, GL_RGBA32F);
+		}
+	}
+
+	void SkeletonBuffers::clear()
+	{
+		this->numBodies = 0;
+		this->positions.clear();
+		this->transforms.clear();
+		this->confidences.clear();
+	}
+
+	size_t SkeletonBuffers::getNumBodies() const
+	{
+		return this->numBodies;
+	}
+
+	size_t SkeletonBuffers::getNumJoints() const
+	{
+		return this->numBodies * K4ABT_JOINT_COUNT;
+	}
+
+	const std::vector<glm::vec3>& SkeletonBuffers::getPositions() const
+	{
+		return this->positions;
+	}
+
+	const std::vector<glm::mat4>& SkeletonBuffers::getTransforms() const
+	{
+		return this->transforms;
+	}
+
+	const std::vector<float>& SkeletonBuffers::getConfidences() const
+	{
+		return this->confidences;
+	}
+
+	const ofVbo& SkeletonBuffers::getVbo() const
+	{
+		return this->vbo;
+	}
+
+	const ofBufferObject& SkeletonBuffers::getTransformBuffer() const
+	{
+		return this->transformBuffer;
+	}
+
+	const ofTexture& SkeletonBuffers::getTransformTex() const
+	{
+		return this->transformTex;
+	}
+
+	void SkeletonBuffers::drawBones() const
+	{
+		if (this->numBodies == 0) return;
+
+		this->vbo.drawElements(GL_LINES, static_cast<int>(this->numBodies * getBoneIndices().size()));
+	}
+
+	void SkeletonBuffers::drawJoints() const
+	{
+		if (this->numBodies == 0) return;
+
+		this->vbo.draw(GL_POINTS, 0, static_cast<int>(this->getNumJoints()));
+	}
+
+	void SkeletonBuffers::drawJointsInstanced(const ofVboMesh& mesh) const
+	{
+		if (this->numBodies == 0) return;
+
+		mesh.drawInstanced(OF_MESH_FILL, static_cast<int>(this->getNumJoints()));
+	}
+
+	void SkeletonBuffers::updateIndices(size_t numBodies)
+	{
+		// Indices only depend on the body count, so they are only rebuilt when it grows.
+		if (numBodies <= this->numIndexedBodies) return;
+
+		const auto& boneIndices = getBoneIndices();
+		this->indices.resize(numBodies * boneIndices.size());
+		for (size_t b = 0; b < numBodies; ++b)
+		{
+			const ofIndexType offset = static_cast<ofIndexType>(b * K4ABT_JOINT_COUNT);
+			for (size_t i = 0; i < boneIndices.size(); ++i)
+			{
+				this->indices[b * boneIndices.size() + i] = offset + boneIndices[i];
+			}
+		}
+
+		this->vbo.setIndexData(this->indices.data(), static_cast<int>(this->indices.size()), GL_STATIC_DRAW);
+		this->numIndexedBodies = numBodies;
+	}
+}
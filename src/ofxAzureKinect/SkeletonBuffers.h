@@ -0,0 +1,72 @@
+#pragma once
+
+#include <vector>
+
+#include <k4abttypes.h>
+
+#include "ofBufferObject.h"
+#include "ofTexture.h"
+#include "ofVbo.h"
+#include "ofVboMesh.h"
+#include "ofVectorMath.h"
+
+namespace ofxAzureKinect
+{
+	// Flat joint arrays for all bodies, packed as body * K4ABT_JOINT_COUNT + joint.
+	// Joint positions also live in a VBO with a prebuilt bone index buffer, so every skeleton
+	// draws with a single call, and joint transforms go into a buffer for instanced drawing.
+	class SkeletonBuffers
+	{
+	public:
+		// Pairs of joints connected by a bone, for a single skeleton.
+		static const std::vector<ofIndexType>& getBoneIndices();
+
+	public:
+		SkeletonBuffers();
+		~SkeletonBuffers();
+
+		// Skips the GPU buffers when upload is off, only the CPU arrays are updated.
+		void update(const std::vector<k4abt_skeleton_t>& skeletons, bool upload = true);
+		void clear();
+
+		size_t getNumBodies() const;
+		size_t getNumJoints() const;
+
+		const std::vector<glm::vec3>& getPositions() const;
+		const std::vector<glm::mat4>& getTransforms() const;
+
+		// Confidence level normalized to [0, 1].
+		const std::vector<float>& getConfidences() const;
+
+		const ofVbo& getVbo() const;
+		const ofBufferObject& getTransformBuffer() const;
+
+		// Buffer texture over the transform buffer, for shaders to read with texelFetch.
+		// Each joint takes 4 RGBA32F texels, one per matrix column.
+		const ofTexture& getTransformTex() const;
+
+		void drawBones() const;
+		void drawJoints() const;
+
+		// Draws the mesh once per joint, in a single call. The bound shader has to place each
+		// instance itself, reading the joint transform at gl_InstanceID from getTransformTex().
+		void drawJointsInstanced(const ofVboMesh& mesh) const;
+
+	private:
+		void updateIndices(size_t numBodies);
+
+	private:
+		size_t numBodies;
+
+		std::vector<glm::vec3> positions;
+		std::vector<glm::mat4> transforms;
+		std::vector<float> confidences;
+
+		std::vector<ofIndexType> indices;
+		size_t numIndexedBodies;
+
+		ofVbo vbo;
+		ofBufferObject transformBuffer;
+		ofTexture transformTex;
+	};
+}
@@ -0,0 +1,363 @@
+#include "SkeletonFilter.h"
+
+#include <algorithm>
+
+#include "ofLog.h"
+
+namespace
+{
+	const float DEFAULT_FRAME_TIME = 1.0f / 30.0f;
+	const float MAX_FRAME_TIME = 0.5f;
+
+	// Initial velocity variance for new bodies, in (mm/s)^2.
+	const float INITIAL_VELOCITY_VARIANCE = 1000.0f * 1000.0f;
+
+	// Smoothing factor of a first order low-pass at the given cutoff frequency.
+	inline float getAlpha(float cutoff, float dt)
+	{
+		const float tau = 1.0f / (glm::two_pi<float>() * cutoff);
+		return 1.0f / (1.0f + tau / dt);
+	}
+}
+
+namespace ofxAzureKinect
+{
+	SkeletonFilterSettings::SkeletonFilterSettings()
+		: type(SKELETON_FILTER_NONE)
+		, minCutoff(1.0f)
+		, beta(0.005f)
+		, derivativeCutoff(1.0f)
+		, processNoise(2000.0f)
+		, measurementNoise(10.0f)
+		, orientationMinCutoff(1.0f)
+		, orientationBeta(0.5f)
+		, weightByConfidence(true)
+		, lowConfidenceWeight(0.25f)
+	{}
+
+	void SkeletonFilter::State::resize(size_t count)
+	{
+		for (auto field : { &px, &py, &pz, &vx, &vy, &vz, &p00, &p01, &p11, &qw, &qx, &qy, &qz, &angularSpeed })
+		{
+			field->resize(count);
+		}
+	}
+
+	void SkeletonFilter::State::copy(const State& src, size_t srcIdx, size_t dstIdx, size_t count)
+	{
+		std::vector<float> State::* fields[] = {
+			&State::px, &State::py, &State::pz,
+			&State::vx, &State::vy, &State::vz,
+			&State::p00, &State::p01, &State::p11,
+			&State::qw, &State::qx, &State::qy, &State::qz,
+			&State::angularSpeed
+		};
+		for (auto field : fields)
+		{
+			const auto& srcField = src.*field;
+			auto& dstField = this->*field;
+			std::copy(srcField.begin() + srcIdx, srcField.begin() + srcIdx + count, dstField.begin() + dstIdx);
+		}
+	}
+
+	SkeletonFilter::SkeletonFilter()
+		: prevTimestamp(0)
+	{}
+
+	SkeletonFilter::~SkeletonFilter()
+	{}
+
+	void SkeletonFilter::setup(const SkeletonFilterSettings& settings)
+	{
+		this->settings = settings;
+		this->reset();
+	}
+
+	void SkeletonFilter::reset()
+	{
+		this->prevIDs.clear();
+		this->prevTimestamp = 0;
+		this->filteredSkeletons.clear();
+		this->filteredIDs.clear();
+	}
+
+	const SkeletonFilterSettings& SkeletonFilter::getSettings() const
+	{
+		return this->settings;
+	}
+
+	void SkeletonFilter::update(const std::vector<k4abt_skeleton_t>& skeletons, const std::vector<uint32_t>& ids, uint64_t timestampUsec)
+	{
+		if (skeletons.size() != ids.size())
+		{
+			ofLogError(__FUNCTION__) << "Skeleton and ID counts do not match!";
+			return;
+		}
+
+		float dt = DEFAULT_FRAME_TIME;
+		if (this->prevTimestamp != 0 && timestampUsec > this->prevTimestamp)
+		{
+			dt = std::min((timestampUsec - this->prevTimestamp) * 1e-6f, MAX_FRAME_TIME);
+		}
+		this->prevTimestamp = timestampUsec;
+
+		this->filteredSkeletons = skeletons;
+		this->filteredIDs = ids;
+
+		if (this->settings.type == SKELETON_FILTER_NONE)
+		{
+			return;
+		}
+
+		this->gatherMeasurements(skeletons);
+		this->matchBodies(skeletons, ids);
+
+		if (this->settings.type == SKELETON_FILTER_KALMAN)
+		{
+			this->updateKalman(dt);
+		}
+		else
+		{
+			this->updateOneEuro(dt);
+		}
+		this->updateOrientations(dt);
+
+		// Write the state back out, confidence levels pass through untouched.
+		for (size_t b = 0; b < skeletons.size(); ++b)
+		{
+			for (int j = 0; j < K4ABT_JOINT_COUNT; ++j)
+			{
+				const size_t i = b * K4ABT_JOINT_COUNT + j;
+				auto& joint = this->filteredSkeletons[b].joints[j];
+				joint.position.v[0] = this->state.px[i];
+				joint.position.v[1] = this->state.py[i];
+				joint.position.v[2] = this->state.pz[i];
+				joint.orientation.v[0] = this->state.qw[i];
+				joint.orientation.v[1] = this->state.qx[i];
+				joint.orientation.v[2] = this->state.qy[i];
+				joint.orientation.v[3] = this->state.qz[i];
+			}
+		}
+	}
+
+	const std::vector<k4abt_skeleton_t>& SkeletonFilter::getSkeletons() const
+	{
+		return this->filteredSkeletons;
+	}
+
+	const std::vector<uint32_t>& SkeletonFilter::getIDs() const
+	{
+		return this->filteredIDs;
+	}
+
+	void SkeletonFilter::gatherMeasurements(const std::vector<k4abt_skeleton_t>& skeletons)
+	{
+		const size_t count = skeletons.size() * K4ABT_JOINT_COUNT;
+		for (auto field : { &mx, &my, &mz, &mqw, &mqx, &mqy, &mqz, &weights })
+		{
+			field->resize(count);
+		}
+
+		float confidenceWeights[K4ABT_JOINT_CONFIDENCE_LEVELS_COUNT] = { 1.0f, 1.0f, 1.0f, 1.0f };
+		if (this->settings.weightByConfidence)
+		{
+			confidenceWeights[K4ABT_JOINT_CONFIDENCE_NONE] = 0.0f;
+			confidenceWeights[K4ABT_JOINT_CONFIDENCE_LOW] = this->settings.lowConfidenceWeight;
+		}
+
+		for (size_t b = 0; b < skeletons.size(); ++b)
+		{
+			for (int j = 0; j < K4ABT_JOINT_COUNT; ++j)
+			{
+				const size_t i = b * K4ABT_JOINT_COUNT + j;
+				const auto& joint = skeletons[b].joints[j];
+				this->mx[i] = joint.position.v[0];
+				this->my[i] = joint.position.v[1];
+				this->mz[i] = joint.position.v[2];
+				this->mqw[i] = joint.orientation.v[0];
+				this->mqx[i] = joint.orientation.v[1];
+				this->mqy[i] = joint.orientation.v[2];
+				this->mqz[i] = joint.orientation.v[3];
+				this->weights[i] = confidenceWeights[std::min<int>(joint.confidence_level, K4ABT_JOINT_CONFIDENCE_HIGH)];
+			}
+		}
+	}
+
+	void SkeletonFilter::matchBodies(const std::vector<k4abt_skeleton_t>& skeletons, const std::vector<uint32_t>& ids)
+	{
+		// Reorder the previous state to match the incoming body order, new bodies start at their measurement.
+		std::swap(this->state, this->prevState);
+		this->state.resize(skeletons.size() * K4ABT_JOINT_COUNT);
+
+		const float measurementVariance = this->settings.measurementNoise * this->settings.measurementNoise;
+		for (size_t b = 0; b < ids.size(); ++b)
+		{
+			const size_t dstIdx = b * K4ABT_JOINT_COUNT;
+			const auto prevIt = std::find(this->prevIDs.begin(), this->prevIDs.end(), ids[b]);
+			if (prevIt != this->prevIDs.end())
+			{
+				const size_t srcIdx = std::distance(this->prevIDs.begin(), prevIt) * K4ABT_JOINT_COUNT;
+				this->state.copy(this->prevState, srcIdx, dstIdx, K4ABT_JOINT_COUNT);
+				continue;
+			}
+
+			for (size_t i = dstIdx; i < dstIdx + K4ABT_JOINT_COUNT; ++i)
+			{
+				this->state.px[i] = this->mx[i];
+				this->state.py[i] = this->my[i];
+				this->state.pz[i] = this->mz[i];
+				this->state.vx[i] = this->state.vy[i] = this->state.vz[i] = 0.0f;
+				this->state.p00[i] = measurementVariance;
+				this->state.p01[i] = 0.0f;
+				this->state.p11[i] = INITIAL_VELOCITY_VARIANCE;
+				this->state.qw[i] = this->mqw[i];
+				this->state.qx[i] = this->mqx[i];
+				this->state.qy[i] = this->mqy[i];
+				this->state.qz[i] = this->mqz[i];
+				this->state.angularSpeed[i] = 0.0f;
+			}
+		}
+
+		this->prevIDs = ids;
+	}
+
+	void SkeletonFilter::updateOneEuro(float dt)
+	{
+		const int count = static_cast<int>(this->weights.size());
+		const float derivativeAlpha = getAlpha(this->settings.derivativeCutoff, dt);
+		const float invDt = 1.0f / dt;
+		const float tauScale = 1.0f / glm::two_pi<float>();
+		const float minCutoff = this->settings.minCutoff;
+		const float beta = this->settings.beta;
+
+		float* px = this->state.px.data();
+		float* py = this->state.py.data();
+		float* pz = this->state.pz.data();
+		float* vx = this->state.vx.data();
+		float* vy = this->state.vy.data();
+		float* vz = this->state.vz.data();
+		const float* mx = this->mx.data();
+		const float* my = this->my.data();
+		const float* mz = this->mz.data();
+		const float* w = this->weights.data();
+
+		for (int i = 0; i < count; ++i)
+		{
+			// Low-pass the speed, then use it to open up the position cutoff.
+			const float da = derivativeAlpha * w[i];
+			vx[i] += da * ((mx[i] - px[i]) * invDt - vx[i]);
+			vy[i] += da * ((my[i] - py[i]) * invDt - vy[i]);
+			vz[i] += da * ((mz[i] - pz[i]) * invDt - vz[i]);
+
+			const float speed = std::sqrt(vx[i] * vx[i] + vy[i] * vy[i] + vz[i] * vz[i]);
+			const float cutoff = minCutoff + beta * speed;
+			const float a = w[i] / (1.0f + tauScale / (cutoff * dt));
+			px[i] += a * (mx[i] - px[i]);
+			py[i] += a * (my[i] - py[i]);
+			pz[i] += a * (mz[i] - pz[i]);
+		}
+	}
+
+	void SkeletonFilter::updateKalman(float dt)
+	{
+		const int count = static_cast<int>(this->weights.size());
+
+		// White noise acceleration model, the same for every axis.
+		const float q = this->settings.processNoise * this->settings.processNoise;
+		const float q00 = q * dt * dt * dt * dt * 0.25f;
+		const float q01 = q * dt * dt * dt * 0.5f;
+		const float q11 = q * dt * dt;
+		const float r = this->settings.measurementNoise * this->settings.measurementNoise;
+
+		float* px = this->state.px.data();
+		float* py = this->state.py.data();
+		float* pz = this->state.pz.data();
+		float* vx = this->state.vx.data();
+		float* vy = this->state.vy.data();
+		float* vz = this->state.vz.data();
+		float* p00 = this->state.p00.data();
+		float* p01 = this->state.p01.data();
+		float* p11 = this->state.p11.data();
+		const float* mx = this->mx.data();
+		const float* my = this->my.data();
+		const float* mz = this->mz.data();
+		const float* w = this->weights.data();
+
+		for (int i = 0; i < count; ++i)
+		{
+			// Predict.
+			px[i] += vx[i] * dt;
+			py[i] += vy[i] * dt;
+			pz[i] += vz[i] * dt;
+			const float c00 = p00[i] + dt * (2.0f * p01[i] + dt * p11[i]) + q00;
+			const float c01 = p01[i] + dt * p11[i] + q01;
+			const float c11 = p11[i] + q11;
+
+			// Correct. The confidence weight scales the measurement variance as r / w,
+			// written so that w = 0 gives a zero gain instead of a division by zero.
+			const float s = w[i] * c00 + r;
+			const float k0 = w[i] * c00 / s;
+			const float k1 = w[i] * c01 / s;
+
+			const float ix = mx[i] - px[i];
+			const float iy = my[i] - py[i];
+			const float iz = mz[i] - pz[i];
+			px[i] += k0 * ix;
+			py[i] += k0 * iy;
+			pz[i] += k0 * iz;
+			vx[i] += k1 * ix;
+			vy[i] += k1 * iy;
+			vz[i] += k1 * iz;
+
+			p00[i] = (1.0f - k0) * c00;
+			p01[i] = (1.0f - k0) * c01;
+			p11[i] = c11 - k1 * c01;
+		}
+	}
+
+	void SkeletonFilter::updateOrientations(float dt)
+	{
+		const int count = static_cast<int>(this->weights.size());
+		const float derivativeAlpha = getAlpha(this->settings.derivativeCutoff, dt);
+		const float invDt = 1.0f / dt;
+		const float tauScale = 1.0f / glm::two_pi<float>();
+		const float minCutoff = this->settings.orientationMinCutoff;
+		const float beta = this->settings.orientationBeta;
+
+		float* qw = this->state.qw.data();
+		float* qx = this->state.qx.data();
+		float* qy = this->state.qy.data();
+		float* qz = this->state.qz.data();
+		float* angularSpeed = this->state.angularSpeed.data();
+		const float* mqw = this->mqw.data();
+		const float* mqx = this->mqx.data();
+		const float* mqy = this->mqy.data();
+		const float* mqz = this->mqz.data();
+		const float* w = this->weights.data();
+
+		for (int i = 0; i < count; ++i)
+		{
+			// Flip the measurement onto the same hemisphere so we blend along the short arc.
+			const float d = qw[i] * mqw[i] + qx[i] * mqx[i] + qy[i] * mqy[i] + qz[i] * mqz[i];
+			const float sign = d < 0.0f ? -1.0f : 1.0f;
+			const float cosHalfAngle = std::min(std::abs(d), 1.0f);
+
+			const float rawSpeed = 2.0f * std::acos(cosHalfAngle) * invDt;
+			angularSpeed[i] += derivativeAlpha * w[i] * (rawSpeed - angularSpeed[i]);
+
+			const float cutoff = minCutoff + beta * angularSpeed[i];
+			const float a = w[i] / (1.0f + tauScale / (cutoff * dt));
+
+			// Normalized lerp, close enough to slerp at per-frame step sizes.
+			const float nw = qw[i] + a * (sign * mqw[i] - qw[i]);
+			const float nx = qx[i] + a * (sign * mqx[i] - qx[i]);
+			const float ny = qy[i] + a * (sign * mqy[i] - qy[i]);
+			const float nz = qz[i] + a * (sign * mqz[i] - qz[i]);
+			const float invLength = 1.0f / std::sqrt(nw * nw + nx * nx + ny * ny + nz * nz);
+			qw[i] = nw * invLength;
+			qx[i] = nx * invLength;
+			qy[i] = ny * invLength;
+			qz[i] = nz * invLength;
+		}
+	}
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <vector>
+
+#include <k4abttypes.h>
+
+#include "ofVectorMath.h"
+
+namespace ofxAzureKinect
+{
+	enum SkeletonFilterType
+	{
+		SKELETON_FILTER_NONE,
+		SKELETON_FILTER_ONE_EURO,
+		SKELETON_FILTER_KALMAN
+	};
+
+	struct SkeletonFilterSettings
+	{
+		SkeletonFilterType type;
+
+		// One-Euro position filter, cutoffs in Hz and beta per mm/s of joint speed.
+		float minCutoff;
+		float beta;
+		float derivativeCutoff;
+
+		// Constant velocity Kalman position filter, acceleration noise in mm/s^2 and measurement noise in mm.
+		float processNoise;
+		float measurementNoise;
+
+		// Orientations always use an adaptive One-Euro slerp, beta per rad/s of joint angular speed.
+		float orientationMinCutoff;
+		float orientationBeta;
+
+		// Scale each joint's update by its confidence level. Joints out of range hold their last
+		// filtered pose and low confidence (occluded, predicted) joints move at lowConfidenceWeight.
+		bool weightByConfidence;
+		float lowConfidenceWeight;
+
+		SkeletonFilterSettings();
+	};
+
+	// Smooths joint positions and orientations for every tracked body, keyed by body ID.
+	// Filter state is stored as flat per-field arrays over all joints of all bodies, so each
+	// step runs as a single pass over (num bodies x K4ABT_JOINT_COUNT) elements.
+	class SkeletonFilter
+	{
+	public:
+		SkeletonFilter();
+		~SkeletonFilter();
+
+		void setup(const SkeletonFilterSettings& settings);
+		void reset();
+
+		const SkeletonFilterSettings& getSettings() const;
+
+		// Timestamp of the body frame, in microseconds.
+		void update(const std::vector<k4abt_skeleton_t>& skeletons, const std::vector<uint32_t>& ids, uint64_t timestampUsec);
+
+		// Filtered skeletons, in the same order as the IDs passed to the last update.
+		const std::vector<k4abt_skeleton_t>& getSkeletons() const;
+		const std::vector<uint32_t>& getIDs() const;
+
+	private:
+		struct State
+		{
+			std::vector<float> px, py, pz;
+			std::vector<float> vx, vy, vz;
+			std::vector<float> p00, p01, p11;
+			std::vector<float> qw, qx, qy, qz;
+			std::vector<float> angularSpeed;
+
+			void resize(size_t count);
+			void copy(const State& src, size_t srcIdx, size_t dstIdx, size_t count);
+		};
+
+		void gatherMeasurements(const std::vector<k4abt_skeleton_t>& skeletons);
+		void matchBodies(const std::vector<k4abt_skeleton_t>& skeletons, const std::vector<uint32_t>& ids);
+
+		void updateOneEuro(float dt);
+		void updateKalman(float dt);
+		void updateOrientations(float dt);
+
+	private:
+		SkeletonFilterSettings settings;
+
+		// Current and previous frame state, swapped when bodies are matched.
+		State state;
+		State prevState;
+		std::vector<uint32_t> prevIDs;
+
+		// Measurements for the current frame.
+		std::vector<float> mx, my, mz;
+		std::vector<float> mqw, mqx, mqy, mqz;
+		std::vector<float> weights;
+
+		uint64_t prevTimestamp;
+
+		std::vector<k4abt_skeleton_t> filteredSkeletons;
+		std::vector<uint32_t> filteredIDs;
+	};
+}
@@ -0,0 +1,289 @@
+#include "SkeletonHistory.h"
+
+#include <algorithm>
+
+#include "ofLog.h"
+
+#include "Types.h"
+
+namespace
+{
+	// Spherical interpolation that also extrapolates for t outside [0, 1].
+	void slerpOrientation(const k4a_quaternion_t& a, const k4a_quaternion_t& b, float t, k4a_quaternion_t& result)
+	{
+		float d = a.v[0] * b.v[0] + a.v[1] * b.v[1] + a.v[2] * b.v[2] + a.v[3] * b.v[3];
+		const float sign = d < 0.0f ? -1.0f : 1.0f;
+		d = std::min(d * sign, 1.0f);
+
+		float wa = 1.0f - t;
+		float wb = t;
+		const float angle = std::acos(d);
+		if (angle > 1e-4f)
+		{
+			const float invSin = 1.0f / std::sin(angle);
+			wa = std::sin((1.0f - t) * angle) * invSin;
+			wb = std::sin(t * angle) * invSin;
+		}
+		wb *= sign;
+
+		float lengthSq = 0.0f;
+		for (int c = 0; c < 4; ++c)
+		{
+			result.v[c] = wa * a.v[c] + wb * b.v[c];
+			lengthSq += result.v[c] * result.v[c];
+		}
+		const float invLength = 1.0f / std::sqrt(lengthSq);
+		for (int c = 0; c < 4; ++c)
+		{
+			result.v[c] *= invLength;
+		}
+	}
+
+	void blendSkeletons(const k4abt_skeleton_t& a, const k4abt_skeleton_t& b, float t, k4abt_skeleton_t& result)
+	{
+		for (int j = 0; j < K4ABT_JOINT_COUNT; ++j)
+		{
+			const auto& ja = a.joints[j];
+			const auto& jb = b.joints[j];
+			auto& joint = result.joints[j];
+			for (int c = 0; c < 3; ++c)
+			{
+				joint.position.v[c] = ja.position.v[c] + t * (jb.position.v[c] - ja.position.v[c]);
+			}
+			slerpOrientation(ja.orientation, jb.orientation, t, joint.orientation);
+			joint.confidence_level = t < 0.5f ? ja.confidence_level : jb.confidence_level;
+		}
+	}
+}
+
+namespace ofxAzureKinect
+{
+	SkeletonHistorySettings::SkeletonHistorySettings()
+		: capacity(30)
+		, maxBodies(8)
+		, maxPredictionUsec(100000)
+	{}
+
+	SkeletonHistory::SkeletonHistory()
+		: latestTimestamp(0)
+	{}
+
+	SkeletonHistory::~SkeletonHistory()
+	{}
+
+	void SkeletonHistory::setup(const SkeletonHistorySettings& settings)
+	{
+		this->settings = settings;
+		this->settings.capacity = std::max<size_t>(this->settings.capacity, 1);
+
+		this->tracks.resize(this->settings.maxBodies);
+		for (auto& track : this->tracks)
+		{
+			track.frames.resize(this->settings.capacity);
+			track.timestamps.resize(this->settings.capacity);
+		}
+		this->seen.resize(this->settings.maxBodies);
+
+		this->clear();
+	}
+
+	void SkeletonHistory::clear()
+	{
+		for (auto& track : this->tracks)
+		{
+			track.bActive = false;
+			track.count = 0;
+		}
+		this->latestTimestamp = 0;
+	}
+
+	const SkeletonHistorySettings& SkeletonHistory::getSettings() const
+	{
+		return this->settings;
+	}
+
+	void SkeletonHistory::update(const std::vector<k4abt_skeleton_t>& skeletons, const std::vector<uint32_t>& ids, uint64_t timestampUsec)
+	{
+		if (skeletons.size() != ids.size())
+		{
+			ofLogError(__FUNCTION__) << "Skeleton and ID counts do not match!";
+			return;
+		}
+
+		std::fill(this->seen.begin(), this->seen.end(), false);
+
+		for (size_t i = 0; i < ids.size(); ++i)
+		{
+			// Find the body's track, or claim a free one.
+			size_t t = 0;
+			while (t < this->tracks.size() && !(this->tracks[t].bActive && this->tracks[t].id == ids[i])) ++t;
+			if (t == this->tracks.size())
+			{
+				t = 0;
+				while (t < this->tracks.size() && (this->tracks[t].bActive || this->seen[t])) ++t;
+				if (t == this->tracks.size())
+				{
+					ofLogVerbose(__FUNCTION__) << "No free track for body " << ids[i] << ", skipping.";
+					continue;
+				}
+
+				auto& track = this->tracks[t];
+				track.id = ids[i];
+				track.bActive = true;
+				track.head = this->settings.capacity - 1;
+				track.count = 0;
+			}
+
+			auto& track = this->tracks[t];
+			track.head = (track.head + 1) % this->settings.capacity;
+			track.frames[track.head] = skeletons[i];
+			track.timestamps[track.head] = timestampUsec;
+			track.count = std::min(track.count + 1, this->settings.capacity);
+			this->seen[t] = true;
+		}
+
+		for (size_t t = 0; t < this->tracks.size(); ++t)
+		{
+			if (!this->seen[t])
+			{
+				this->tracks[t].bActive = false;
+				this->tracks[t].count = 0;
+			}
+		}
+
+		this->latestTimestamp = timestampUsec;
+	}
+
+	bool SkeletonHistory::hasBody(uint32_t id) const
+	{
+		return this->findTrack(id) != nullptr;
+	}
+
+	size_t SkeletonHistory::getNumFrames(uint32_t id) const
+	{
+		const Track* track = this->findTrack(id);
+		return track ? track->count : 0;
+	}
+
+	uint64_t SkeletonHistory::getLatestTimestamp() const
+	{
+		return this->latestTimestamp;
+	}
+
+	const k4abt_skeleton_t* SkeletonHistory::getSkeleton(uint32_t id, size_t age) const
+	{
+		const Track* track = this->findTrack(id);
+		if (!track || age >= track->count) return nullptr;
+
+		return &track->frames[this->getFrameIndex(*track, age)];
+	}
+
+	uint64_t SkeletonHistory::getTimestamp(uint32_t id, size_t age) const
+	{
+		const Track* track = this->findTrack(id);
+		if (!track || age >= track->count) return 0;
+
+		return track->timestamps[this->getFrameIndex(*track, age)];
+	}
+
+	bool SkeletonHistory::getJointVelocity(uint32_t id, k4abt_joint_id_t joint, glm::vec3& velocity) const
+	{
+		const Track* track = this->findTrack(id);
+		if (!track || track->count < 2) return false;
+
+		const size_t idx0 = this->getFrameIndex(*track, 0);
+		const size_t idx1 = this->getFrameIndex(*track, 1);
+		const float dt = (track->timestamps[idx0] - track->timestamps[idx1]) * 1e-6f;
+		if (dt <= 0.0f) return false;
+
+		velocity = (toGlm(track->frames[idx0].joints[joint].position) - toGlm(track->frames[idx1].joints[joint].position)) / dt;
+		return true;
+	}
+
+	bool SkeletonHistory::getJointAcceleration(uint32_t id, k4abt_joint_id_t joint, glm::vec3& acceleration) const
+	{
+		const Track* track = this->findTrack(id);
+		if (!track || track->count < 3) return false;
+
+		const size_t idx0 = this->getFrameIndex(*track, 0);
+		const size_t idx1 = this->getFrameIndex(*track, 1);
+		const size_t idx2 = this->getFrameIndex(*track, 2);
+		const float dt01 = (track->timestamps[idx0] - track->timestamps[idx1]) * 1e-6f;
+		const float dt12 = (track->timestamps[idx1] - track->timestamps[idx2]) * 1e-6f;
+		if (dt01 <= 0.0f || dt12 <= 0.0f) return false;
+
+		// Second difference over non-uniform steps.
+		const auto& p0 = toGlm(track->frames[idx0].joints[joint].position);
+		const auto& p1 = toGlm(track->frames[idx1].joints[joint].position);
+		const auto& p2 = toGlm(track->frames[idx2].joints[joint].position);
+		acceleration = ((p0 - p1) / dt01 - (p1 - p2) / dt12) * (2.0f / (dt01 + dt12));
+		return true;
+	}
+
+	bool SkeletonHistory::getSkeletonAt(uint32_t id, uint64_t timestampUsec, k4abt_skeleton_t& skeleton) const
+	{
+		const Track* track = this->findTrack(id);
+		if (!track || track->count == 0) return false;
+
+		const size_t latestIdx = this->getFrameIndex(*track, 0);
+		const uint64_t latestTime = track->timestamps[latestIdx];
+		if (track->count == 1 || timestampUsec == latestTime)
+		{
+			skeleton = track->frames[latestIdx];
+			return true;
+		}
+
+		if (timestampUsec > latestTime)
+		{
+			// Extrapolate along the last step.
+			const size_t prevIdx = this->getFrameIndex(*track, 1);
+			const uint64_t prevTime = track->timestamps[prevIdx];
+			if (latestTime <= prevTime)
+			{
+				skeleton = track->frames[latestIdx];
+				return true;
+			}
+
+			const uint64_t target = std::min(timestampUsec, latestTime + this->settings.maxPredictionUsec);
+			const float t = static_cast<float>(target - prevTime) / static_cast<float>(latestTime - prevTime);
+			blendSkeletons(track->frames[prevIdx], track->frames[latestIdx], t, skeleton);
+			return true;
+		}
+
+		// Walk back to the frames bracketing the timestamp.
+		for (size_t age = 0; age + 1 < track->count; ++age)
+		{
+			const size_t newerIdx = this->getFrameIndex(*track, age);
+			const size_t olderIdx = this->getFrameIndex(*track, age + 1);
+			const uint64_t newerTime = track->timestamps[newerIdx];
+			const uint64_t olderTime = track->timestamps[olderIdx];
+			if (timestampUsec >= olderTime && newerTime > olderTime)
+			{
+				const float t = static_cast<float>(timestampUsec - olderTime) / static_cast<float>(newerTime - olderTime);
+				blendSkeletons(track->frames[olderIdx], track->frames[newerIdx], t, skeleton);
+				return true;
+			}
+		}
+
+		// Older than anything stored.
+		skeleton = track->frames[this->getFrameIndex(*track, track->count - 1)];
+		return true;
+	}
+
+	const SkeletonHistory::Track* SkeletonHistory::findTrack(uint32_t id) const
+	{
+		for (const auto& track : this->tracks)
+		{
+			if (track.bActive && track.id == id)
+			{
+				return &track;
+			}
+		}
+		return nullptr;
+	}
+
+	size_t SkeletonHistory::getFrameIndex(const Track& track, size_t age) const
+	{
+		return (track.head + this->settings.capacity - age) % this->settings.capacity;
+	}
+}
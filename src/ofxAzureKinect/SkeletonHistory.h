@@ -0,0 +1,83 @@
+#pragma once
+
+#include <vector>
+
+#include <k4abttypes.h>
+
+#include "ofVectorMath.h"
+
+namespace ofxAzureKinect
+{
+	struct SkeletonHistorySettings
+	{
+		// Frames kept per body.
+		size_t capacity;
+
+		// Bodies tracked at once, any extra bodies in a frame are skipped.
+		size_t maxBodies;
+
+		// Furthest a skeleton gets extrapolated past the latest frame, in microseconds.
+		uint64_t maxPredictionUsec;
+
+		SkeletonHistorySettings();
+	};
+
+	// Keeps the last few timestamped skeletons for each body in preallocated ring buffers.
+	// Adds finite difference joint velocities and sampling at arbitrary timestamps, which
+	// interpolates between stored frames or extrapolates past the latest one, e.g. to the
+	// expected display time to hide tracker latency.
+	class SkeletonHistory
+	{
+	public:
+		SkeletonHistory();
+		~SkeletonHistory();
+
+		void setup(const SkeletonHistorySettings& settings);
+		void clear();
+
+		const SkeletonHistorySettings& getSettings() const;
+
+		// Bodies missing from the frame are dropped, the tracker never reuses their IDs.
+		void update(const std::vector<k4abt_skeleton_t>& skeletons, const std::vector<uint32_t>& ids, uint64_t timestampUsec);
+
+		bool hasBody(uint32_t id) const;
+		size_t getNumFrames(uint32_t id) const;
+
+		// Latest frame timestamp, in microseconds.
+		uint64_t getLatestTimestamp() const;
+
+		// Stored frame by age, 0 is the latest.
+		const k4abt_skeleton_t* getSkeleton(uint32_t id, size_t age = 0) const;
+		uint64_t getTimestamp(uint32_t id, size_t age = 0) const;
+
+		// Joint velocity in mm/s and acceleration in mm/s^2, from the latest frames.
+		bool getJointVelocity(uint32_t id, k4abt_joint_id_t joint, glm::vec3& velocity) const;
+		bool getJointAcceleration(uint32_t id, k4abt_joint_id_t joint, glm::vec3& acceleration) const;
+
+		// Skeleton at the given timestamp. Positions and orientations are interpolated
+		// between the bracketing frames, or extrapolated at constant velocity past the latest.
+		bool getSkeletonAt(uint32_t id, uint64_t timestampUsec, k4abt_skeleton_t& skeleton) const;
+
+	private:
+		struct Track
+		{
+			uint32_t id;
+			bool bActive;
+			size_t head;
+			size_t count;
+			std::vector<k4abt_skeleton_t> frames;
+			std::vector<uint64_t> timestamps;
+		};
+
+		const Track* findTrack(uint32_t id) const;
+		size_t getFrameIndex(const Track& track, size_t age) const;
+
+	private:
+		SkeletonHistorySettings settings;
+
+		std::vector<Track> tracks;
+		std::vector<bool> seen;
+
+		uint64_t latestTimestamp;
+	};
+}
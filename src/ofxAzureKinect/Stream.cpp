@@ -0,0 +1,1365 @@
+#include "Stream.h"
+
+#include "ofLog.h"
+
+// Captures allowed in the tracker queue at once when tracking adaptively.
+const int MAX_PENDING_BODY_FRAMES = 1;
+
+// Fixed-point precision used for the relative flying pixel threshold.
+const int FLYING_PIXEL_SHIFT = 12;
+
+namespace
+{
+	// Returns 1 if the valid neighbour depth n jumps more than threshold away from d.
+	inline int isDiscontinuous(int d, int n, int threshold)
+	{
+		return (n != 0) & (std::abs(d - n) > threshold);
+	}
+
+	// Returns the depth value if it is consistent with its 4-neighbourhood, 0 otherwise.
+	// A pixel is considered flying if it breaks from at least two of its neighbours,
+	// which keeps silhouette edges but drops the streaks between foreground and background.
+	inline uint16_t filterFlyingPixel(int d, int left, int right, int up, int down, int relThreshold)
+	{
+		const int threshold = (d * relThreshold) >> FLYING_PIXEL_SHIFT;
+		const int numBreaks = isDiscontinuous(d, left, threshold)
+			+ isDiscontinuous(d, right, threshold)
+			+ isDiscontinuous(d, up, threshold)
+			+ isDiscontinuous(d, down, threshold);
+		return static_cast<uint16_t>(numBreaks < 2 ? d : 0);
+	}
+}
+
+namespace ofxAzureKinect
+{
+	StreamSettings::StreamSettings()
+		: sensorOrientation(K4ABT_SENSOR_ORIENTATION_DEFAULT)
+		, trackerProcessingMode(K4ABT_TRACKER_CONFIG_DEFAULT.processing_mode)
+		, trackerGpuDeviceId(K4ABT_TRACKER_CONFIG_DEFAULT.gpu_device_id)
+		, trackerSmoothing(K4ABT_DEFAULT_TRACKER_SMOOTHING_FACTOR)
+		, bodyTrackingInterval(1)
+		, bodyTrackingAdaptive(false)
+		, updateColor(true)
+		, updateIr(true)
+		, updateBodies(false)
+		, updateWorld(true)
+		, updateVbo(true)
+		, updateForeground(false)
+		, updateBlobs(false)
+		, updatePyramid(false)
+		, updateBodyStats(false)
+		, updateBodyPointClouds(false)
+		, updateGpu(true)
+		, statsWindowSize(300)
+		, filterFlyingPixels(false)
+		, flyingPixelThreshold(0.04f)
+		, minIrAmplitude(0)
+	{}
+
+	Stream::Stream()
+		: bOpen(false)
+		, bStreaming(false)
+		, bUpdateColor(false)
+		, bUpdateIr(false)
+		, bUpdateBodies(false)
+		, bUpdateWorld(false)
+		, bUpdateVbo(false)
+		, bUpdateForeground(false)
+		, bUpdateBlobs(false)
+		, bUpdatePyramid(false)
+		, bUpdateBodyStats(false)
+		, bUpdateBodyPointClouds(false)
+		, bUpdateGpu(true)
+		, bFilterFlyingPixels(false)
+		, flyingPixelThreshold(0.04f)
+		, minIrAmplitude(0)
+		, config(K4A_DEVICE_CONFIG_INIT_DISABLE_ALL)
+		, trackerConfig(K4ABT_TRACKER_CONFIG_DEFAULT)
+		, trackerSmoothing(K4ABT_DEFAULT_TRACKER_SMOOTHING_FACTOR)
+		, bodyTracker(nullptr)
+		, bodyTrackingInterval(1)
+		, bBodyTrackingAdaptive(false)
+		, numBodyCaptures(0)
+		, numPendingBodyFrames(0)
+		, jpegDecompressor(tjInitDecompress())
+		, depthTimestampUsec(0)
+		, colorTimestampUsec(0)
+		, irTimestampUsec(0)
+		, bodyTimestampUsec(0)
+	{}
+
+	Stream::~Stream()
+	{
+		tjDestroy(jpegDecompressor);
+	}
+
+	void Stream::setupStream(const StreamSettings& settings)
+	{
+		this->trackerConfig = K4ABT_TRACKER_CONFIG_DEFAULT;
+		this->trackerConfig.sensor_orientation = settings.sensorOrientation;
+		this->trackerConfig.processing_mode = settings.trackerProcessingMode;
+		this->trackerConfig.gpu_device_id = settings.trackerGpuDeviceId;
+		this->trackerModelPath = settings.trackerModelPath;
+		this->trackerSmoothing = settings.trackerSmoothing;
+		this->bodyTrackingInterval = std::max(settings.bodyTrackingInterval, 1);
+		this->bBodyTrackingAdaptive = settings.bodyTrackingAdaptive;
+
+		this->bUpdateColor = settings.updateColor;
+		this->bUpdateIr = settings.updateIr;
+		this->bUpdateBodies = settings.updateBodies;
+		this->bUpdateWorld = settings.updateWorld;
+		this->bUpdateVbo = settings.updateWorld && settings.updateVbo;
+		this->bUpdateForeground = settings.updateForeground || settings.updateBlobs;
+		this->bUpdateBlobs = settings.updateBlobs;
+		this->bUpdatePyramid = settings.updatePyramid;
+		this->bUpdateBodyStats = settings.updateBodies && settings.updateBodyStats;
+		this->bUpdateBodyPointClouds = settings.updateBodies && this->bUpdateVbo && settings.updateBodyPointClouds;
+		this->bUpdateGpu = settings.updateGpu;
+
+		this->profiler.setup(settings.statsWindowSize);
+		this->frameTiming.setup(settings.frameTimingSettings, settings.statsWindowSize);
+
+		auto backgroundSettings = settings.backgroundSettings;
+		backgroundSettings.updateTexture = backgroundSettings.updateTexture && settings.updateGpu;
+		this->backgroundModel.setup(backgroundSettings);
+		this->blobFinder.setup(settings.blobSettings);
+		this->skeletonFilter.setup(settings.skeletonFilterSettings);
+		// Skeletons are predicted across the whole gap between tracker frames, so the limit has to cover it.
+		auto skeletonHistorySettings = settings.skeletonHistorySettings;
+		const uint64_t trackingGapUsec = getFrameDurationUsec(this->config.camera_fps) * this->bodyTrackingInterval;
+		skeletonHistorySettings.maxPredictionUsec = std::max(skeletonHistorySettings.maxPredictionUsec, trackingGapUsec);
+		this->skeletonHistory.setup(skeletonHistorySettings);
+		this->poseMatcher.setup(settings.poseMatcherSettings);
+
+		this->bFilterFlyingPixels = settings.filterFlyingPixels;
+		this->flyingPixelThreshold = settings.flyingPixelThreshold;
+		this->minIrAmplitude = settings.minIrAmplitude;
+	}
+
+	bool Stream::startStreaming()
+	{
+		if (this->bStreaming) return false;
+
+		if (this->bUpdateColor)
+		{
+			// Create transformation.
+			this->transformation = k4a::transformation(this->calibration);
+		}
+
+		if (this->bUpdateBodies)
+		{
+			// Create tracker.
+			this->trackerConfig.model_path = this->trackerModelPath.empty() ? nullptr : this->trackerModelPath.c_str();
+			if (K4A_RESULT_SUCCEEDED == k4abt_tracker_create(&this->calibration, this->trackerConfig, &this->bodyTracker))
+			{
+				k4abt_tracker_set_temporal_smoothing(this->bodyTracker, this->trackerSmoothing);
+
+				this->jointProjector.setup(this->calibration);
+			}
+			else
+			{
+				ofLogError(__FUNCTION__) << "Failed to create body tracker, body tracking disabled!";
+				this->bodyTracker = nullptr;
+				this->bUpdateBodies = false;
+			}
+		}
+
+		if (this->bUpdateWorld)
+		{
+			// Load depth to world LUT.
+			this->setupDepthToWorldTable();
+
+			if (this->bUpdateColor)
+			{
+				// Load color to world LUT.
+				this->setupColorToWorldTable();
+			}
+		}
+
+		this->frameTiming.start(this->config);
+
+		ofAddListener(ofEvents().update, this, &Stream::updateCameras);
+
+		this->bStreaming = true;
+
+		return true;
+	}
+
+	bool Stream::stopStreaming()
+	{
+		if (!this->bStreaming) return false;
+
+		ofRemoveListener(ofEvents().update, this, &Stream::updateCameras);
+
+		this->stopRawRecording();
+
+		this->depthToWorldImg.reset();
+		this->transformation.destroy();
+
+		if (this->bodyTracker)
+		{
+			k4abt_tracker_shutdown(this->bodyTracker);
+			k4abt_tracker_destroy(this->bodyTracker);
+			this->bodyTracker = nullptr;
+			this->numPendingBodyFrames = 0;
+		}
+
+		this->capture.reset();
+
+		this->bStreaming = false;
+
+		return true;
+	}
+
+	void Stream::clearBodyHistory()
+	{
+		this->skeletonFilter.reset();
+		this->skeletonHistory.clear();
+		this->bodyTimestampUsec = 0;
+	}
+
+	void Stream::markDiscontinuity()
+	{
+		this->clearBodyHistory();
+		this->frameTiming.markDiscontinuity();
+	}
+
+	void Stream::updateCameras(ofEventArgs& args)
+	{
+		this->update();
+	}
+
+	bool Stream::update()
+	{
+		if (!this->bStreaming) return false;
+
+		this->profiler.beginFrame();
+
+		bool bUpdated;
+		{
+			ScopedStageTimer timer(this->profiler, PIPELINE_STAGE_UPDATE);
+			bUpdated = this->updateFrame();
+		}
+
+		// Frames without a capture are left out of the stats.
+		if (bUpdated)
+		{
+			this->profiler.endFrame();
+		}
+
+		return bUpdated;
+	}
+
+	bool Stream::updateFrame()
+	{
+		// Get a capture.
+		{
+			ScopedStageTimer timer(this->profiler, PIPELINE_STAGE_CAPTURE);
+			if (!this->updateCapture()) return false;
+		}
+		this->frameTiming.addCapture(this->capture);
+
+		this->depthTimestampUsec = 0;
+		this->colorTimestampUsec = 0;
+		this->irTimestampUsec = 0;
+
+		// Probe for a depth16 image.
+		auto depthImg = this->capture.get_depth_image();
+		if (depthImg)
+		{
+			ScopedStageTimer timer(this->profiler, PIPELINE_STAGE_DEPTH);
+
+			this->depthTimestampUsec = static_cast<uint64_t>(depthImg.get_device_timestamp().count());
+
+			const auto depthDims = glm::ivec2(depthImg.get_width_pixels(), depthImg.get_height_pixels());
+			if (!depthPix.isAllocated())
+			{
+				this->depthPix.allocate(depthDims.x, depthDims.y, 1);
+				if (this->bUpdateGpu)
+				{
+					this->depthTex.allocate(depthDims.x, depthDims.y, GL_R16);
+					this->depthTex.setTextureMinMagFilter(GL_NEAREST, GL_NEAREST);
+				}
+			}
+
+			if (this->bFilterFlyingPixels)
+			{
+				// Filter while copying into depthPix, then use the filtered frame for the rest of the update.
+				auto irImgForFilter = (this->minIrAmplitude > 0) ? this->capture.get_ir_image() : k4a::image();
+				if (this->filterDepthFrame(depthImg, irImgForFilter))
+				{
+					depthImg = k4a::image::create_from_buffer(K4A_IMAGE_FORMAT_DEPTH16,
+						depthDims.x, depthDims.y,
+						depthDims.x * static_cast<int>(sizeof(uint16_t)),
+						reinterpret_cast<uint8_t*>(this->depthPix.getData()),
+						this->depthPix.getTotalBytes(),
+						nullptr, nullptr);
+				}
+			}
+			else
+			{
+				const auto depthData = reinterpret_cast<uint16_t*>(depthImg.get_buffer());
+				this->depthPix.setFromPixels(depthData, depthDims.x, depthDims.y, 1);
+			}
+			if (this->bUpdateGpu)
+			{
+				ScopedStageTimer uploadTimer(this->profiler, PIPELINE_STAGE_UPLOAD);
+				this->depthTex.loadData(this->depthPix);
+			}
+
+			if (this->bUpdatePyramid)
+			{
+				this->depthPyramid.update(this->depthPix);
+			}
+
+			if (this->bUpdateForeground)
+			{
+				this->backgroundModel.update(this->depthPix);
+
+				if (this->bUpdateBlobs)
+				{
+					this->blobFinder.update(this->backgroundModel.getForegroundPix(), this->depthPix, this->depthToWorldPix);
+				}
+			}
+
+			ofLogVerbose(__FUNCTION__) << "Capture Depth16 " << depthDims.x << "x" << depthDims.y << " stride: " << depthImg.get_stride_bytes() << ".";
+
+			this->frameTiming.markStage(PIPELINE_STAGE_DEPTH);
+		}
+		else
+		{
+			ofLogWarning(__FUNCTION__) << "No Depth16 capture found!";
+		}
+
+		k4a::image colorImg;
+		if (this->bUpdateColor)
+		{
+			// Probe for a color image.
+			colorImg = this->capture.get_color_image();
+			if (colorImg)
+			{
+				ScopedStageTimer timer(this->profiler, PIPELINE_STAGE_COLOR);
+
+				this->colorTimestampUsec = static_cast<uint64_t>(colorImg.get_device_timestamp().count());
+
+				const auto colorDims = glm::ivec2(colorImg.get_width_pixels(), colorImg.get_height_pixels());
+				this->decodeColorFrame(colorImg);
+
+				if (this->bUpdateGpu)
+				{
+					ScopedStageTimer uploadTimer(this->profiler, PIPELINE_STAGE_UPLOAD);
+
+					if (!this->colorTex.isAllocated())
+					{
+						this->colorTex.allocate(colorDims.x, colorDims.y, GL_RGBA8, ofGetUsingArbTex(), GL_BGRA, GL_UNSIGNED_BYTE);
+						this->colorTex.setTextureMinMagFilter(GL_NEAREST, GL_NEAREST);
+
+						if (this->config.color_format == K4A_IMAGE_FORMAT_COLOR_BGRA32)
+						{
+							this->colorTex.bind();
+							{
+								glTexParameteri(this->colorTex.texData.textureTarget, GL_TEXTURE_SWIZZLE_R, GL_BLUE);
+								glTexParameteri(this->colorTex.texData.textureTarget, GL_TEXTURE_SWIZZLE_B, GL_RED);
+							}
+							this->colorTex.unbind();
+						}
+					}
+
+					this->colorTex.loadData(this->colorPix);
+				}
+
+				ofLogVerbose(__FUNCTION__) << "Capture Color " << colorDims.x << "x" << colorDims.y << " stride: " << colorImg.get_stride_bytes() << ".";
+
+				this->frameTiming.markStage(PIPELINE_STAGE_COLOR);
+			}
+			else
+			{
+				ofLogWarning(__FUNCTION__) << "No Color capture found!";
+			}
+		}
+
+		k4a::image irImg;
+		if (this->bUpdateIr)
+		{
+			// Probe for a IR16 image.
+			irImg = this->capture.get_ir_image();
+			if (irImg)
+			{
+				ScopedStageTimer timer(this->profiler, PIPELINE_STAGE_IR);
+
+				this->irTimestampUsec = static_cast<uint64_t>(irImg.get_device_timestamp().count());
+
+				const auto irSize = glm::ivec2(irImg.get_width_pixels(), irImg.get_height_pixels());
+				if (!this->irPix.isAllocated())
+				{
+					this->irPix.allocate(irSize.x, irSize.y, 1);
+					if (this->bUpdateGpu)
+					{
+						this->irTex.allocate(irSize.x, irSize.y, GL_R16);
+						this->irTex.setTextureMinMagFilter(GL_NEAREST, GL_NEAREST);
+						this->irTex.setRGToRGBASwizzles(true);
+					}
+				}
+
+				const auto irData = reinterpret_cast<uint16_t*>(irImg.get_buffer());
+				this->irPix.setFromPixels(irData, irSize.x, irSize.y, 1);
+				if (this->bUpdateGpu)
+				{
+					ScopedStageTimer uploadTimer(this->profiler, PIPELINE_STAGE_UPLOAD);
+					this->irTex.loadData(this->irPix);
+				}
+
+				ofLogVerbose(__FUNCTION__) << "Capture Ir16 " << irSize.x << "x" << irSize.y << " stride: " << irImg.get_stride_bytes() << ".";
+
+				this->frameTiming.markStage(PIPELINE_STAGE_IR);
+			}
+			else
+			{
+				ofLogWarning(__FUNCTION__) << "No Ir16 capture found!";
+			}
+		}
+
+		if (this->bUpdateBodies)
+		{
+			ScopedStageTimer timer(this->profiler, PIPELINE_STAGE_BODIES);
+			this->updateBodies();
+
+			this->frameTiming.markStage(PIPELINE_STAGE_BODIES);
+		}
+
+		if (this->bUpdateVbo)
+		{
+			ScopedStageTimer timer(this->profiler, PIPELINE_STAGE_POINT_CLOUDS);
+
+			if (this->bUpdateColor)
+			{
+				this->updateWorldVbo(colorImg, this->colorToWorldImg, this->pointCloudVbo);
+			}
+			else
+			{
+				this->updateWorldVbo(depthImg, this->depthToWorldImg, this->pointCloudVbo);
+			}
+
+			if (this->bUpdateForeground && depthImg)
+			{
+				// The foreground mask is in depth space, so always use the depth LUT.
+				this->updateWorldVbo(depthImg, this->depthToWorldImg, this->foregroundPointCloudVbo, &this->backgroundModel.getForegroundPix());
+			}
+
+			this->frameTiming.markStage(PIPELINE_STAGE_POINT_CLOUDS);
+		}
+
+		if (colorImg && this->bUpdateColor && this->config.color_format == K4A_IMAGE_FORMAT_COLOR_BGRA32)
+		{
+			ScopedStageTimer timer(this->profiler, PIPELINE_STAGE_TRANSFORMS);
+
+			// TODO: Fix this for non-BGRA formats, maybe always keep a BGRA k4a::image around.
+			this->updateDepthInColorFrame(depthImg, colorImg);
+			this->updateColorInDepthFrame(depthImg, colorImg);
+
+			this->frameTiming.markStage(PIPELINE_STAGE_TRANSFORMS);
+		}
+
+		// Release images.
+		depthImg.reset();
+		colorImg.reset();
+		irImg.reset();
+
+		// Release capture.
+		this->capture.reset();
+
+		{
+			ScopedStageTimer timer(this->profiler, PIPELINE_STAGE_POST_UPDATE);
+
+			if (this->rawRecorder.isRecording())
+			{
+				this->rawRecorder.addFrame(*this);
+			}
+
+			this->postUpdate();
+
+			this->frameTiming.markStage(PIPELINE_STAGE_POST_UPDATE);
+		}
+
+		// End to end, from the host receiving the capture to everything being ready for the app.
+		this->frameTiming.markStage(PIPELINE_STAGE_UPDATE);
+
+		return true;
+	}
+
+	bool Stream::setupDepthToWorldTable()
+	{
+		if (this->setupImageToWorldTable(K4A_CALIBRATION_TYPE_DEPTH, this->depthToWorldImg))
+		{
+			const int width = this->depthToWorldImg.get_width_pixels();
+			const int height = this->depthToWorldImg.get_height_pixels();
+
+			const auto data = reinterpret_cast<float *>(this->depthToWorldImg.get_buffer());
+
+			if (!this->depthToWorldPix.isAllocated())
+			{
+				this->depthToWorldPix.allocate(width, height, 2);
+				if (this->bUpdateGpu)
+				{
+					this->depthToWorldTex.allocate(width, height, GL_RG32F);
+					this->depthToWorldTex.setTextureMinMagFilter(GL_NEAREST, GL_NEAREST);
+				}
+			}
+
+			this->depthToWorldPix.setFromPixels(data, width, height, 2);
+			if (this->bUpdateGpu)
+			{
+				this->depthToWorldTex.loadData(this->depthToWorldPix);
+			}
+
+			return true;
+		}
+
+		return false;
+	}
+
+	bool Stream::setupColorToWorldTable()
+	{
+		if (this->setupImageToWorldTable(K4A_CALIBRATION_TYPE_COLOR, this->colorToWorldImg))
+		{
+			const int width = this->colorToWorldImg.get_width_pixels();
+			const int height = this->colorToWorldImg.get_height_pixels();
+
+			const auto data = reinterpret_cast<float *>(this->colorToWorldImg.get_buffer());
+
+			if (!this->colorToWorldPix.isAllocated())
+			{
+				this->colorToWorldPix.allocate(width, height, 2);
+				if (this->bUpdateGpu)
+				{
+					this->colorToWorldTex.allocate(width, height, GL_RG32F);
+					this->colorToWorldTex.setTextureMinMagFilter(GL_NEAREST, GL_NEAREST);
+				}
+			}
+
+			this->colorToWorldPix.setFromPixels(data, width, height, 2);
+			if (this->bUpdateGpu)
+			{
+				this->colorToWorldTex.loadData(this->colorToWorldPix);
+			}
+
+			return true;
+		}
+
+		return false;
+	}
+
+	bool Stream::setupImageToWorldTable(k4a_calibration_type_t type, k4a::image& img)
+	{
+		const k4a_calibration_camera_t& calibrationCamera = (type == K4A_CALIBRATION_TYPE_DEPTH) ? this->calibration.depth_camera_calibration : this->calibration.color_camera_calibration;
+
+		const auto dims = glm::ivec2(
+			calibrationCamera.resolution_width,
+			calibrationCamera.resolution_height);
+
+		try
+		{
+			img = k4a::image::create(K4A_IMAGE_FORMAT_CUSTOM,
+				dims.x, dims.y,
+				dims.x * static_cast<int>(sizeof(k4a_float2_t)));
+		}
+		catch (const k4a::error& e)
+		{
+			ofLogError(__FUNCTION__) << e.what();
+			return false;
+		}
+
+		auto imgData = reinterpret_cast<k4a_float2_t*>(img.get_buffer());
+
+		k4a_float2_t p;
+		k4a_float3_t ray;
+		int idx = 0;
+		for (int y = 0; y < dims.y; ++y)
+		{
+			p.xy.y = static_cast<float>(y);
+
+			for (int x = 0; x < dims.x; ++x)
+			{
+				p.xy.x = static_cast<float>(x);
+
+				if (this->calibration.convert_2d_to_3d(p, 1.f, type, type, &ray))
+				{
+					imgData[idx].xy.x = ray.xyz.x;
+					imgData[idx].xy.y = ray.xyz.y;
+				}
+				else
+				{
+					// The pixel is invalid.
+					//ofLogNotice(__FUNCTION__) << "Pixel " << depthToWorldData[idx].xy.x << ", " << depthToWorldData[idx].xy.y << " is invalid";
+					imgData[idx].xy.x = 0;
+					imgData[idx].xy.y = 0;
+				}
+
+				++idx;
+			}
+		}
+
+		return true;
+	}
+
+	void Stream::updateBodies()
+	{
+		// Capture time on the device clock, used to fill in frames the tracker skips.
+		uint64_t captureTimestampUsec = 0;
+		auto depthImg = this->capture.get_depth_image();
+		if (depthImg)
+		{
+			captureTimestampUsec = static_cast<uint64_t>(depthImg.get_device_timestamp().count());
+			depthImg.reset();
+		}
+
+		if (this->bBodyTrackingAdaptive)
+		{
+			// Collect a result if one is ready, and only queue a new capture once the tracker has caught up.
+			if (this->numPendingBodyFrames > 0)
+			{
+				this->popBodyFrame(0);
+			}
+			if (this->numPendingBodyFrames < MAX_PENDING_BODY_FRAMES)
+			{
+				this->enqueueBodyCapture(0);
+			}
+		}
+		else if (this->numBodyCaptures % this->bodyTrackingInterval == 0)
+		{
+			if (this->enqueueBodyCapture(K4A_WAIT_INFINITE))
+			{
+				this->popBodyFrame(K4A_WAIT_INFINITE);
+			}
+		}
+		++this->numBodyCaptures;
+
+		if (captureTimestampUsec > this->bodyTimestampUsec)
+		{
+			// The skeletons are older than the capture, predict them forward from the history.
+			for (size_t i = 0; i < this->bodyIDs.size(); ++i)
+			{
+				this->skeletonHistory.getSkeletonAt(this->bodyIDs[i], captureTimestampUsec, this->bodySkeletons[i]);
+			}
+		}
+
+		this->jointProjector.update(this->bodySkeletons);
+		this->skeletonBuffers.update(this->bodySkeletons, this->bUpdateGpu);
+
+		if (this->poseMatcher.getNumPoses() > 0)
+		{
+			this->poseMatcher.matchPoses(this->bodySkeletons, this->bodyIDs);
+		}
+		if (this->poseMatcher.getNumGestures() > 0)
+		{
+			this->poseMatcher.matchGestures(this->skeletonHistory, this->bodyIDs);
+		}
+	}
+
+	bool Stream::enqueueBodyCapture(int32_t timeoutInMs)
+	{
+		k4a_wait_result_t enqueueResult = k4abt_tracker_enqueue_capture(this->bodyTracker, this->capture.handle(), timeoutInMs);
+		if (enqueueResult == K4A_WAIT_RESULT_FAILED)
+		{
+			ofLogError(__FUNCTION__) << "Failed adding capture to tracker process queue!";
+			return false;
+		}
+		if (enqueueResult == K4A_WAIT_RESULT_TIMEOUT)
+		{
+			ofLogVerbose(__FUNCTION__) << "Tracker process queue full, skipping capture.";
+			return false;
+		}
+
+		++this->numPendingBodyFrames;
+		return true;
+	}
+
+	bool Stream::popBodyFrame(int32_t timeoutInMs)
+	{
+		k4abt_frame_t bodyFrame = nullptr;
+		k4a_wait_result_t popResult = k4abt_tracker_pop_result(this->bodyTracker, &bodyFrame, timeoutInMs);
+		if (popResult != K4A_WAIT_RESULT_SUCCEEDED)
+		{
+			if (popResult == K4A_WAIT_RESULT_FAILED)
+			{
+				ofLogError(__FUNCTION__) << "Failed getting result from tracker!";
+				this->numPendingBodyFrames = 0;
+			}
+			return false;
+		}
+
+		--this->numPendingBodyFrames;
+
+		// Probe for a body index map image.
+		k4a::image bodyIndexImg = k4abt_frame_get_body_index_map(bodyFrame);
+		const auto bodyIndexSize = glm::ivec2(bodyIndexImg.get_width_pixels(), bodyIndexImg.get_height_pixels());
+		if (!this->bodyIndexPix.isAllocated())
+		{
+			this->bodyIndexPix.allocate(bodyIndexSize.x, bodyIndexSize.y, 1);
+			if (this->bUpdateGpu)
+			{
+				this->bodyIndexTex.allocate(bodyIndexSize.x, bodyIndexSize.y, GL_R8);
+				this->bodyIndexTex.setTextureMinMagFilter(GL_NEAREST, GL_NEAREST);
+				this->bodyIndexTex.setRGToRGBASwizzles(true);
+			}
+		}
+
+		const auto bodyIndexData = reinterpret_cast<uint8_t*>(bodyIndexImg.get_buffer());
+		this->bodyIndexPix.setFromPixels(bodyIndexData, bodyIndexSize.x, bodyIndexSize.y, 1);
+		if (this->bUpdateGpu)
+		{
+			ScopedStageTimer uploadTimer(this->profiler, PIPELINE_STAGE_UPLOAD);
+			this->bodyIndexTex.loadData(this->bodyIndexPix);
+		}
+
+		ofLogVerbose(__FUNCTION__) << "Capture BodyIndex " << bodyIndexSize.x << "x" << bodyIndexSize.y << " stride: " << bodyIndexImg.get_stride_bytes() << ".";
+		bodyIndexImg.reset();
+
+		size_t numBodies = k4abt_frame_get_num_bodies(bodyFrame);
+		ofLogVerbose(__FUNCTION__) << numBodies << " bodies found!";
+
+		this->rawBodySkeletons.resize(numBodies);
+		this->bodyIDs.resize(numBodies);
+		for (size_t i = 0; i < numBodies; i++)
+		{
+			k4abt_skeleton_t skeleton;
+			k4abt_frame_get_body_skeleton(bodyFrame, i, &skeleton);
+			this->rawBodySkeletons[i] = skeleton;
+			uint32_t id = k4abt_frame_get_body_id(bodyFrame, i);
+			this->bodyIDs[i] = id;
+		}
+
+		if (this->bUpdateBodyStats || this->bUpdateBodyPointClouds)
+		{
+			// Use the depth frame the tracker segmented, the current capture may be newer
+			// when tracking every Nth capture or adaptively, and the body index map wouldn't line up.
+			k4a::capture bodyCapture(k4abt_frame_get_capture(bodyFrame));
+			k4a::image bodyDepthImg = bodyCapture.get_depth_image();
+
+			if (this->bUpdateBodyStats)
+			{
+				ofShortPixels bodyDepthPix;
+				if (bodyDepthImg)
+				{
+					bodyDepthPix.setFromExternalPixels(reinterpret_cast<uint16_t*>(bodyDepthImg.get_buffer()),
+						bodyDepthImg.get_width_pixels(), bodyDepthImg.get_height_pixels(), 1);
+				}
+				computeBodyStats(this->bodyIndexPix, bodyDepthPix, this->depthToWorldPix, this->bodyIDs, this->bodyStats);
+			}
+
+			if (this->bUpdateBodyPointClouds && bodyDepthImg)
+			{
+				this->updateWorldVbo(bodyDepthImg, this->depthToWorldImg, this->bodyPointCloudVbo, nullptr, &this->bodyIndexPix, numBodies);
+			}
+		}
+
+		this->bodyTimestampUsec = k4abt_frame_get_device_timestamp_usec(bodyFrame);
+
+		// Smooth the joints, this passes the raw skeletons through if filtering is off.
+		this->skeletonFilter.update(this->rawBodySkeletons, this->bodyIDs, this->bodyTimestampUsec);
+		this->bodySkeletons = this->skeletonFilter.getSkeletons();
+
+		this->skeletonHistory.update(this->bodySkeletons, this->bodyIDs, this->bodyTimestampUsec);
+
+		// Release body frame once we're finished.
+		k4abt_frame_release(bodyFrame);
+
+		return true;
+	}
+
+	bool Stream::updateWorldVbo(k4a::image& frameImg, k4a::image& tableImg, ofVbo& vbo, const ofPixels* maskPix, const ofPixels* bodyIndexPix, size_t numBodies)
+	{
+		const auto frameDims = glm::ivec2(frameImg.get_width_pixels(), frameImg.get_height_pixels());
+		const auto tableDims = glm::ivec2(tableImg.get_width_pixels(), tableImg.get_height_pixels());
+		if (frameDims != tableDims)
+		{
+			ofLogError(__FUNCTION__) << "Image dims mismatch! " << frameDims << " vs " << tableDims;
+			return false;
+		}
+
+		const uint8_t* maskData = nullptr;
+		if (maskPix)
+		{
+			const auto maskDims = glm::ivec2(maskPix->getWidth(), maskPix->getHeight());
+			if (maskDims != frameDims)
+			{
+				ofLogError(__FUNCTION__) << "Mask dims mismatch! " << maskDims << " vs " << frameDims;
+				return false;
+			}
+			maskData = maskPix->getData();
+		}
+
+		const uint8_t* bodyIndexData = nullptr;
+		if (bodyIndexPix)
+		{
+			const auto bodyIndexDims = glm::ivec2(bodyIndexPix->getWidth(), bodyIndexPix->getHeight());
+			if (bodyIndexDims != frameDims)
+			{
+				ofLogError(__FUNCTION__) << "Body index dims mismatch! " << bodyIndexDims << " vs " << frameDims;
+				return false;
+			}
+			bodyIndexData = bodyIndexPix->getData();
+		}
+
+		const auto frameData = reinterpret_cast<uint16_t*>(frameImg.get_buffer());
+		const auto tableData = reinterpret_cast<k4a_float2_t*>(tableImg.get_buffer());
+
+		auto& positions = bodyIndexData ? this->bodyPositionCache : this->positionCache;
+		auto& uvs = bodyIndexData ? this->bodyUvCache : this->uvCache;
+		positions.resize(frameDims.x * frameDims.y);
+		uvs.resize(frameDims.x * frameDims.y);
+
+		const auto isValidPoint = [&](int idx)
+		{
+			return frameData[idx] != 0 &&
+				tableData[idx].xy.x != 0 && tableData[idx].xy.y != 0 &&
+				(!maskData || maskData[idx] != 0);
+		};
+
+		const auto writePoint = [&](int x, int y, int idx, int dstIdx)
+		{
+			float depthVal = static_cast<float>(frameData[idx]);
+			positions[dstIdx] = glm::vec3(
+				tableData[idx].xy.x * depthVal,
+				tableData[idx].xy.y * depthVal,
+				depthVal
+			);
+
+			uvs[dstIdx] = glm::vec2(x, y);
+		};
+
+		int numPoints = 0;
+		if (bodyIndexData)
+		{
+			// Counting sort, count each body's points first then write them into one contiguous range per body.
+			numBodies = std::min<size_t>(numBodies, K4ABT_BODY_INDEX_MAP_BACKGROUND);
+			this->bodyPointCounts.assign(numBodies, 0);
+			for (int idx = 0; idx < frameDims.x * frameDims.y; ++idx)
+			{
+				if (bodyIndexData[idx] < numBodies && isValidPoint(idx))
+				{
+					++this->bodyPointCounts[bodyIndexData[idx]];
+				}
+			}
+
+			this->bodyPointOffsets.resize(numBodies);
+			for (size_t b = 0; b < numBodies; ++b)
+			{
+				this->bodyPointOffsets[b] = numPoints;
+				numPoints += static_cast<int>(this->bodyPointCounts[b]);
+			}
+
+			std::vector<size_t> cursors = this->bodyPointOffsets;
+			for (int y = 0; y < frameDims.y; ++y)
+			{
+				for (int x = 0; x < frameDims.x; ++x)
+				{
+					int idx = y * frameDims.x + x;
+					if (bodyIndexData[idx] < numBodies && isValidPoint(idx))
+					{
+						writePoint(x, y, idx, static_cast<int>(cursors[bodyIndexData[idx]]++));
+					}
+				}
+			}
+		}
+		else
+		{
+			for (int y = 0; y < frameDims.y; ++y)
+			{
+				for (int x = 0; x < frameDims.x; ++x)
+				{
+					int idx = y * frameDims.x + x;
+					if (isValidPoint(idx))
+					{
+						writePoint(x, y, idx, numPoints);
+						++numPoints;
+					}
+				}
+			}
+		}
+
+		if (this->bUpdateGpu)
+		{
+			ScopedStageTimer uploadTimer(this->profiler, PIPELINE_STAGE_UPLOAD);
+			vbo.setVertexData(positions.data(), numPoints, GL_STREAM_DRAW);
+			vbo.setTexCoordData(uvs.data(), numPoints, GL_STREAM_DRAW);
+		}
+
+		return true;
+	}
+
+	bool Stream::decodeColorFrame(const k4a::image& colorImg)
+	{
+		const auto colorDims = glm::ivec2(colorImg.get_width_pixels(), colorImg.get_height_pixels());
+		if (this->colorPix.getWidth() != static_cast<size_t>(colorDims.x) || this->colorPix.getHeight() != static_cast<size_t>(colorDims.y))
+		{
+			this->colorPix.allocate(colorDims.x, colorDims.y, OF_PIXELS_BGRA);
+		}
+
+		if (colorImg.get_format() == K4A_IMAGE_FORMAT_COLOR_MJPG)
+		{
+			const int decompressStatus = tjDecompress2(this->jpegDecompressor,
+				colorImg.get_buffer(),
+				static_cast<unsigned long>(colorImg.get_size()),
+				this->colorPix.getData(),
+				colorDims.x,
+				0, // pitch
+				colorDims.y,
+				TJPF_BGRA,
+				TJFLAG_FASTDCT | TJFLAG_FASTUPSAMPLE);
+			if (decompressStatus != 0)
+			{
+				ofLogWarning(__FUNCTION__) << "Failed to decode MJPG frame: " << tjGetErrorStr2(this->jpegDecompressor);
+				return false;
+			}
+		}
+		else
+		{
+			const auto colorData = reinterpret_cast<const uint8_t*>(colorImg.get_buffer());
+			this->colorPix.setFromPixels(colorData, colorDims.x, colorDims.y, 4);
+		}
+
+		return true;
+	}
+
+	bool Stream::filterDepthFrame(const k4a::image& depthImg, const k4a::image& irImg)
+	{
+		const auto depthDims = glm::ivec2(depthImg.get_width_pixels(), depthImg.get_height_pixels());
+		if (depthDims.x < 2 || depthDims.y < 2)
+		{
+			return false;
+		}
+
+		const uint16_t* irData = nullptr;
+		if (irImg)
+		{
+			const auto irDims = glm::ivec2(irImg.get_width_pixels(), irImg.get_height_pixels());
+			if (irDims == depthDims)
+			{
+				irData = reinterpret_cast<const uint16_t*>(irImg.get_buffer());
+			}
+			else
+			{
+				ofLogWarning(__FUNCTION__) << "IR dims mismatch! " << irDims << " vs " << depthDims << ", skipping amplitude test.";
+			}
+		}
+
+		const auto srcData = reinterpret_cast<const uint16_t*>(depthImg.get_buffer());
+		const auto dstData = this->depthPix.getData();
+
+		// Rows outside the frame read as invalid depth.
+		this->depthFilterZeroRow.resize(depthDims.x, 0);
+
+		const int relThreshold = static_cast<int>(this->flyingPixelThreshold * (1 << FLYING_PIXEL_SHIFT));
+		const int minIr = this->minIrAmplitude;
+		const int last = depthDims.x - 1;
+
+		for (int y = 0; y < depthDims.y; ++y)
+		{
+			const uint16_t* row = srcData + y * depthDims.x;
+			const uint16_t* rowUp = (y > 0) ? row - depthDims.x : this->depthFilterZeroRow.data();
+			const uint16_t* rowDown = (y < depthDims.y - 1) ? row + depthDims.x : this->depthFilterZeroRow.data();
+			uint16_t* dst = dstData + y * depthDims.x;
+
+			dst[0] = filterFlyingPixel(row[0], 0, row[1], rowUp[0], rowDown[0], relThreshold);
+			for (int x = 1; x < last; ++x)
+			{
+				dst[x] = filterFlyingPixel(row[x], row[x - 1], row[x + 1], rowUp[x], rowDown[x], relThreshold);
+			}
+			dst[last] = filterFlyingPixel(row[last], row[last - 1], 0, rowUp[last], rowDown[last], relThreshold);
+
+			if (irData)
+			{
+				// Low amplitude returns are dominated by noise and multipath, drop them while the row is hot.
+				const uint16_t* irRow = irData + y * depthDims.x;
+				for (int x = 0; x < depthDims.x; ++x)
+				{
+					dst[x] = (irRow[x] >= minIr) ? dst[x] : 0;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	bool Stream::updateDepthInColorFrame(const k4a::image& depthImg, const k4a::image& colorImg)
+	{
+		const auto colorDims = glm::ivec2(colorImg.get_width_pixels(), colorImg.get_height_pixels());
+
+		k4a::image transformedDepthImg;
+		try
+		{
+			transformedDepthImg = k4a::image::create(K4A_IMAGE_FORMAT_DEPTH16,
+				colorDims.x, colorDims.y,
+				colorDims.x * static_cast<int>(sizeof(uint16_t)));
+
+			this->transformation.depth_image_to_color_camera(depthImg, &transformedDepthImg);
+		}
+		catch (const k4a::error& e)
+		{
+			ofLogError(__FUNCTION__) << e.what();
+			return false;
+		}
+
+		const auto transformedColorData = reinterpret_cast<uint16_t*>(transformedDepthImg.get_buffer());
+
+		if (!this->depthInColorPix.isAllocated())
+		{
+			this->depthInColorPix.allocate(colorDims.x, colorDims.y, 1);
+			if (this->bUpdateGpu)
+			{
+				this->depthInColorTex.allocate(colorDims.x, colorDims.y, GL_R16);
+				this->depthInColorTex.setTextureMinMagFilter(GL_NEAREST, GL_NEAREST);
+			}
+		}
+
+		this->depthInColorPix.setFromPixels(transformedColorData, colorDims.x, colorDims.y, 1);
+		if (this->bUpdateGpu)
+		{
+			ScopedStageTimer uploadTimer(this->profiler, PIPELINE_STAGE_UPLOAD);
+			this->depthInColorTex.loadData(this->depthInColorPix);
+		}
+
+		ofLogVerbose(__FUNCTION__) << "Depth in Color " << colorDims.x << "x" << colorDims.y << " stride: " << transformedDepthImg.get_stride_bytes() << ".";
+
+		transformedDepthImg.reset();
+
+		return true;
+	}
+
+	bool Stream::updateColorInDepthFrame(const k4a::image& depthImg, const k4a::image& colorImg)
+	{
+		const auto depthDims = glm::ivec2(depthImg.get_width_pixels(), depthImg.get_height_pixels());
+
+		k4a::image transformedColorImg;
+		try
+		{
+			transformedColorImg = k4a::image::create(K4A_IMAGE_FORMAT_COLOR_BGRA32,
+				depthDims.x, depthDims.y,
+				depthDims.x * 4 * static_cast<int>(sizeof(uint8_t)));
+
+			this->transformation.color_image_to_depth_camera(depthImg, colorImg, &transformedColorImg);
+		}
+		catch (const k4a::error& e)
+		{
+			ofLogError(__FUNCTION__) << e.what();
+			return false;
+		}
+
+		const auto transformedColorData = reinterpret_cast<uint8_t*>(transformedColorImg.get_buffer());
+
+		if (!this->colorInDepthPix.isAllocated())
+		{
+			this->colorInDepthPix.allocate(depthDims.x, depthDims.y, OF_PIXELS_BGRA);
+			if (this->bUpdateGpu)
+			{
+				this->colorInDepthTex.allocate(depthDims.x, depthDims.y, GL_RGBA8, ofGetUsingArbTex(), GL_BGRA, GL_UNSIGNED_BYTE);
+				this->colorInDepthTex.setTextureMinMagFilter(GL_NEAREST, GL_NEAREST);
+				this->colorInDepthTex.bind();
+				{
+					glTexParameteri(this->colorInDepthTex.texData.textureTarget, GL_TEXTURE_SWIZZLE_R, GL_BLUE);
+					glTexParameteri(this->colorInDepthTex.texData.textureTarget, GL_TEXTURE_SWIZZLE_B, GL_RED);
+				}
+				this->colorInDepthTex.unbind();
+			}
+		}
+
+		this->colorInDepthPix.setFromPixels(transformedColorData, depthDims.x, depthDims.y, 4);
+		if (this->bUpdateGpu)
+		{
+			ScopedStageTimer uploadTimer(this->profiler, PIPELINE_STAGE_UPLOAD);
+			this->colorInDepthTex.loadData(this->colorInDepthPix);
+		}
+
+		ofLogVerbose(__FUNCTION__) << "Color in Depth " << depthDims.x << "x" << depthDims.y << " stride: " << transformedColorImg.get_stride_bytes() << ".";
+
+		transformedColorImg.reset();
+
+		return true;
+	}
+
+	bool Stream::isOpen() const
+	{
+		return this->bOpen;
+	}
+
+	bool Stream::isStreaming() const
+	{
+		return this->bStreaming;
+	}
+
+	const k4a::calibration& Stream::getCalibration() const
+	{
+		return this->calibration;
+	}
+
+	const k4a_device_configuration_t& Stream::getConfig() const
+	{
+		return this->config;
+	}
+
+	uint64_t Stream::getDepthTimestampUsec() const
+	{
+		return this->depthTimestampUsec;
+	}
+
+	uint64_t Stream::getColorTimestampUsec() const
+	{
+		return this->colorTimestampUsec;
+	}
+
+	uint64_t Stream::getIrTimestampUsec() const
+	{
+		return this->irTimestampUsec;
+	}
+
+	const std::vector<k4a_imu_sample_t>& Stream::getImuSamples() const
+	{
+		return this->imuSamples;
+	}
+
+	bool Stream::startRawRecording(const std::string& filePath, const RawRecorderSettings& settings)
+	{
+		if (!this->bStreaming)
+		{
+			ofLogError(__FUNCTION__) << "Start streaming before recording!";
+			return false;
+		}
+
+		return this->rawRecorder.open(filePath, *this, settings);
+	}
+
+	bool Stream::stopRawRecording()
+	{
+		return this->rawRecorder.close();
+	}
+
+	bool Stream::isRawRecording() const
+	{
+		return this->rawRecorder.isRecording();
+	}
+
+	const RawRecorder& Stream::getRawRecorder() const
+	{
+		return this->rawRecorder;
+	}
+
+	PipelineStats Stream::getStats() const
+	{
+		return this->profiler.getStats();
+	}
+
+	PipelineProfiler& Stream::getProfiler()
+	{
+		return this->profiler;
+	}
+
+	FrameTiming& Stream::getFrameTiming()
+	{
+		return this->frameTiming;
+	}
+
+	const ofShortPixels& Stream::getDepthPix() const
+	{
+		return this->depthPix;
+	}
+
+	const ofTexture& Stream::getDepthTex() const
+	{
+		return this->depthTex;
+	}
+
+	const DepthPyramid& Stream::getDepthPyramid() const
+	{
+		return this->depthPyramid;
+	}
+
+	const ofPixels& Stream::getColorPix() const
+	{
+		return this->colorPix;
+	}
+
+	const ofTexture& Stream::getColorTex() const
+	{
+		return this->colorTex;
+	}
+
+	const ofShortPixels& Stream::getIrPix() const
+	{
+		return this->irPix;
+	}
+
+	const ofTexture& Stream::getIrTex() const
+	{
+		return this->irTex;
+	}
+
+	const ofFloatPixels& Stream::getDepthToWorldPix() const
+	{
+		return this->depthToWorldPix;
+	}
+
+	const ofTexture& Stream::getDepthToWorldTex() const
+	{
+		return this->depthToWorldTex;
+	}
+
+	const ofFloatPixels& Stream::getColorToWorldPix() const
+	{
+		return this->colorToWorldPix;
+	}
+
+	const ofTexture& Stream::getColorToWorldTex() const
+	{
+		return this->colorToWorldTex;
+	}
+
+	const ofShortPixels& Stream::getDepthInColorPix() const
+	{
+		return this->depthInColorPix;
+	}
+
+	const ofTexture& Stream::getDepthInColorTex() const
+	{
+		return this->depthInColorTex;
+	}
+
+	const ofPixels& Stream::getColorInDepthPix() const
+	{
+		return this->colorInDepthPix;
+	}
+
+	const ofTexture& Stream::getColorInDepthTex() const
+	{
+		return this->colorInDepthTex;
+	}
+
+	const ofPixels& Stream::getBodyIndexPix() const
+	{
+		return this->bodyIndexPix;
+	}
+
+	const ofTexture& Stream::getBodyIndexTex() const
+	{
+		return this->bodyIndexTex;
+	}
+
+	size_t Stream::getNumBodies() const
+	{
+		return this->bodySkeletons.size();
+	}
+
+	const std::vector<k4abt_skeleton_t>& Stream::getBodySkeletons() const
+	{
+		return this->bodySkeletons;
+	}
+
+	const std::vector<k4abt_skeleton_t>& Stream::getRawBodySkeletons() const
+	{
+		return this->rawBodySkeletons;
+	}
+
+	const std::vector<uint32_t>& Stream::getBodyIDs() const
+	{
+		return this->bodyIDs;
+	}
+
+	const std::vector<BodyStats>& Stream::getBodyStats() const
+	{
+		return this->bodyStats;
+	}
+
+	const JointProjector& Stream::getJointProjector() const
+	{
+		return this->jointProjector;
+	}
+
+	const SkeletonBuffers& Stream::getSkeletonBuffers() const
+	{
+		return this->skeletonBuffers;
+	}
+
+	uint64_t Stream::getBodyTimestampUsec() const
+	{
+		return this->bodyTimestampUsec;
+	}
+
+	void Stream::setBodyTrackerSmoothing(float smoothing)
+	{
+		this->trackerSmoothing = std::max(0.0f, std::min(smoothing, 1.0f));
+		if (this->bodyTracker)
+		{
+			k4abt_tracker_set_temporal_smoothing(this->bodyTracker, this->trackerSmoothing);
+		}
+	}
+
+	float Stream::getBodyTrackerSmoothing() const
+	{
+		return this->trackerSmoothing;
+	}
+
+	SkeletonFilter& Stream::getSkeletonFilter()
+	{
+		return this->skeletonFilter;
+	}
+
+	const SkeletonHistory& Stream::getSkeletonHistory() const
+	{
+		return this->skeletonHistory;
+	}
+
+	PoseMatcher& Stream::getPoseMatcher()
+	{
+		return this->poseMatcher;
+	}
+
+	const std::vector<Blob>& Stream::getBlobs() const
+	{
+		return this->blobFinder.getBlobs();
+	}
+
+	const ofVbo& Stream::getPointCloudVbo() const
+	{
+		return this->pointCloudVbo;
+	}
+
+	BackgroundModel& Stream::getBackgroundModel()
+	{
+		return this->backgroundModel;
+	}
+
+	const ofPixels& Stream::getForegroundPix() const
+	{
+		return this->backgroundModel.getForegroundPix();
+	}
+
+	const ofTexture& Stream::getForegroundTex() const
+	{
+		return this->backgroundModel.getForegroundTex();
+	}
+
+	const ofVbo& Stream::getForegroundPointCloudVbo() const
+	{
+		return this->foregroundPointCloudVbo;
+	}
+
+	const ofVbo& Stream::getBodyPointCloudVbo() const
+	{
+		return this->bodyPointCloudVbo;
+	}
+
+	const std::vector<glm::vec3>& Stream::getBodyPointCloudPositions() const
+	{
+		return this->bodyPositionCache;
+	}
+
+	const std::vector<size_t>& Stream::getBodyPointOffsets() const
+	{
+		return this->bodyPointOffsets;
+	}
+
+	const std::vector<size_t>& Stream::getBodyPointCounts() const
+	{
+		return this->bodyPointCounts;
+	}
+}
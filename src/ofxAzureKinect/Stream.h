@@ -0,0 +1,338 @@
+#pragma once
+
+#include <k4a/k4a.hpp>
+#include <k4abt.h>
+#include <turbojpeg.h>
+
+#include "ofBufferObject.h"
+#include "ofEvents.h"
+#include "ofPixels.h"
+#include "ofTexture.h"
+#include "ofVboMesh.h"
+#include "ofVectorMath.h"
+
+#include "BackgroundModel.h"
+#include "BlobFinder.h"
+#include "BodyStats.h"
+#include "DepthPyramid.h"
+#include "FrameTiming.h"
+#include "JointProjector.h"
+#include "PipelineStats.h"
+#include "PoseMatcher.h"
+#include "RawRecorder.h"
+#include "SkeletonBuffers.h"
+#include "SkeletonFilter.h"
+#include "SkeletonHistory.h"
+#include "Types.h"
+
+namespace ofxAzureKinect
+{
+	struct StreamSettings
+	{
+		SensorOrientation sensorOrientation;
+
+		// Body tracker configuration, defaults to K4ABT_TRACKER_CONFIG_DEFAULT.
+		// An empty model path loads the SDK's default model for the processing mode.
+		TrackerProcessingMode trackerProcessingMode;
+		int32_t trackerGpuDeviceId;
+		std::string trackerModelPath;
+		float trackerSmoothing;
+
+		// Hand only every Nth capture to the body tracker, or in adaptive mode whenever it is idle.
+		// Skeletons for the captures in between are predicted from the skeleton history.
+		// The prediction limit in skeletonHistorySettings is raised to cover N frames at the camera fps.
+		// In adaptive mode the gap depends on the tracker speed, raise maxPredictionUsec if skeletons freeze.
+		int bodyTrackingInterval;
+		bool bodyTrackingAdaptive;
+		
+		bool updateColor;
+		bool updateIr;
+		bool updateBodies;
+		bool updateWorld;
+		bool updateVbo;
+		bool updateForeground;
+		bool updateBlobs;
+		bool updatePyramid;
+		bool updateBodyStats;
+		bool updateBodyPointClouds;
+
+		// Upload frames, LUTs and point clouds to textures and VBOs.
+		// Turn off to run the pipeline without a GL context, only the pixels and CPU buffers are updated.
+		bool updateGpu;
+
+		// Frames covered by the percentiles in getStats() and getFrameTiming().getStats().
+		size_t statsWindowSize;
+
+		FrameTimingSettings frameTimingSettings;
+		BackgroundSettings backgroundSettings;
+		BlobSettings blobSettings;
+		SkeletonFilterSettings skeletonFilterSettings;
+		SkeletonHistorySettings skeletonHistorySettings;
+		PoseMatcherSettings poseMatcherSettings;
+
+		bool filterFlyingPixels;
+		float flyingPixelThreshold;
+		uint16_t minIrAmplitude;
+
+		StreamSettings();
+	};
+
+	// Base for anything that produces captures, runs them through the processing pipeline and
+	// exposes the results. Subclasses open their source, fill in the calibration and config,
+	// and hand over a new capture every time updateCapture() is called.
+	class Stream
+	{
+	public:
+		Stream();
+		virtual ~Stream();
+
+		virtual bool close() = 0;
+
+		bool isOpen() const;
+		bool isStreaming() const;
+
+		// Pulls the next capture and runs it through the pipeline, returns true if a capture was processed.
+		// Called automatically on every app update while streaming.
+		bool update();
+
+		const k4a::calibration& getCalibration() const;
+		const k4a_device_configuration_t& getConfig() const;
+
+		// Device timestamps of the images in the last capture, 0 if the capture had none.
+		uint64_t getDepthTimestampUsec() const;
+		uint64_t getColorTimestampUsec() const;
+		uint64_t getIrTimestampUsec() const;
+
+		// IMU samples read since the previous capture.
+		const std::vector<k4a_imu_sample_t>& getImuSamples() const;
+
+		// Writes every processed frame to the native raw format, see RawFormat.h and RawPlayback.
+		bool startRawRecording(const std::string& filePath, const RawRecorderSettings& settings = RawRecorderSettings());
+		bool stopRawRecording();
+		bool isRawRecording() const;
+
+		const RawRecorder& getRawRecorder() const;
+
+		// Time spent in each stage of update(), safe to call from any thread.
+		PipelineStats getStats() const;
+
+		// Start and save Chrome traces of the update stages here.
+		PipelineProfiler& getProfiler();
+
+		// Dropped, late and skewed frame counters and events, and how old captures are at each stage.
+		FrameTiming& getFrameTiming();
+
+		const ofShortPixels& getDepthPix() const;
+		const ofTexture& getDepthTex() const;
+		const DepthPyramid& getDepthPyramid() const;
+
+		const ofPixels& getColorPix() const;
+		const ofTexture& getColorTex() const;
+
+		const ofShortPixels& getIrPix() const;
+		const ofTexture& getIrTex() const;
+
+		const ofFloatPixels& getDepthToWorldPix() const;
+		const ofTexture& getDepthToWorldTex() const;
+
+		const ofFloatPixels& getColorToWorldPix() const;
+		const ofTexture& getColorToWorldTex() const;
+
+		const ofShortPixels& getDepthInColorPix() const;
+		const ofTexture& getDepthInColorTex() const;
+
+		const ofPixels& getColorInDepthPix() const;
+		const ofTexture& getColorInDepthTex() const;
+
+		const ofPixels& getBodyIndexPix() const;
+		const ofTexture& getBodyIndexTex() const;
+
+		size_t getNumBodies() const;
+		const std::vector<k4abt_skeleton_t>& getBodySkeletons() const;
+		const std::vector<k4abt_skeleton_t>& getRawBodySkeletons() const;
+		const std::vector<uint32_t>& getBodyIDs() const;
+		const std::vector<BodyStats>& getBodyStats() const;
+
+		// Joints of getBodySkeletons() in depth and color image coordinates.
+		const JointProjector& getJointProjector() const;
+
+		// Joints of getBodySkeletons() in flat arrays and GPU buffers, for drawing all bodies at once.
+		const SkeletonBuffers& getSkeletonBuffers() const;
+
+		uint64_t getBodyTimestampUsec() const;
+
+		void setBodyTrackerSmoothing(float smoothing);
+		float getBodyTrackerSmoothing() const;
+
+		SkeletonFilter& getSkeletonFilter();
+
+		// Timestamps are on the device clock, see getBodyTimestampUsec().
+		const SkeletonHistory& getSkeletonHistory() const;
+
+		// Add pose and gesture templates here, bodies are matched against them every body frame.
+		PoseMatcher& getPoseMatcher();
+
+		const std::vector<Blob>& getBlobs() const;
+
+		const ofVbo& getPointCloudVbo() const;
+
+		BackgroundModel& getBackgroundModel();
+		const ofPixels& getForegroundPix() const;
+		const ofTexture& getForegroundTex() const;
+		const ofVbo& getForegroundPointCloudVbo() const;
+
+		// All body points in one VBO, with one contiguous range per body in getBodyIDs() order.
+		// Built from the depth frame the tracker segmented, so it updates with the body frames.
+		// Positions are also kept on the CPU, only valid up to the end of the last range.
+		const ofVbo& getBodyPointCloudVbo() const;
+		const std::vector<glm::vec3>& getBodyPointCloudPositions() const;
+		const std::vector<size_t>& getBodyPointOffsets() const;
+		const std::vector<size_t>& getBodyPointCounts() const;
+
+	protected:
+		void setupStream(const StreamSettings& settings);
+
+		// Calibration and config must be set before starting.
+		bool startStreaming();
+		bool stopStreaming();
+
+		// Drops tracked bodies and their history, for when capture timestamps jump back.
+		void clearBodyHistory();
+
+		// Drops all state that relies on capture timestamps following each other, for seeks and loops.
+		void markDiscontinuity();
+
+		virtual bool updateCapture() = 0;
+
+		// Called at the end of update(), once the capture is processed.
+		virtual void postUpdate() {}
+
+		// Fills img with the unit plane ray of every pixel of the camera.
+		virtual bool setupImageToWorldTable(k4a_calibration_type_t type, k4a::image& img);
+
+		// Pipeline stages, also callable on their own so they can be timed in isolation.
+		bool setupDepthToWorldTable();
+		bool setupColorToWorldTable();
+
+		// Body index pixels select one range per body, for the first numBodies bodies.
+		bool updateWorldVbo(k4a::image& frameImg, k4a::image& tableImg, ofVbo& vbo, const ofPixels* maskPix = nullptr, const ofPixels* bodyIndexPix = nullptr, size_t numBodies = 0);
+
+		// Decodes MJPG or copies BGRA into the color pixels, depending on the image format.
+		bool decodeColorFrame(const k4a::image& colorImg);
+
+		bool filterDepthFrame(const k4a::image& depthImg, const k4a::image& irImg);
+
+		bool updateDepthInColorFrame(const k4a::image& depthImg, const k4a::image& colorImg);
+		bool updateColorInDepthFrame(const k4a::image& depthImg, const k4a::image& colorImg);
+
+	private:
+		void updateCameras(ofEventArgs& args);
+
+		bool updateFrame();
+
+		void updateBodies();
+		bool enqueueBodyCapture(int32_t timeoutInMs);
+		bool popBodyFrame(int32_t timeoutInMs);
+
+	protected:
+		bool bOpen;
+		bool bStreaming;
+
+		bool bUpdateColor;
+		bool bUpdateIr;
+		bool bUpdateBodies;
+		bool bUpdateWorld;
+		bool bUpdateVbo;
+		bool bUpdateForeground;
+		bool bUpdateBlobs;
+		bool bUpdatePyramid;
+		bool bUpdateBodyStats;
+		bool bUpdateBodyPointClouds;
+		bool bUpdateGpu;
+
+		bool bFilterFlyingPixels;
+		float flyingPixelThreshold;
+		uint16_t minIrAmplitude;
+
+		k4a_device_configuration_t config;
+		k4a::calibration calibration;
+		k4a::transformation transformation;
+		k4a::capture capture;
+
+		std::vector<k4a_imu_sample_t> imuSamples;
+
+	private:
+		k4abt_tracker_configuration_t trackerConfig;
+		std::string trackerModelPath;
+		float trackerSmoothing;
+		k4abt_tracker_t bodyTracker;
+		int bodyTrackingInterval;
+		bool bBodyTrackingAdaptive;
+		uint64_t numBodyCaptures;
+		int numPendingBodyFrames;
+
+		tjhandle jpegDecompressor;
+
+		uint64_t depthTimestampUsec;
+		uint64_t colorTimestampUsec;
+		uint64_t irTimestampUsec;
+
+		ofShortPixels depthPix;
+		ofTexture depthTex;
+		std::vector<uint16_t> depthFilterZeroRow;
+		DepthPyramid depthPyramid;
+
+		ofPixels colorPix;
+		ofTexture colorTex;
+
+		ofShortPixels irPix;
+		ofTexture irTex;
+
+		k4a::image depthToWorldImg;
+		ofFloatPixels depthToWorldPix;
+		ofTexture depthToWorldTex;
+
+		k4a::image colorToWorldImg;
+		ofFloatPixels colorToWorldPix;
+		ofTexture colorToWorldTex;
+
+		ofShortPixels depthInColorPix;
+		ofTexture depthInColorTex;
+
+		ofPixels colorInDepthPix;
+		ofTexture colorInDepthTex;
+
+		ofPixels bodyIndexPix;
+		ofTexture bodyIndexTex;
+		std::vector<k4abt_skeleton_t> bodySkeletons;
+		std::vector<k4abt_skeleton_t> rawBodySkeletons;
+		std::vector<uint32_t> bodyIDs;
+		std::vector<BodyStats> bodyStats;
+		JointProjector jointProjector;
+		SkeletonBuffers skeletonBuffers;
+		uint64_t bodyTimestampUsec;
+		SkeletonFilter skeletonFilter;
+		SkeletonHistory skeletonHistory;
+		PoseMatcher poseMatcher;
+
+		std::vector<glm::vec3> positionCache;
+		std::vector<glm::vec2> uvCache;
+		ofVbo pointCloudVbo;
+
+		BackgroundModel backgroundModel;
+		ofVbo foregroundPointCloudVbo;
+
+		std::vector<glm::vec3> bodyPositionCache;
+		std::vector<glm::vec2> bodyUvCache;
+		std::vector<size_t> bodyPointOffsets;
+		std::vector<size_t> bodyPointCounts;
+		ofVbo bodyPointCloudVbo;
+
+		BlobFinder blobFinder;
+
+		RawRecorder rawRecorder;
+
+		PipelineProfiler profiler;
+		FrameTiming frameTiming;
+	};
+}
@@ -0,0 +1,626 @@
+#include "SyntheticStream.h"
+
+#include <cstring>
+#include <limits>
+
+#include "ofFileUtils.h"
+#include "ofLog.h"
+#include "ofUtils.h"
+
+#include "Parallel.h"
+
+namespace
+{
+	// Generic Azure Kinect factory calibration in the device's raw format, with typical lens parameters.
+	// Intrinsics are normalized by the sensor size, translations are in meters.
+	const char* DEFAULT_RAW_CALIBRATION = R"({
+	"CalibrationInformation": {
+		"Cameras": [
+			{
+				"Intrinsics": {
+					"ModelParameterCount": 14,
+					"ModelParameters": [0.5, 0.5, 0.4925, 0.4925, 5.29, 3.50, 0.176, 5.62, 5.23, 0.92, 0, 0, -0.0001, 0.00005, 0],
+					"ModelType": "CALIBRATION_LensDistortionModelBrownConrady"
+				},
+				"Location": "CALIBRATION_CameraLocationD0",
+				"Purpose": "CALIBRATION_CameraPurposeDepth",
+				"MetricRadius": 1.74,
+				"Rt": {
+					"Rotation": [1, 0, 0, 0, 1, 0, 0, 0, 1],
+					"Translation": [0, 0, 0]
+				},
+				"SensorHeight": 1024,
+				"SensorWidth": 1024,
+				"Shutter": "CALIBRATION_ShutterTypeUndefined",
+				"ThermalAdjustmentParams": { "Params": [0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0] }
+			},
+			{
+				"Intrinsics": {
+					"ModelParameterCount": 14,
+					"ModelParameters": [0.4998, 0.5012, 0.4760, 0.6347, 0.08, -0.06, 0.02, 0, 0, 0, 0, 0, -0.0004, 0.0002, 0],
+					"ModelType": "CALIBRATION_LensDistortionModelBrownConrady"
+				},
+				"Location": "CALIBRATION_CameraLocationPV0",
+				"Purpose": "CALIBRATION_CameraPurposePhotoVideo",
+				"MetricRadius": 0,
+				"Rt": {
+					"Rotation": [1, 0, 0, 0, 0.99452, 0.10453, 0, -0.10453, 0.99452],
+					"Translation": [-0.032, -0.0021, 0.004]
+				},
+				"SensorHeight": 3072,
+				"SensorWidth": 4096,
+				"Shutter": "CALIBRATION_ShutterTypeUndefined",
+				"ThermalAdjustmentParams": { "Params": [0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0] }
+			}
+		],
+		"InertialSensors": [
+			{
+				"BiasTemperatureModel": [0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0],
+				"BiasUncertainty": [0.0001, 0.0001, 0.0001],
+				"Id": "CALIBRATION_InertialSensorId_LSM6DSM",
+				"MixingMatrixTemperatureModel": [1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0],
+				"ModelTypeMask": 16,
+				"Noise": [0.00095, 0.00095, 0.00095, 0, 0, 0],
+				"Rt": {
+					"Rotation": [0, 0.10453, -0.99452, -1, 0, 0, 0, 0.99452, 0.10453],
+					"Translation": [0, 0, 0]
+				},
+				"SecondOrderScaling": [0, 0, 0, 0, 0, 0, 0, 0, 0],
+				"SensorType": "CALIBRATION_InertialSensorType_Gyro",
+				"TemperatureBounds": [5, 60],
+				"TemperatureC": 0
+			},
+			{
+				"BiasTemperatureModel": [0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0],
+				"BiasUncertainty": [0.0001, 0.0001, 0.0001],
+				"Id": "CALIBRATION_InertialSensorId_LSM6DSM",
+				"MixingMatrixTemperatureModel": [1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0],
+				"ModelTypeMask": 56,
+				"Noise": [0.010233, 0.010233, 0.010233, 0, 0, 0],
+				"Rt": {
+					"Rotation": [0, 0.10453, -0.99452, -1, 0, 0, 0, 0.99452, 0.10453],
+					"Translation": [-0.0511, 0.0034, 0.0014]
+				},
+				"SecondOrderScaling": [0, 0, 0, 0, 0, 0, 0, 0, 0],
+				"SensorType": "CALIBRATION_InertialSensorType_Accelerometer",
+				"TemperatureBounds": [5, 60],
+				"TemperatureC": 0
+			}
+		],
+		"Metadata": {
+			"SerialId": "000000000000",
+			"FactoryCalDate": "1/1/2020 12:00:00 AM GMT",
+			"Version": { "Major": 1, "Minor": 2 },
+			"DeviceName": "AzureKinect-PV",
+			"Notes": "PV0_max_radius_invalid"
+		}
+	}
+})";
+
+	// Operating range of each depth mode, in millimeters.
+	void getDepthRange(k4a_depth_mode_t depthMode, uint16_t& minDepth, uint16_t& maxDepth)
+	{
+		switch (depthMode)
+		{
+		case K4A_DEPTH_MODE_NFOV_2X2BINNED:
+			minDepth = 500;
+			maxDepth = 5460;
+			break;
+		case K4A_DEPTH_MODE_NFOV_UNBINNED:
+			minDepth = 500;
+			maxDepth = 3860;
+			break;
+		case K4A_DEPTH_MODE_WFOV_2X2BINNED:
+			minDepth = 250;
+			maxDepth = 2880;
+			break;
+		case K4A_DEPTH_MODE_WFOV_UNBINNED:
+			minDepth = 250;
+			maxDepth = 2210;
+			break;
+		default:
+			minDepth = 0;
+			maxDepth = 0;
+			break;
+		}
+	}
+
+	// Small per-row generator, so rows can be rendered in parallel and stay reproducible.
+	inline uint32_t nextRandom(uint32_t& state)
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state;
+	}
+
+	inline float nextUniform(uint32_t& state)
+	{
+		return (nextRandom(state) >> 8) * (1.0f / 16777216.0f);
+	}
+
+	// Approximately normal with unit deviation, from the sum of four uniforms.
+	inline float nextGaussian(uint32_t& state)
+	{
+		return (nextUniform(state) + nextUniform(state) + nextUniform(state) + nextUniform(state) - 2.0f) * 1.7320508f;
+	}
+
+	inline uint32_t hashSeed(uint32_t seed, uint64_t frameIndex, uint32_t row)
+	{
+		uint32_t h = seed * 0x9E3779B1u ^ static_cast<uint32_t>(frameIndex) * 0x85EBCA6Bu ^ row * 0xC2B2AE35u;
+		h ^= h >> 16;
+		h *= 0x7FEB352Du;
+		h ^= h >> 15;
+		return h ? h : 1;
+	}
+}
+
+namespace ofxAzureKinect
+{
+	SyntheticPlane::SyntheticPlane(const glm::vec3& point, const glm::vec3& normal, const ofColor& color)
+		: point(point)
+		, normal(normal)
+		, color(color)
+	{}
+
+	SyntheticSphere::SyntheticSphere(const glm::vec3& center, float radius, const glm::vec3& motion, float periodSeconds, float phase, const ofColor& color)
+		: center(center)
+		, radius(radius)
+		, motion(motion)
+		, periodSeconds(periodSeconds)
+		, phase(phase)
+		, color(color)
+	{}
+
+	SyntheticStreamSettings::SyntheticStreamSettings()
+		: depthMode(K4A_DEPTH_MODE_WFOV_2X2BINNED)
+		, colorResolution(K4A_COLOR_RESOLUTION_720P)
+		, cameraFps(K4A_FRAMES_PER_SECOND_30)
+		, realtime(true)
+		, depthNoise(4.0f)
+		, dropoutRate(0.01f)
+		, randomSeed(1)
+	{
+		// The camera looks straight ahead, 1m above the floor.
+		this->planes.push_back(SyntheticPlane(glm::vec3(0.0f, 1000.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f), ofColor(180, 170, 150)));
+		this->planes.push_back(SyntheticPlane(glm::vec3(0.0f, 0.0f, 3500.0f), glm::vec3(0.0f, 0.0f, -1.0f), ofColor(200, 200, 210)));
+
+		this->spheres.push_back(SyntheticSphere(glm::vec3(-300.0f, 300.0f, 1800.0f), 250.0f, glm::vec3(500.0f, 0.0f, 0.0f), 4.0f, 0.0f, ofColor(220, 60, 40)));
+		this->spheres.push_back(SyntheticSphere(glm::vec3(400.0f, 100.0f, 2400.0f), 350.0f, glm::vec3(0.0f, 0.0f, 600.0f), 6.0f, 0.25f, ofColor(40, 120, 220)));
+	}
+
+	SyntheticStream::SyntheticStream()
+		: bRealtime(true)
+		, depthNoise(0.0f)
+		, dropoutRate(0.0f)
+		, randomSeed(1)
+		, minDepth(0)
+		, maxDepth(0)
+		, depthToColorRotation(1.0f)
+		, depthToColorTranslation(0.0f)
+		, frameDurationUsec(33333)
+		, frameIndex(0)
+		, clockStartTimeUsec(0)
+	{}
+
+	SyntheticStream::~SyntheticStream()
+	{
+		close();
+	}
+
+	bool SyntheticStream::open()
+	{
+		return open(SyntheticStreamSettings());
+	}
+
+	bool SyntheticStream::open(SyntheticStreamSettings settings)
+	{
+		if (this->bOpen)
+		{
+			ofLogWarning(__FUNCTION__) << "Synthetic stream already open!";
+			return false;
+		}
+
+		this->config = K4A_DEVICE_CONFIG_INIT_DISABLE_ALL;
+		this->config.depth_mode = settings.depthMode;
+		this->config.color_format = K4A_IMAGE_FORMAT_COLOR_BGRA32;
+		this->config.color_resolution = settings.colorResolution;
+		this->config.camera_fps = settings.cameraFps;
+		this->config.synchronized_images_only = true;
+
+		if (!this->loadCalibration(settings.rawCalibrationPath))
+		{
+			return false;
+		}
+
+		getDepthRange(settings.depthMode, this->minDepth, this->maxDepth);
+
+		this->planes = settings.planes;
+		this->spheres = settings.spheres;
+		this->bRealtime = settings.realtime;
+		this->depthNoise = settings.depthNoise;
+		this->dropoutRate = settings.dropoutRate;
+		this->randomSeed = settings.randomSeed;
+		this->frameDurationUsec = getFrameDurationUsec(settings.cameraFps);
+		this->bOpen = true;
+
+		this->setupStream(settings);
+
+		// Only process the images the mode produces.
+		this->bUpdateColor = this->bUpdateColor && settings.colorResolution != K4A_COLOR_RESOLUTION_OFF;
+		if (settings.depthMode == K4A_DEPTH_MODE_OFF || settings.depthMode == K4A_DEPTH_MODE_PASSIVE_IR)
+		{
+			this->bUpdateBodies = false;
+			this->bUpdateBodyStats = false;
+			this->bUpdateBodyPointClouds = false;
+		}
+
+		ofLogNotice(__FUNCTION__) << "Successfully opened synthetic stream with " << this->planes.size() << " planes and " << this->spheres.size() << " spheres.";
+
+		return true;
+	}
+
+	bool SyntheticStream::close()
+	{
+		if (!this->bOpen) return false;
+
+		this->stopCameras();
+
+		this->depthRays.clear();
+		this->colorRays.clear();
+
+		this->bOpen = false;
+
+		return true;
+	}
+
+	bool SyntheticStream::startCameras()
+	{
+		if (!this->bOpen)
+		{
+			ofLogError(__FUNCTION__) << "Open synthetic stream before starting cameras!";
+			return false;
+		}
+
+		if (this->config.depth_mode != K4A_DEPTH_MODE_OFF && !this->setupRays(K4A_CALIBRATION_TYPE_DEPTH, this->depthRays))
+		{
+			return false;
+		}
+		if (this->config.color_resolution != K4A_COLOR_RESOLUTION_OFF && !this->setupRays(K4A_CALIBRATION_TYPE_COLOR, this->colorRays))
+		{
+			return false;
+		}
+
+		const auto& extrinsics = this->calibration.extrinsics[K4A_CALIBRATION_TYPE_DEPTH][K4A_CALIBRATION_TYPE_COLOR];
+		for (int row = 0; row < 3; ++row)
+		{
+			for (int col = 0; col < 3; ++col)
+			{
+				// glm is column major, k4a is row major.
+				this->depthToColorRotation[col][row] = extrinsics.rotation[row * 3 + col];
+			}
+		}
+		this->depthToColorTranslation = glm::vec3(extrinsics.translation[0], extrinsics.translation[1], extrinsics.translation[2]);
+
+		this->frameIndex = 0;
+		this->clockStartTimeUsec = ofGetElapsedTimeMicros();
+
+		return this->startStreaming();
+	}
+
+	bool SyntheticStream::stopCameras()
+	{
+		return this->stopStreaming();
+	}
+
+	std::vector<SyntheticPlane>& SyntheticStream::getPlanes()
+	{
+		return this->planes;
+	}
+
+	std::vector<SyntheticSphere>& SyntheticStream::getSpheres()
+	{
+		return this->spheres;
+	}
+
+	uint64_t SyntheticStream::getNumFrames() const
+	{
+		return this->frameIndex;
+	}
+
+	bool SyntheticStream::updateCapture()
+	{
+		if (this->bRealtime)
+		{
+			// Jump to the frame due on the app clock, like a live device drops frames when the app falls behind.
+			const uint64_t dueIndex = (ofGetElapsedTimeMicros() - this->clockStartTimeUsec) / this->frameDurationUsec;
+			if (dueIndex < this->frameIndex)
+			{
+				return false;
+			}
+			this->frameIndex = dueIndex;
+		}
+
+		const float timeSeconds = this->frameIndex * this->frameDurationUsec / 1000000.0f;
+
+		k4a::image depthImg;
+		k4a::image irImg;
+		k4a::image colorImg;
+		try
+		{
+			if (!this->depthRays.empty() && !this->renderDepth(this->frameIndex, timeSeconds, depthImg, irImg))
+			{
+				return false;
+			}
+			if (!this->colorRays.empty() && !this->renderColor(timeSeconds, colorImg))
+			{
+				return false;
+			}
+
+			// Timestamps start at one frame, 0 means no image.
+			const auto timestamp = std::chrono::microseconds((this->frameIndex + 1) * this->frameDurationUsec);
+
+			this->capture = k4a::capture::create();
+			if (depthImg && this->config.depth_mode != K4A_DEPTH_MODE_PASSIVE_IR)
+			{
+				depthImg.set_timestamp(timestamp);
+				this->capture.set_depth_image(depthImg);
+			}
+			if (irImg)
+			{
+				irImg.set_timestamp(timestamp);
+				this->capture.set_ir_image(irImg);
+			}
+			if (colorImg)
+			{
+				colorImg.set_timestamp(timestamp);
+				this->capture.set_color_image(colorImg);
+			}
+		}
+		catch (const k4a::error& e)
+		{
+			ofLogError(__FUNCTION__) << e.what();
+			this->capture.reset();
+			return false;
+		}
+
+		++this->frameIndex;
+
+		return true;
+	}
+
+	bool SyntheticStream::loadCalibration(const std::string& rawCalibrationPath)
+	{
+		std::vector<uint8_t> rawCalibration;
+		if (rawCalibrationPath.empty())
+		{
+			// The SDK expects the terminating null to be part of the blob.
+			const size_t length = std::strlen(DEFAULT_RAW_CALIBRATION) + 1;
+			rawCalibration.assign(DEFAULT_RAW_CALIBRATION, DEFAULT_RAW_CALIBRATION + length);
+		}
+		else
+		{
+			const auto buffer = ofBufferFromFile(rawCalibrationPath, true);
+			if (buffer.size() == 0)
+			{
+				ofLogError(__FUNCTION__) << "Could not read raw calibration " << rawCalibrationPath << "!";
+				return false;
+			}
+			rawCalibration.assign(buffer.getData(), buffer.getData() + buffer.size());
+			if (rawCalibration.back() != '\0')
+			{
+				rawCalibration.push_back('\0');
+			}
+		}
+
+		try
+		{
+			this->calibration = k4a::calibration::get_from_raw(rawCalibration, this->config.depth_mode, this->config.color_resolution);
+		}
+		catch (const k4a::error& e)
+		{
+			ofLogError(__FUNCTION__) << e.what();
+			return false;
+		}
+
+		return true;
+	}
+
+	bool SyntheticStream::setupRays(k4a_calibration_type_t type, std::vector<glm::vec3>& rays)
+	{
+		const k4a_calibration_camera_t& calibrationCamera = (type == K4A_CALIBRATION_TYPE_DEPTH) ? this->calibration.depth_camera_calibration : this->calibration.color_camera_calibration;
+		const int width = calibrationCamera.resolution_width;
+		const int height = calibrationCamera.resolution_height;
+
+		if (width <= 0 || height <= 0)
+		{
+			ofLogError(__FUNCTION__) << "Calibration has no " << (type == K4A_CALIBRATION_TYPE_DEPTH ? "depth" : "color") << " camera!";
+			return false;
+		}
+
+		rays.resize(static_cast<size_t>(width) * height);
+		parallelFor(0, height, [&](int rowBegin, int rowEnd)
+		{
+			k4a_float2_t p;
+			k4a_float3_t ray;
+			for (int y = rowBegin; y < rowEnd; ++y)
+			{
+				p.xy.y = static_cast<float>(y);
+				for (int x = 0; x < width; ++x)
+				{
+					p.xy.x = static_cast<float>(x);
+					const bool bValid = this->calibration.convert_2d_to_3d(p, 1.0f, type, type, &ray);
+					rays[y * width + x] = bValid ? toGlm(ray) : glm::vec3(0.0f);
+				}
+			}
+		}, 16, width);
+
+		return true;
+	}
+
+	float SyntheticStream::traceRay(const glm::vec3& ray, const std::vector<SyntheticPlane>& planes, const std::vector<SyntheticSphere>& spheres,
+		ofColor& color, glm::vec3& normal) const
+	{
+		float closest = std::numeric_limits<float>::max();
+
+		for (const auto& plane : planes)
+		{
+			const float denom = glm::dot(ray, plane.normal);
+			if (std::abs(denom) < 1e-6f) continue;
+
+			const float t = glm::dot(plane.point, plane.normal) / denom;
+			if (t > 0.0f && t < closest)
+			{
+				closest = t;
+				color = plane.color;
+				normal = (denom > 0.0f) ? -plane.normal : plane.normal;
+			}
+		}
+
+		const float a = glm::dot(ray, ray);
+		for (const auto& sphere : spheres)
+		{
+			const float b = glm::dot(ray, sphere.center);
+			const float disc = b * b - a * (glm::dot(sphere.center, sphere.center) - sphere.radius * sphere.radius);
+			if (disc < 0.0f) continue;
+
+			const float t = (b - std::sqrt(disc)) / a;
+			if (t > 0.0f && t < closest)
+			{
+				closest = t;
+				color = sphere.color;
+				normal = (ray * t - sphere.center) / sphere.radius;
+			}
+		}
+
+		return closest;
+	}
+
+	bool SyntheticStream::renderDepth(uint64_t frameIndex, float timeSeconds, k4a::image& depthImg, k4a::image& irImg)
+	{
+		const int width = this->calibration.depth_camera_calibration.resolution_width;
+		const int height = this->calibration.depth_camera_calibration.resolution_height;
+
+		depthImg = k4a::image::create(K4A_IMAGE_FORMAT_DEPTH16, width, height, width * static_cast<int>(sizeof(uint16_t)));
+		irImg = k4a::image::create(K4A_IMAGE_FORMAT_IR16, width, height, width * static_cast<int>(sizeof(uint16_t)));
+
+		const auto spheres = this->getSpheresAt(timeSeconds);
+		const auto& planes = this->planes;
+
+		// Passive IR mode has no depth range, keep the IR image lit anyway.
+		const float minDepth = this->minDepth;
+		const float maxDepth = (this->maxDepth > 0) ? this->maxDepth : std::numeric_limits<float>::max();
+
+		auto depthData = reinterpret_cast<uint16_t*>(depthImg.get_buffer());
+		auto irData = reinterpret_cast<uint16_t*>(irImg.get_buffer());
+		parallelFor(0, height, [&](int rowBegin, int rowEnd)
+		{
+			ofColor color;
+			glm::vec3 normal;
+			for (int y = rowBegin; y < rowEnd; ++y)
+			{
+				uint32_t state = hashSeed(this->randomSeed, frameIndex, y);
+				for (int x = 0; x < width; ++x)
+				{
+					const int idx = y * width + x;
+					const auto& ray = this->depthRays[idx];
+
+					float depth = 0.0f;
+					float ir = 0.0f;
+					if (ray.z > 0.0f)
+					{
+						depth = this->traceRay(ray, planes, spheres, color, normal);
+						if (depth >= minDepth && depth < maxDepth)
+						{
+							// Lambertian return from an emitter at the camera, falling off with distance.
+							const float cosTheta = std::abs(glm::dot(glm::normalize(ray), normal));
+							const float albedo = (color.r + color.g + color.b) / (3.0f * 255.0f);
+							const float distance = depth / 1000.0f;
+							ir = 2000.0f * albedo * cosTheta / (distance * distance);
+
+							depth += this->depthNoise * nextGaussian(state);
+						}
+						else
+						{
+							depth = 0.0f;
+						}
+
+						if (this->dropoutRate > 0.0f && nextUniform(state) < this->dropoutRate)
+						{
+							depth = 0.0f;
+						}
+					}
+
+					depthData[idx] = static_cast<uint16_t>(std::min(std::max(depth, 0.0f), 65535.0f));
+					irData[idx] = static_cast<uint16_t>(std::min(ir, 65535.0f));
+				}
+			}
+		}, 16, width);
+
+		return true;
+	}
+
+	bool SyntheticStream::renderColor(float timeSeconds, k4a::image& colorImg)
+	{
+		const int width = this->calibration.color_camera_calibration.resolution_width;
+		const int height = this->calibration.color_camera_calibration.resolution_height;
+
+		colorImg = k4a::image::create(K4A_IMAGE_FORMAT_COLOR_BGRA32, width, height, width * 4);
+
+		// Move the scene into color camera space once, instead of every ray.
+		auto spheres = this->getSpheresAt(timeSeconds);
+		for (auto& sphere : spheres)
+		{
+			sphere.center = this->depthToColorRotation * sphere.center + this->depthToColorTranslation;
+		}
+		auto planes = this->planes;
+		for (auto& plane : planes)
+		{
+			plane.point = this->depthToColorRotation * plane.point + this->depthToColorTranslation;
+			plane.normal = this->depthToColorRotation * plane.normal;
+		}
+
+		auto colorData = colorImg.get_buffer();
+		parallelFor(0, height, [&](int rowBegin, int rowEnd)
+		{
+			ofColor color;
+			glm::vec3 normal;
+			for (int y = rowBegin; y < rowEnd; ++y)
+			{
+				for (int x = 0; x < width; ++x)
+				{
+					const int idx = y * width + x;
+					const auto& ray = this->colorRays[idx];
+
+					float shade = 0.0f;
+					color = ofColor(0, 0, 0);
+					if (ray.z > 0.0f && this->traceRay(ray, planes, spheres, color, normal) < std::numeric_limits<float>::max())
+					{
+						shade = 0.3f + 0.7f * std::abs(glm::dot(glm::normalize(ray), normal));
+					}
+
+					uint8_t* pixel = colorData + idx * 4;
+					pixel[0] = static_cast<uint8_t>(color.b * shade);
+					pixel[1] = static_cast<uint8_t>(color.g * shade);
+					pixel[2] = static_cast<uint8_t>(color.r * shade);
+					pixel[3] = 255;
+				}
+			}
+		}, 16, width);
+
+		return true;
+	}
+
+	std::vector<SyntheticSphere> SyntheticStream::getSpheresAt(float timeSeconds) const
+	{
+		auto spheres = this->spheres;
+		for (auto& sphere : spheres)
+		{
+			if (sphere.periodSeconds > 0.0f)
+			{
+				sphere.center += sphere.motion * std::sin(glm::two_pi<float>() * (timeSeconds / sphere.periodSeconds + sphere.phase));
+			}
+		}
+		return spheres;
+	}
+}
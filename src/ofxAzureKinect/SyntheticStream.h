@@ -0,0 +1,122 @@
+#pragma once
+
+#include "ofColor.h"
+
+#include "Stream.h"
+
+namespace ofxAzureKinect
+{
+	// Infinite plane, in depth camera space (millimeters, x right, y down, z forward).
+	struct SyntheticPlane
+	{
+		glm::vec3 point;
+		glm::vec3 normal;
+		ofColor color;
+
+		SyntheticPlane(const glm::vec3& point = glm::vec3(0.0f), const glm::vec3& normal = glm::vec3(0.0f, 0.0f, -1.0f), const ofColor& color = ofColor::white);
+	};
+
+	// Sphere swinging around its center along motion, in depth camera space.
+	struct SyntheticSphere
+	{
+		glm::vec3 center;
+		float radius;
+		glm::vec3 motion;
+		float periodSeconds;
+		float phase;
+		ofColor color;
+
+		SyntheticSphere(const glm::vec3& center = glm::vec3(0.0f, 0.0f, 2000.0f), float radius = 250.0f,
+			const glm::vec3& motion = glm::vec3(0.0f), float periodSeconds = 4.0f, float phase = 0.0f, const ofColor& color = ofColor::white);
+	};
+
+	struct SyntheticStreamSettings
+		: StreamSettings
+	{
+		DepthMode depthMode;
+		ColorResolution colorResolution;
+		FramesPerSecond cameraFps;
+
+		// Raw calibration saved with Device::saveRawCalibration(), empty uses a generic factory calibration.
+		std::string rawCalibrationPath;
+
+		// Produce frames at cameraFps on the app clock, skipping any the app is too slow for.
+		// Otherwise every update produces the next frame, as fast as the pipeline runs.
+		bool realtime;
+
+		// Depth noise standard deviation in millimeters, and share of pixels with no return.
+		float depthNoise;
+		float dropoutRate;
+		uint32_t randomSeed;
+
+		// Defaults to a floor, a back wall and two moving spheres.
+		std::vector<SyntheticPlane> planes;
+		std::vector<SyntheticSphere> spheres;
+
+		SyntheticStreamSettings();
+	};
+
+	// Renders a parametric scene into depth, IR and BGRA color captures and runs them through the
+	// same pipeline as a live Device, so the processing stages can be run and load tested without hardware.
+	class SyntheticStream
+		: public Stream
+	{
+	public:
+		SyntheticStream();
+		~SyntheticStream();
+
+		bool open();
+		bool open(SyntheticStreamSettings settings);
+		bool close() override;
+
+		// Same names as Device, so it can stand in for one.
+		bool startCameras();
+		bool stopCameras();
+
+		// The scene can be changed while streaming.
+		std::vector<SyntheticPlane>& getPlanes();
+		std::vector<SyntheticSphere>& getSpheres();
+
+		uint64_t getNumFrames() const;
+
+	protected:
+		bool updateCapture() override;
+
+	private:
+		bool loadCalibration(const std::string& rawCalibrationPath);
+		bool setupRays(k4a_calibration_type_t type, std::vector<glm::vec3>& rays);
+
+		// Distance along the ray to the closest surface, and the surface color and normal.
+		// Objects must already be in the camera's space.
+		float traceRay(const glm::vec3& ray, const std::vector<SyntheticPlane>& planes, const std::vector<SyntheticSphere>& spheres,
+			ofColor& color, glm::vec3& normal) const;
+
+		bool renderDepth(uint64_t frameIndex, float timeSeconds, k4a::image& depthImg, k4a::image& irImg);
+		bool renderColor(float timeSeconds, k4a::image& colorImg);
+
+		std::vector<SyntheticSphere> getSpheresAt(float timeSeconds) const;
+
+	private:
+		std::vector<SyntheticPlane> planes;
+		std::vector<SyntheticSphere> spheres;
+
+		bool bRealtime;
+		float depthNoise;
+		float dropoutRate;
+		uint32_t randomSeed;
+		uint16_t minDepth;
+		uint16_t maxDepth;
+
+		// Unit plane rays per pixel, zero where the camera model is invalid.
+		std::vector<glm::vec3> depthRays;
+		std::vector<glm::vec3> colorRays;
+
+		// Depth camera to color camera, in millimeters.
+		glm::mat3 depthToColorRotation;
+		glm::vec3 depthToColorTranslation;
+
+		uint64_t frameDurationUsec;
+		uint64_t frameIndex;
+		uint64_t clockStartTimeUsec;
+	};
+}
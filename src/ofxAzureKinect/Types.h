@@ -27,4 +27,19 @@ namespace ofxAzureKinect
 	typedef k4a_fps_t FramesPerSecond;
 
 	typedef k4abt_sensor_orientation_t SensorOrientation;
+	typedef k4abt_tracker_processing_mode_t TrackerProcessingMode;
+
+	inline uint64_t getFrameDurationUsec(FramesPerSecond cameraFps)
+	{
+		switch (cameraFps)
+		{
+		case K4A_FRAMES_PER_SECOND_5:
+			return 200000;
+		case K4A_FRAMES_PER_SECOND_15:
+			return 66667;
+		case K4A_FRAMES_PER_SECOND_30:
+		default:
+			return 33333;
+		}
+	}
 }
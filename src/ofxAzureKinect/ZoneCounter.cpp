@@ -0,0 +1,224 @@
+#include "ZoneCounter.h"
+
+#include "ofLog.h"
+
+#include "Stream.h"
+#include "Parallel.h"
+
+namespace ofxAzureKinect
+{
+	ZoneCounter::ZoneCounter()
+		: bDirty(false)
+	{}
+
+	ZoneCounter::~ZoneCounter()
+	{}
+
+	bool ZoneCounter::setup(const Stream& stream)
+	{
+		return this->setup(stream.getDepthToWorldPix());
+	}
+
+	bool ZoneCounter::setup(const ofFloatPixels& depthToWorldPix)
+	{
+		if (!depthToWorldPix.isAllocated() || depthToWorldPix.getNumChannels() != 2)
+		{
+			ofLogError(__FUNCTION__) << "Depth to world LUT not available, make sure the stream is running with updateWorld enabled!";
+			return false;
+		}
+
+		this->depthToWorldPix = depthToWorldPix;
+		this->bDirty = true;
+
+		return true;
+	}
+
+	size_t ZoneCounter::addZone(const Zone& zone)
+	{
+		if (this->zones.size() >= std::numeric_limits<uint16_t>::max())
+		{
+			ofLogError(__FUNCTION__) << "Too many zones!";
+			return this->zones.size();
+		}
+
+		this->zones.push_back(zone);
+		this->counts.resize(this->zones.size(), 0);
+		this->bDirty = true;
+
+		return this->zones.size() - 1;
+	}
+
+	size_t ZoneCounter::addZone(const glm::vec3& center, const glm::vec3& size, const glm::quat& orientation)
+	{
+		Zone zone;
+		zone.center = center;
+		zone.size = size;
+		zone.orientation = orientation;
+		return this->addZone(zone);
+	}
+
+	void ZoneCounter::clearZones()
+	{
+		this->zones.clear();
+		this->counts.clear();
+		this->bDirty = true;
+	}
+
+	void ZoneCounter::buildRanges()
+	{
+		const int numPixels = static_cast<int>(this->depthToWorldPix.getWidth() * this->depthToWorldPix.getHeight());
+		const auto tableData = reinterpret_cast<const glm::vec2*>(this->depthToWorldPix.getData());
+
+		// Express each pixel ray in zone space: p(d) = origin + dir * d, then clip against
+		// the box slabs to get the depth range where the ray is inside.
+		std::vector<glm::mat3> toZoneRotations(this->zones.size());
+		std::vector<glm::vec3> toZoneOrigins(this->zones.size());
+		for (size_t z = 0; z < this->zones.size(); ++z)
+		{
+			const auto inverseRotation = glm::conjugate(this->zones[z].orientation);
+			toZoneRotations[z] = glm::toMat3(inverseRotation);
+			toZoneOrigins[z] = inverseRotation * -this->zones[z].center;
+		}
+
+		this->rangeOffsets.resize(numPixels + 1);
+		this->ranges.clear();
+
+		const float maxDepth = static_cast<float>(std::numeric_limits<uint16_t>::max());
+		for (int i = 0; i < numPixels; ++i)
+		{
+			this->rangeOffsets[i] = static_cast<uint32_t>(this->ranges.size());
+
+			const auto& lut = tableData[i];
+			if (lut.x == 0 && lut.y == 0) continue;
+
+			const auto ray = glm::vec3(lut.x, lut.y, 1.0f);
+			for (size_t z = 0; z < this->zones.size(); ++z)
+			{
+				const auto halfSize = this->zones[z].size * 0.5f;
+				const auto dir = toZoneRotations[z] * ray;
+				const auto& origin = toZoneOrigins[z];
+
+				float rayNear = 1.0f;
+				float rayFar = maxDepth;
+				for (int axis = 0; axis < 3; ++axis)
+				{
+					if (std::abs(dir[axis]) < 1e-9f)
+					{
+						if (std::abs(origin[axis]) > halfSize[axis])
+						{
+							rayFar = -1.0f;
+						}
+						continue;
+					}
+
+					float t0 = (-halfSize[axis] - origin[axis]) / dir[axis];
+					float t1 = (halfSize[axis] - origin[axis]) / dir[axis];
+					if (t0 > t1) std::swap(t0, t1);
+					rayNear = std::max(rayNear, t0);
+					rayFar = std::min(rayFar, t1);
+				}
+
+				if (rayNear <= rayFar)
+				{
+					ZoneRange range;
+					range.zone = static_cast<uint16_t>(z);
+					range.minDepth = static_cast<uint16_t>(std::ceil(rayNear));
+					range.maxDepth = static_cast<uint16_t>(std::floor(rayFar));
+					if (range.minDepth <= range.maxDepth)
+					{
+						this->ranges.push_back(range);
+					}
+				}
+			}
+		}
+		this->rangeOffsets[numPixels] = static_cast<uint32_t>(this->ranges.size());
+
+		this->bDirty = false;
+
+		ofLogVerbose(__FUNCTION__) << "Built " << this->ranges.size() << " zone ranges for " << this->zones.size() << " zones.";
+	}
+
+	bool ZoneCounter::update(const Stream& stream)
+	{
+		return this->update(stream.getDepthPix());
+	}
+
+	bool ZoneCounter::update(const ofShortPixels& depthPix)
+	{
+		if (!depthPix.isAllocated()) return false;
+
+		if (depthPix.getWidth() != this->depthToWorldPix.getWidth() ||
+			depthPix.getHeight() != this->depthToWorldPix.getHeight())
+		{
+			ofLogError(__FUNCTION__) << "Depth dims don't match the LUT, did you call setup()?";
+			return false;
+		}
+
+		if (this->bDirty)
+		{
+			this->buildRanges();
+		}
+
+		const int width = static_cast<int>(depthPix.getWidth());
+		const int height = static_cast<int>(depthPix.getHeight());
+		const size_t numZones = this->zones.size();
+		const uint16_t* depthData = depthPix.getData();
+		const uint32_t* offsetData = this->rangeOffsets.data();
+		const ZoneRange* rangeData = this->ranges.data();
+
+		const int numChunks = getNumParallelChunks(height, 16, width);
+		std::vector<std::vector<size_t>> chunkCounts(numChunks);
+		parallelForChunks(0, height, numChunks, [&](int chunk, int rowBegin, int rowEnd)
+		{
+			auto& localCounts = chunkCounts[chunk];
+			localCounts.assign(numZones, 0);
+			for (int i = rowBegin * width; i < rowEnd * width; ++i)
+			{
+				const uint16_t d = depthData[i];
+				if (d == 0) continue;
+
+				for (uint32_t r = offsetData[i]; r < offsetData[i + 1]; ++r)
+				{
+					const auto& range = rangeData[r];
+					localCounts[range.zone] += (d >= range.minDepth && d <= range.maxDepth) ? 1 : 0;
+				}
+			}
+		});
+
+		std::fill(this->counts.begin(), this->counts.end(), 0);
+		for (const auto& localCounts : chunkCounts)
+		{
+			for (size_t z = 0; z < numZones; ++z)
+			{
+				this->counts[z] += localCounts[z];
+			}
+		}
+
+		return true;
+	}
+
+	size_t ZoneCounter::getNumZones() const
+	{
+		return this->zones.size();
+	}
+
+	const Zone& ZoneCounter::getZone(size_t idx) const
+	{
+		return this->zones[idx];
+	}
+
+	const std::vector<size_t>& ZoneCounter::getCounts() const
+	{
+		return this->counts;
+	}
+
+	size_t ZoneCounter::getCount(size_t idx) const
+	{
+		return (idx < this->counts.size()) ? this->counts[idx] : 0;
+	}
+
+	bool ZoneCounter::isOccupied(size_t idx, size_t minPoints) const
+	{
+		return this->getCount(idx) >= minPoints;
+	}
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "ofPixels.h"
+#include "ofVectorMath.h"
+
+namespace ofxAzureKinect
+{
+	class Stream;
+
+	// A box in depth camera space, in mm.
+	struct Zone
+	{
+		glm::vec3 center;
+		glm::vec3 size;
+		glm::quat orientation;
+	};
+
+	// Counts depth points inside a set of fixed 3D zones.
+	// Zones don't move relative to the camera, so the depth range over which each pixel ray
+	// crosses each zone is computed once from the depth LUT. Per frame, each valid pixel is then
+	// only tested against the few zones its ray actually goes through.
+	class ZoneCounter
+	{
+	public:
+		ZoneCounter();
+		~ZoneCounter();
+
+		bool setup(const Stream& stream);
+		bool setup(const ofFloatPixels& depthToWorldPix);
+
+		size_t addZone(const Zone& zone);
+		size_t addZone(const glm::vec3& center, const glm::vec3& size, const glm::quat& orientation = glm::quat());
+		void clearZones();
+
+		bool update(const Stream& stream);
+		bool update(const ofShortPixels& depthPix);
+
+		size_t getNumZones() const;
+		const Zone& getZone(size_t idx) const;
+
+		const std::vector<size_t>& getCounts() const;
+		size_t getCount(size_t idx) const;
+		bool isOccupied(size_t idx, size_t minPoints) const;
+
+	private:
+		void buildRanges();
+
+	private:
+		struct ZoneRange
+		{
+			uint16_t zone;
+			uint16_t minDepth;
+			uint16_t maxDepth;
+		};
+
+		ofFloatPixels depthToWorldPix;
+		std::vector<Zone> zones;
+		bool bDirty;
+
+		// Per pixel lists of zone depth ranges, stored flat with per-pixel offsets.
+		std::vector<uint32_t> rangeOffsets;
+		std::vector<ZoneRange> ranges;
+
+		std::vector<size_t> counts;
+	};
+}